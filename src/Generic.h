@@ -5,6 +5,7 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <xxh64.hpp>
 #include <chrono>
@@ -2,6 +2,7 @@
 #include "Loader.h"
 #include "Timer.h"
 #include "TextAsset.h"
+#include "Localization.h"
 #include "GfxAsset.h"
 #include "SoundAsset.h"
 #include "Settings.h"
@@ -15,8 +16,8 @@
 #include "input/CameraController.h"
 
 //  ASSETS
-static AssetLoader& AssetLoaderInstance = AssetLoader::GetInstance();
 static const std::string dataFileName = "startup.dat";
+static uint32_t StreamFinalizePerFrame = 4;
 
 //  SDL
 static SDL_Window* GameWindow = nullptr;
@@ -136,7 +137,9 @@ bool LoadSettings()
         return false;
 
     SceneAsset::ActiveScene = Settings::GetValue<std::string>("scene", "");
+    SceneAsset::LoadBudgetMs = Settings::GetValue<uint32_t>("load_budget_ms", SceneAsset::LoadBudgetMs);
     AppName = Settings::GetValue<std::string>("appname", "Application");
+    StreamFinalizePerFrame = Settings::GetValue<uint32_t>("stream_finalize_per_frame", StreamFinalizePerFrame);
 
     return true;
 }
@@ -230,12 +233,37 @@ bool InitGame()
         return false;
     }
 
+    const auto archiveFileName = Settings::GetValue<std::string>("archive", "");
+    if (!archiveFileName.empty() && !AssetLoader::MountArchive(archiveFileName))
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "MountArchive failed!");
+        return false;
+    }
+
+    AssetLoader::ReadMemoryBudgets();
+
+    if (!Scripting::Runtime::Init())
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Script runtime init failed!");
+        return false;
+    }
+
     if (!AssetLoader::ParseDataFile(dataFileName))
     {
         Logger::ERROR(TAG_FUNCTION_NAME, "InstantiateAssets failed!");
         return false;
     }
 
+    if (!Localization::Init())
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Localization init failed!");
+        return false;
+    }
+
+    //  Not being able to watch assets is not fatal, game just won't pick up the changes.
+    if (Settings::GetValue<bool>("hot_reload", false))
+        AssetLoader::WatchAssets();
+
     if (Settings::GetValue<bool>("scripts", true))
     {
         if (!Scripting::Runtime::Start())
@@ -268,6 +296,7 @@ void UnInitGame()
     Scripting::Runtime::Stop();
     delete InputInstance;
     Settings::Shutdown();
+    Localization::Shutdown();
     AssetLoader::Shutdown();
     UnInitSDL();
 }
@@ -317,6 +346,12 @@ void LoopGame()
 
     SDL_SetWindowTitle(GameWindow, titleWithFPS);
 
+    //  Assets streamed in the background become available here, only a few per frame to not cause a hitch.
+    AssetLoader::FinalizeRequests(StreamFinalizePerFrame);
+    SceneAsset::ContinueLoadingScenes();
+    AssetLoader::ReloadChangedAssets();
+    AssetLoader::EnforceMemoryBudgets();
+
     UpdateInput();
     UpdateLogic(FrameDelta);
     UpdateGfx(GameRenderer, FrameDelta);
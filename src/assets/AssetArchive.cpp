@@ -0,0 +1,74 @@
+#include "AssetArchive.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+AssetArchive::AssetArchive()
+{
+    Toc = nullptr;
+    EntriesCount = 0;
+}
+
+bool AssetArchive::Open(const std::string& archivePath)
+{
+    Close();
+
+    FileErrorType errorCode = 0;
+    auto mapping = FileMapping::Open(archivePath, errorCode);
+    if (!mapping)
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Can't open archive \"{}\" (error {}).", archivePath, errorCode);
+        return false;
+    }
+
+    if (mapping->GetSize() < sizeof(ArchiveHeader))
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Archive \"{}\" is too small to be valid.", archivePath);
+        return false;
+    }
+
+    const ArchiveHeader* header = (const ArchiveHeader*)mapping->GetData();
+    if (header->Magic != ArchiveMagic || header->Version != ArchiveVersion)
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Archive \"{}\" has unknown format or version {}.", archivePath, header->Version);
+        return false;
+    }
+
+    //  Table of contents must fit in the file completely.
+    if (header->TocOffset > mapping->GetSize() ||
+        header->EntriesCount > (mapping->GetSize() - header->TocOffset) / sizeof(ArchiveTocEntry))
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Archive \"{}\" table of contents is damaged.", archivePath);
+        return false;
+    }
+
+    Toc = (const ArchiveTocEntry*)(mapping->GetData() + header->TocOffset);
+    EntriesCount = header->EntriesCount;
+    Mapping = std::move(mapping);
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Archive \"{}\" mounted, {} files.", archivePath, EntriesCount);
+
+    return true;
+}
+
+void AssetArchive::Close()
+{
+    Mapping.reset();
+    Toc = nullptr;
+    EntriesCount = 0;
+}
+
+std::shared_ptr<const FileMapping> AssetArchive::Find(const std::string_view& path) const
+{
+    if (!Mapping)
+        return nullptr;
+
+    const HashType pathHash = HashPath(path);
+    const ArchiveTocEntry* tocEnd = Toc + EntriesCount;
+    const ArchiveTocEntry* entry = std::lower_bound(Toc, tocEnd, pathHash, [](const ArchiveTocEntry& e, const HashType h) { return e.PathHash < h; });
+
+    if (entry == tocEnd || entry->PathHash != pathHash)
+        return nullptr;
+
+    return FileMapping::Slice(Mapping, entry->Offset, entry->Size);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Generic.h"
+#include "FileMapping.h"
+
+//  Packed assets file layout:
+//      [ArchiveHeader]
+//      [file data]...          each file starts at 'ArchiveDataAlignment' boundary.
+//      [ArchiveTocEntry]...    'EntriesCount' entries, sorted by 'PathHash'.
+//  The path hashed is relative to assets base directory and always uses '/', i.e. 'gfx/menu/background.jpg' or 'startup.dat'.
+constexpr uint32_t  ArchiveMagic = 0x5047544d;  //  'MTGP'
+constexpr uint32_t  ArchiveVersion = 1;
+constexpr uint64_t  ArchiveDataAlignment = 16;
+
+struct ArchiveHeader
+{
+    uint32_t    Magic;
+    uint32_t    Version;
+    uint64_t    EntriesCount;
+    uint64_t    TocOffset;
+};
+
+struct ArchiveTocEntry
+{
+    HashType    PathHash;
+    uint64_t    Offset;
+    uint64_t    Size;
+};
+
+//  Read-only access to a packed assets file.
+//  The whole archive is mapped once and every file found inside is handed out as a view into that mapping.
+class AssetArchive
+{
+private:
+    std::shared_ptr<const FileMapping>  Mapping;
+    const ArchiveTocEntry*              Toc;
+    uint64_t                            EntriesCount;
+
+public:
+    AssetArchive();
+
+    bool            Open(const std::string& archivePath);
+    void            Close();
+
+    inline bool     IsOpen() const
+    {
+        return Mapping != nullptr;
+    }
+
+    //  Look up a file by it's path inside the archive. Returns nullptr if there's no such file.
+    std::shared_ptr<const FileMapping>  Find(const std::string_view& path) const;
+
+    static inline HashType HashPath(const std::string_view& path)
+    {
+        return xxh64::hash(path.data(), path.size(), 0);
+    }
+};
@@ -0,0 +1,137 @@
+#include "AssetCache.h"
+#include "Logger.h"
+
+std::unordered_map<HashType, AssetCache::tCacheEntry>   AssetCache::Entries;
+std::mutex              AssetCache::EntriesMutex;
+std::atomic_uint64_t    AssetCache::Hits = 0;
+std::atomic_uint64_t    AssetCache::Misses = 0;
+std::unordered_map<eAssetType, size_t>  AssetCache::ResidentBytes;
+
+AssetRef AssetCache::Acquire(const HashType nameHash, const std::function<AssetInterface*()>& load)
+{
+    std::promise<AssetRef> loadPromise;
+
+    {
+        std::unique_lock<std::mutex> lock(EntriesMutex);
+        tCacheEntry& entry = Entries[nameHash];
+
+        if (AssetRef asset = entry.Asset.lock())
+        {
+            Hits++;
+            return asset;
+        }
+
+        //  Somebody else is loading it right now, wait for them to finish.
+        if (entry.PendingLoad.valid())
+        {
+            const auto pendingLoad = entry.PendingLoad;
+            lock.unlock();
+
+            Hits++;
+            return pendingLoad.get();
+        }
+
+        entry.PendingLoad = loadPromise.get_future().share();
+        Misses++;
+    }
+
+    //  Loading is done without holding the lock, assets may acquire other assets while parsing.
+    AssetInterface* loadedAsset = nullptr;
+    try
+    {
+        loadedAsset = load();
+    }
+    catch (...)
+    {
+        //  Threads waiting for this load get the exception too, instead of waiting forever. Next 'Acquire' tries loading it again.
+        {
+            std::lock_guard<std::mutex> lock(EntriesMutex);
+            Entries.erase(nameHash);
+        }
+
+        loadPromise.set_exception(std::current_exception());
+        throw;
+    }
+
+    AssetRef asset = loadedAsset ? AssetRef(loadedAsset, &AssetCache::Release) : nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(EntriesMutex);
+        tCacheEntry& entry = Entries[nameHash];
+
+        entry.PendingLoad = {};
+        if (asset)
+        {
+            entry.Asset = asset;
+            ResidentBytes[asset->GetAssetType()] += asset->GetDataSize();
+        }
+        else
+        {
+            Entries.erase(nameHash);
+        }
+    }
+
+    loadPromise.set_value(asset);
+
+    return asset;
+}
+
+AssetRef AssetCache::Find(const HashType nameHash)
+{
+    std::lock_guard<std::mutex> lock(EntriesMutex);
+
+    const auto entry = Entries.find(nameHash);
+    if (entry == Entries.end())
+        return nullptr;
+
+    return entry->second.Asset.lock();
+}
+
+AssetRef AssetCache::Replace(const HashType nameHash, AssetInterface* asset)
+{
+    AssetRef assetRef(asset, &AssetCache::Release);
+
+    std::lock_guard<std::mutex> lock(EntriesMutex);
+    Entries[nameHash].Asset = assetRef;
+    ResidentBytes[asset->GetAssetType()] += asset->GetDataSize();
+
+    return assetRef;
+}
+
+size_t AssetCache::GetResidentCount()
+{
+    std::lock_guard<std::mutex> lock(EntriesMutex);
+
+    size_t residentCount = 0;
+    for (const auto& [nameHash, entry] : Entries)
+    {
+        if (!entry.Asset.expired())
+            residentCount++;
+    }
+
+    return residentCount;
+}
+
+size_t AssetCache::GetResidentBytes(const eAssetType assetType)
+{
+    std::lock_guard<std::mutex> lock(EntriesMutex);
+
+    const auto residentBytes = ResidentBytes.find(assetType);
+    return residentBytes != ResidentBytes.end() ? residentBytes->second : 0;
+}
+
+void AssetCache::Release(AssetInterface* asset)
+{
+    {
+        std::lock_guard<std::mutex> lock(EntriesMutex);
+        ResidentBytes[asset->GetAssetType()] -= asset->GetDataSize();
+
+        //  The entry might have been taken over by a newer instance of the same asset already, leave it alone then.
+        const auto entry = Entries.find(asset->GetNameHash());
+        if (entry != Entries.end() && entry->second.Asset.expired() && !entry->second.PendingLoad.valid())
+            Entries.erase(entry);
+    }
+
+    //  Deleting an asset (i.e. a scene) can release other assets, so this is done without holding the lock.
+    delete asset;
+}
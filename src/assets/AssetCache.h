@@ -0,0 +1,57 @@
+#pragma once
+
+#include "AssetInterface.h"
+
+#include <mutex>
+#include <future>
+#include <atomic>
+#include <functional>
+
+//  Keeps track of every resident asset by it's name hash, so an asset referenced many times is only loaded once.
+//  Assets are handed out as shared handles. An asset is freed as soon as the last handle to it is dropped.
+class AssetCache
+{
+private:
+    struct tCacheEntry
+    {
+        std::weak_ptr<AssetInterface>   Asset;
+        //  Valid while the asset is being loaded, so other threads wanting the same asset wait for it instead.
+        std::shared_future<AssetRef>    PendingLoad;
+    };
+
+    static std::unordered_map<HashType, tCacheEntry>    Entries;
+    static std::mutex                                   EntriesMutex;
+    static std::atomic_uint64_t                         Hits;
+    static std::atomic_uint64_t                         Misses;
+    //  Sum of 'DataSize' of every resident asset, by asset type.
+    static std::unordered_map<eAssetType, size_t>       ResidentBytes;
+
+    //  Handle deleter, called once the last reference to an asset is gone.
+    static void     Release(AssetInterface* asset);
+
+public:
+    //  Get an asset with 'nameHash'. If it's not resident, 'load' is called to create it.
+    //  'load' may return nullptr if loading failed, then nullptr is returned to everyone who asked for this asset.
+    //  If 'load' throws, the exception is passed on to everyone who asked for this asset.
+    static AssetRef Acquire(const HashType nameHash, const std::function<AssetInterface*()>& load);
+
+    //  Get an asset only if it's already resident.
+    static AssetRef Find(const HashType nameHash);
+
+    //  Make 'asset' the resident instance for 'nameHash', i.e. when it was reloaded. Following 'Acquire' calls will get this one.
+    //  The previous instance stays alive for as long as somebody is still holding it.
+    static AssetRef Replace(const HashType nameHash, AssetInterface* asset);
+
+    static inline const uint64_t GetHits()
+    {
+        return Hits;
+    }
+
+    static inline const uint64_t GetMisses()
+    {
+        return Misses;
+    }
+
+    static size_t   GetResidentCount();
+    static size_t   GetResidentBytes(const eAssetType assetType);
+};
@@ -0,0 +1,125 @@
+#include "AssetHandleTable.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+AssetHandleTable::AssetHandleTable(AssetReloadFunction reloadFunction)
+{
+    AccessCounter = 0;
+    ReloadFunction = std::move(reloadFunction);
+}
+
+AssetInterface* AssetHandleTable::GetSlotAsset(const uint32_t index, const uint32_t generation)
+{
+    if (index >= Slots.size() || Slots[index].Generation != generation)
+        return nullptr;
+
+    tSlot& slot = Slots[index];
+    if (!slot.Asset && !slot.EvictedPath.empty())
+    {
+        slot.Asset = ReloadFunction(slot.EvictedPath);
+        if (!slot.Asset)
+            return nullptr;
+
+        slot.EvictedPath.clear();
+    }
+
+    slot.LastAccess = ++AccessCounter;
+
+    return slot.Asset.get();
+}
+
+bool AssetHandleTable::RemoveSlot(const uint32_t index, const uint32_t generation)
+{
+    //  Evicted asset doesn't need to be loaded just to be removed.
+    if (index >= Slots.size() || Slots[index].Generation != generation || (!Slots[index].Asset && Slots[index].EvictedPath.empty()))
+        return false;
+
+    tSlot& slot = Slots[index];
+    NameIndex.erase(slot.NameHash);
+    slot.Asset.reset();
+    slot.EvictedPath.clear();
+
+    //  Generation zero is reserved for null handles.
+    if (++slot.Generation == 0)
+        slot.Generation = 1;
+
+    FreeSlots.push_back(index);
+
+    return true;
+}
+
+AssetHandle<AssetInterface> AssetHandleTable::Add(const AssetRef& asset)
+{
+    const auto entry = NameIndex.find(asset->GetNameHash());
+    if (entry != NameIndex.end())
+        return { entry->second, Slots[entry->second].Generation };
+
+    uint32_t index;
+    if (!FreeSlots.empty())
+    {
+        index = FreeSlots.back();
+        FreeSlots.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)Slots.size();
+        Slots.push_back({ nullptr, {}, 0, eAssetType::TEXT, 1, 0 });
+    }
+
+    tSlot& slot = Slots[index];
+    slot.Asset = asset;
+    slot.NameHash = asset->GetNameHash();
+    slot.AssetType = asset->GetAssetType();
+    slot.LastAccess = ++AccessCounter;
+    NameIndex.emplace(slot.NameHash, index);
+
+    return { index, Slots[index].Generation };
+}
+
+bool AssetHandleTable::Replace(const AssetRef& asset)
+{
+    const auto entry = NameIndex.find(asset->GetNameHash());
+    if (entry == NameIndex.end())
+        return false;
+
+    Slots[entry->second].Asset = asset;
+    Slots[entry->second].EvictedPath.clear();
+
+    return true;
+}
+
+size_t AssetHandleTable::Evict(const eAssetType assetType, const size_t bytesToFree, const AssetPinnedFunction& isPinned)
+{
+    //  Only this table holds a reference to these, so they are freed as soon as they are evicted.
+    std::vector<uint32_t> candidates;
+    for (uint32_t index = 0; index < Slots.size(); index++)
+    {
+        const tSlot& slot = Slots[index];
+        if (slot.Asset && slot.AssetType == assetType && slot.Asset.use_count() == 1 && !(isPinned && isPinned(*slot.Asset)))
+            candidates.push_back(index);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [this](const uint32_t a, const uint32_t b) { return Slots[a].LastAccess < Slots[b].LastAccess; });
+
+    size_t bytesFreed = 0;
+    for (const uint32_t index : candidates)
+    {
+        if (bytesFreed >= bytesToFree)
+            break;
+
+        tSlot& slot = Slots[index];
+        bytesFreed += slot.Asset->GetDataSize();
+        slot.EvictedPath = slot.Asset->GetPath();
+        slot.Asset.reset();
+    }
+
+    return bytesFreed;
+}
+
+void AssetHandleTable::Clear()
+{
+    //  Slots are kept, so handles from before can't accidentally match whatever is put in them later.
+    for (uint32_t index = 0; index < Slots.size(); index++)
+        RemoveSlot(index, Slots[index].Generation);
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "AssetInterface.h"
+
+#include <functional>
+
+//  A reference to an asset registered in 'AssetHandleTable'. It's just an index and a generation, so it's cheap to copy and store.
+//  Once the asset is removed from the table, it's slot generation changes and all handles to it are stale.
+template <class T>
+struct AssetHandle
+{
+    uint32_t    Index = 0;
+    //  Live slots never have generation zero, so a default constructed handle never refers to anything.
+    uint32_t    Generation = 0;
+
+    inline bool IsNull() const
+    {
+        return Generation == 0;
+    }
+
+    inline bool operator==(const AssetHandle& other) const = default;
+
+    //  Same handle, but for another asset class. Type is checked once the handle is used.
+    template <class C>
+    inline AssetHandle<C> As() const
+    {
+        return { Index, Generation };
+    }
+};
+
+//  Loads an evicted asset again, given it's full path.
+using AssetReloadFunction = std::function<AssetRef(const std::string&)>;
+
+//  Tells whether an asset must stay resident, even though nothing but the table references it.
+using AssetPinnedFunction = std::function<bool(AssetInterface&)>;
+
+//  Owns the registered assets and hands out handles to them. Looking up an asset by handle or by name hash doesn't depend on how many assets there are.
+//  An asset can be evicted to free memory, it's slot and handles stay valid and the asset is loaded again next time it's accessed.
+//  Not thread safe, must only be used from the main thread.
+class AssetHandleTable
+{
+private:
+    struct tSlot
+    {
+        AssetRef    Asset;
+        //  Only set while asset is evicted, so it can be loaded again.
+        std::string EvictedPath;
+        HashType    NameHash;
+        eAssetType  AssetType;
+        uint32_t    Generation;
+        //  Value of 'AccessCounter' when asset was last accessed, least recently used assets are evicted first.
+        uint64_t    LastAccess;
+    };
+
+    std::vector<tSlot>                      Slots;
+    std::vector<uint32_t>                   FreeSlots;
+    std::unordered_map<HashType, uint32_t>  NameIndex;
+    uint64_t                                AccessCounter;
+    AssetReloadFunction                     ReloadFunction;
+
+    AssetInterface* GetSlotAsset(const uint32_t index, const uint32_t generation);
+    bool            RemoveSlot(const uint32_t index, const uint32_t generation);
+
+    template <class T>
+    static inline bool IsOfType(const eAssetType assetType)
+    {
+        if constexpr (std::is_same_v<T, AssetInterface>)
+            return true;
+        else
+            return assetType == T::ClassAssetType;
+    }
+
+public:
+    explicit AssetHandleTable(AssetReloadFunction reloadFunction);
+
+    //  Add asset to the table, unless an asset with the same name hash is there already. Either way, returns a handle to the one in the table.
+    AssetHandle<AssetInterface> Add(const AssetRef& asset);
+
+    //  Put 'asset' in place of the asset with the same name hash. Handles to the previous one stay valid and refer to 'asset' now.
+    bool            Replace(const AssetRef& asset);
+
+    //  Remove all assets, every handle given out so far becomes stale.
+    void            Clear();
+
+    //  Returns nullptr if the handle is stale or the asset is not of type 'T'. Evicted asset is loaded again first.
+    template <class T>
+    inline T*       Get(const AssetHandle<T> handle)
+    {
+        AssetInterface* asset = GetSlotAsset(handle.Index, handle.Generation);
+        return asset && IsOfType<T>(asset->GetAssetType()) ? static_cast<T*>(asset) : nullptr;
+    }
+
+    //  Same as 'Get', but evicted asset is not loaded again and it doesn't count as an access.
+    template <class T>
+    inline T*       GetResident(const AssetHandle<T> handle) const
+    {
+        if (handle.Index >= Slots.size() || Slots[handle.Index].Generation != handle.Generation || !Slots[handle.Index].Asset)
+            return nullptr;
+
+        AssetInterface* asset = Slots[handle.Index].Asset.get();
+        return IsOfType<T>(asset->GetAssetType()) ? static_cast<T*>(asset) : nullptr;
+    }
+
+    //  Same as 'Get', but the returned reference keeps the asset alive.
+    template <class T>
+    inline AssetRef GetRef(const AssetHandle<T> handle)
+    {
+        return Get(handle) ? Slots[handle.Index].Asset : nullptr;
+    }
+
+    //  Returns null handle if there's no asset with this name hash or it's not of type 'T'.
+    template <class T = AssetInterface>
+    AssetHandle<T>  Find(const HashType nameHash) const
+    {
+        const auto entry = NameIndex.find(nameHash);
+        if (entry == NameIndex.end() || !IsOfType<T>(Slots[entry->second].AssetType))
+            return {};
+
+        return { entry->second, Slots[entry->second].Generation };
+    }
+
+    template <class T>
+    inline bool     Remove(const AssetHandle<T> handle)
+    {
+        return RemoveSlot(handle.Index, handle.Generation);
+    }
+
+    inline const size_t GetCount() const
+    {
+        return NameIndex.size();
+    }
+
+    //  Evict least recently used assets of 'assetType' until at least 'bytesToFree' of their 'DataSize' is freed.
+    //  Assets referenced from anywhere else than this table, or 'isPinned' ones, are left alone. Returns how many bytes were freed.
+    size_t          Evict(const eAssetType assetType, const size_t bytesToFree, const AssetPinnedFunction& isPinned = nullptr);
+};
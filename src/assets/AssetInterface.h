@@ -1,6 +1,19 @@
 #pragma once
 
 #include "Generic.h"
+#include "FileMapping.h"
+
+//  When adding a new type of 'asset' don't forget to put it into 'eAssetType' enumeration, but also into 'AssetPathPrefix'.
+//  Also, don't forget to modify the 'switch' statement in AssetInterfaceFactory to account for your new AssetType.
+enum class eAssetType : HashType
+{
+    TEXT = xxh64::hash("text", 4, 0),
+    GFX = xxh64::hash("gfx", 3, 0),
+    SOUND = xxh64::hash("sound", 5, 0),
+    SCRIPT = xxh64::hash("script", 6, 0),
+    SCENE = xxh64::hash("scene", 5, 0),
+    MODEL = xxh64::hash("model", 5, 0)
+};
 
 //  An abstract asset can only be used to load asset-specific data into asset instance.
 class AssetInterface
@@ -9,15 +22,30 @@ protected:
     std::string         Name;
     HashType            NameHash;
     size_t              DataSize;
+    eAssetType          AssetType;
+
+    //  Only set for assets that keep referencing their raw bytes after parsing (see 'RetainsData').
+    std::shared_ptr<const FileMapping>  DataMapping;
 
 public:
     virtual         ~AssetInterface() {};
     virtual void    ParseData(const uint8_t* data) = 0;
 
-    void            SetData(const std::string& name)
+    void            SetData(const std::string& name, const eAssetType assetType)
     {
         Name = name;
         NameHash = xxh64::hash(name.c_str(), name.length(), 0);
+        AssetType = assetType;
+    }
+
+    inline const eAssetType GetAssetType() const
+    {
+        return AssetType;
+    }
+
+    inline const HashType GetNameHash() const
+    {
+        return NameHash;
     }
 
     inline void     SetDataSize(const size_t size)
@@ -25,17 +53,52 @@ public:
         DataSize = size;
     }
 
+    inline const size_t GetDataSize() const
+    {
+        return DataSize;
+    }
+
+    //  Full file path asset was loaded from, as opposed to 'GetName'.
+    inline const std::string& GetPath() const
+    {
+        return Name;
+    }
+
+    //  Override this if asset wants to point into the buffer passed to 'ParseData' instead of copying from it.
+    //  The loader will then hand the file mapping over to the asset, so the buffer stays valid for the asset lifetime.
+    virtual bool    RetainsData() const
+    {
+        return false;
+    }
+
+    inline void     SetDataMapping(const std::shared_ptr<const FileMapping>& mapping)
+    {
+        DataMapping = mapping;
+    }
+
     template <class C>
     inline C&       CastTo()
     {
         return static_cast<C&>(*this);
     }
 
-    const inline std::string GetName() const
+    //  Checked version of 'CastTo', returns nullptr if this asset is not of class 'C'.
+    template <class C>
+    inline C*       As()
+    {
+        return AssetType == C::ClassAssetType ? static_cast<C*>(this) : nullptr;
+    }
+
+    //  File name without folders. It points into the full name, so nothing is allocated.
+    inline const std::string_view GetName() const
     {
-        if (Name.find_first_of('/') == std::string::npos)
+        const size_t lastSlashPosition = Name.find_last_of('/');
+        if (lastSlashPosition == std::string::npos)
             return Name;
 
-        return Name.substr(Name.find_last_of('/') + 1);
+        return std::string_view(Name).substr(lastSlashPosition + 1);
     }
-};
\ No newline at end of file
+};
+
+//  A shared handle to a loaded asset, see AssetCache.
+using AssetRef = std::shared_ptr<AssetInterface>;
\ No newline at end of file
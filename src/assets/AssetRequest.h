@@ -0,0 +1,130 @@
+#pragma once
+
+#include "AssetInterface.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+
+class AssetRequest;
+
+using AssetRequestHandle = std::shared_ptr<AssetRequest>;
+using AssetRequestCallback = std::function<void(const AssetRequestHandle&)>;
+
+//  A handle to an asset requested with 'AssetLoader::RequestAsset'.
+//  The asset is read and parsed on a background thread, then it's finalized (registered and callback is called)
+//  on the main thread by 'AssetLoader::FinalizeRequests', a few requests every frame.
+class AssetRequest
+{
+    friend class AssetLoader;
+
+public:
+    enum eRequestState
+    {
+        QUEUED = 0,
+        LOADED,     //  Background work is done, waiting to be finalized on the main thread.
+        READY,      //  Finalized, asset can be used.
+        FAILED,     //  Asset couldn't be loaded, callback was called anyway.
+    };
+
+private:
+    std::string                 Path;
+    int32_t                     Priority;
+    AssetRequestCallback        Callback;
+    AssetRef                    Asset;
+    std::atomic<eRequestState>  State;
+
+    std::mutex                  StateMutex;
+    std::condition_variable     StateChanged;
+
+    //  Called from the background thread once loading is done.
+    void            SetLoaded(AssetRef asset)
+    {
+        {
+            std::lock_guard<std::mutex> lock(StateMutex);
+            Asset = std::move(asset);
+            State = LOADED;
+        }
+
+        StateChanged.notify_all();
+    }
+
+public:
+    AssetRequest(const std::string& path, const int32_t priority, AssetRequestCallback callback)
+        : Path(path), Priority(priority), Callback(std::move(callback)), State(QUEUED)
+    {
+    }
+
+    inline const std::string& GetPath() const
+    {
+        return Path;
+    }
+
+    inline const int32_t GetPriority() const
+    {
+        return Priority;
+    }
+
+    inline const eRequestState GetState() const
+    {
+        return State;
+    }
+
+    //  Is request finalized, either successfully or not.
+    inline bool     IsDone() const
+    {
+        const eRequestState state = State;
+        return state == READY || state == FAILED;
+    }
+
+    //  Asset is only available after request is done. Returns nullptr if loading failed.
+    inline const AssetRef& GetAsset() const
+    {
+        return Asset;
+    }
+
+    //  Block until the background thread is done with this request.
+    //  This doesn't finalize the request, use 'AssetLoader::WaitRequest' on the main thread for that.
+    void            WaitLoaded()
+    {
+        std::unique_lock<std::mutex> lock(StateMutex);
+        StateChanged.wait(lock, [this]() { return State != QUEUED; });
+    }
+};
+
+//  Requests that background threads are done with, waiting to be finalized on the main thread.
+//  Higher priority requests are taken first, the ones with the same priority in the order they were completed.
+class CompletedRequestQueue
+{
+private:
+    std::vector<AssetRequestHandle> Requests;
+    std::mutex                      RequestsMutex;
+
+public:
+    void            Push(AssetRequestHandle request)
+    {
+        std::lock_guard<std::mutex> lock(RequestsMutex);
+        Requests.push_back(std::move(request));
+    }
+
+    //  Take at most 'maxCount' requests out of the queue, the rest are left for later.
+    std::vector<AssetRequestHandle> Take(const size_t maxCount)
+    {
+        std::lock_guard<std::mutex> lock(RequestsMutex);
+        std::stable_sort(Requests.begin(), Requests.end(), [](const AssetRequestHandle& a, const AssetRequestHandle& b) { return a->GetPriority() > b->GetPriority(); });
+
+        const size_t takeCount = std::min(maxCount, Requests.size());
+        std::vector<AssetRequestHandle> requests(Requests.begin(), Requests.begin() + takeCount);
+        Requests.erase(Requests.begin(), Requests.begin() + takeCount);
+
+        return requests;
+    }
+
+    void            Clear()
+    {
+        std::lock_guard<std::mutex> lock(RequestsMutex);
+        Requests.clear();
+    }
+};
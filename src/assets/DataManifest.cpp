@@ -0,0 +1,198 @@
+#include "DataManifest.h"
+#include "FileMapping.h"
+#include "Logger.h"
+
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+DataManifest::DataManifest()
+{
+    HasActiveScene = false;
+    LinesRead = 0;
+    Incomplete = false;
+}
+
+bool DataManifest::Load(const std::string& manifestPath)
+{
+    FileErrorType errorCode = 0;
+    const auto mapping = FileMapping::Open(manifestPath, errorCode);
+    if (!mapping || mapping->GetSize() < sizeof(DataManifestHeader))
+        return false;
+
+    const uint8_t* position = mapping->GetData();
+    const uint8_t* end = position + mapping->GetSize();
+
+    //  Manifest might be left over from a crashed run or older version, so every read is checked against the end of file.
+    const auto ReadValue = [&position, end](auto& value) -> bool
+        {
+            if ((size_t)(end - position) < sizeof(value))
+                return false;
+
+            memcpy(&value, position, sizeof(value));
+            position += sizeof(value);
+            return true;
+        };
+
+    const auto ReadString = [&position, end, &ReadValue](std::string& value) -> bool
+        {
+            uint32_t length = 0;
+            if (!ReadValue(length) || (size_t)(end - position) < length)
+                return false;
+
+            value.assign((const char*)position, length);
+            position += length;
+            return true;
+        };
+
+    //  A damaged count would make a huge allocation before any record is read, so counts are checked against what's left of the file first.
+    const auto FitsInFile = [&position, end](const uint32_t count, const size_t minimumRecordSize) -> bool
+        {
+            return count <= (size_t)(end - position) / minimumRecordSize;
+        };
+
+    //  Shortest string is it's length alone.
+    constexpr size_t MinimumStringSize = sizeof(uint32_t);
+    constexpr size_t MinimumDataFileSize = sizeof(uint64_t) + sizeof(int64_t) + MinimumStringSize;
+
+    DataManifestHeader header;
+    if (!ReadValue(header) || header.Magic != DataManifestMagic || header.Version != DataManifestVersion)
+        return false;
+
+    if (!FitsInFile(header.DataFilesCount, MinimumDataFileSize))
+        return false;
+
+    DataFiles.resize(header.DataFilesCount);
+    for (auto& dataFile : DataFiles)
+    {
+        if (!ReadValue(dataFile.Size) || !ReadValue(dataFile.ModifiedTime) || !ReadString(dataFile.Path))
+            return false;
+    }
+
+    HasActiveScene = header.HasActiveScene != 0;
+    if (HasActiveScene && !ReadString(ActiveScene))
+        return false;
+
+    if (!FitsInFile(header.AssetReferencesCount, MinimumStringSize))
+        return false;
+
+    AssetReferences.resize(header.AssetReferencesCount);
+    for (auto& assetReference : AssetReferences)
+    {
+        if (!ReadString(assetReference))
+            return false;
+    }
+
+    if (!FitsInFile(header.PrefetchScenesCount, MinimumStringSize))
+        return false;
+
+    PrefetchScenes.resize(header.PrefetchScenesCount);
+    for (auto& prefetchScene : PrefetchScenes)
+    {
+        if (!ReadString(prefetchScene))
+            return false;
+    }
+
+    LinesRead = header.LinesRead;
+
+    return position == end;
+}
+
+bool DataManifest::Save(const std::string& manifestPath) const
+{
+    if (Incomplete)
+        return false;
+
+    std::ofstream outFile(manifestPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outFile.is_open())
+        return false;
+
+    const auto WriteString = [&outFile](const std::string& value)
+        {
+            const uint32_t length = (uint32_t)value.length();
+            outFile.write((const char*)&length, sizeof(length));
+            outFile.write(value.data(), length);
+        };
+
+    const DataManifestHeader header = { DataManifestMagic, DataManifestVersion, (uint32_t)DataFiles.size(), (uint32_t)AssetReferences.size(), LinesRead, HasActiveScene, (uint32_t)PrefetchScenes.size() };
+    outFile.write((const char*)&header, sizeof(header));
+
+    for (const auto& dataFile : DataFiles)
+    {
+        outFile.write((const char*)&dataFile.Size, sizeof(dataFile.Size));
+        outFile.write((const char*)&dataFile.ModifiedTime, sizeof(dataFile.ModifiedTime));
+        WriteString(dataFile.Path);
+    }
+
+    if (HasActiveScene)
+        WriteString(ActiveScene);
+
+    for (const auto& assetReference : AssetReferences)
+        WriteString(assetReference);
+
+    for (const auto& prefetchScene : PrefetchScenes)
+        WriteString(prefetchScene);
+
+    outFile.close();
+
+    //  Don't leave a half written manifest behind, it'd only be rejected on next start anyway.
+    if (outFile.fail())
+    {
+        std::error_code errorCode;
+        std::filesystem::remove(manifestPath, errorCode);
+        return false;
+    }
+
+    return true;
+}
+
+bool DataManifest::IsUpToDate() const
+{
+    if (DataFiles.empty())
+        return false;
+
+    for (const auto& dataFile : DataFiles)
+    {
+        tDataFileStamp currentStamp;
+        if (!GetFileStamp(dataFile.Path, currentStamp))
+            return false;
+
+        if (currentStamp.Size != dataFile.Size || currentStamp.ModifiedTime != dataFile.ModifiedTime)
+            return false;
+    }
+
+    return true;
+}
+
+bool DataManifest::AddDataFile(const std::string& path)
+{
+    tDataFileStamp stamp;
+    if (!GetFileStamp(path, stamp))
+    {
+        Incomplete = true;
+        return false;
+    }
+
+    DataFiles.push_back(stamp);
+
+    return true;
+}
+
+bool DataManifest::GetFileStamp(const std::string& path, tDataFileStamp& stamp)
+{
+    std::error_code errorCode;
+
+    const auto fileSize = std::filesystem::file_size(path, errorCode);
+    if (errorCode)
+        return false;
+
+    const auto modifiedTime = std::filesystem::last_write_time(path, errorCode);
+    if (errorCode)
+        return false;
+
+    stamp.Path = path;
+    stamp.Size = (uint64_t)fileSize;
+    stamp.ModifiedTime = (int64_t)modifiedTime.time_since_epoch().count();
+
+    return true;
+}
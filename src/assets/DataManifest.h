@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Generic.h"
+
+//  Compiled data file layout:
+//      [DataManifestHeader]
+//      [DataFilesCount x (uint64 size, int64 modified time, string path)]    data file and all of it's includes.
+//      [string active scene]                                                 only present if 'HasActiveScene' is set.
+//      [AssetReferencesCount x string]
+//      [PrefetchScenesCount x string]
+//  A string is stored as uint32 length followed by characters, without terminating zero.
+constexpr uint32_t  DataManifestMagic = 0x4d47544d;     //  'MTGM'
+constexpr uint32_t  DataManifestVersion = 2;
+
+struct DataManifestHeader
+{
+    uint32_t    Magic;
+    uint32_t    Version;
+    uint32_t    DataFilesCount;
+    uint32_t    AssetReferencesCount;
+    uint32_t    LinesRead;
+    uint32_t    HasActiveScene;
+    uint32_t    PrefetchScenesCount;
+};
+
+//  Everything 'AssetLoader::ParseDataFile' gets out of a data file and it's includes.
+//  It's saved next to the data file, so the next start can skip reading and parsing the text as long as none of the files were touched.
+class DataManifest
+{
+public:
+    struct tDataFileStamp
+    {
+        std::string Path;
+        uint64_t    Size;
+        int64_t     ModifiedTime;
+    };
+
+    std::vector<tDataFileStamp> DataFiles;
+    std::vector<std::string>    AssetReferences;
+    std::vector<std::string>    PrefetchScenes;
+    std::string                 ActiveScene;
+    bool                        HasActiveScene;
+    uint32_t                    LinesRead;
+
+    //  Set when one of the includes couldn't be read, such manifest is never saved.
+    bool                        Incomplete;
+
+    DataManifest();
+
+    bool            Load(const std::string& manifestPath);
+    bool            Save(const std::string& manifestPath) const;
+
+    //  Are all data files still the same size and have the same modification time as when manifest was made.
+    bool            IsUpToDate() const;
+
+    //  Record 'path' as one of the files manifest depends on.
+    bool            AddDataFile(const std::string& path);
+
+    static bool     GetFileStamp(const std::string& path, tDataFileStamp& stamp);
+};
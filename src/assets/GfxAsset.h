@@ -7,6 +7,8 @@ class GfxAsset : public AssetInterface
 private:
 
 public:
+    static constexpr eAssetType ClassAssetType = eAssetType::GFX;
+
     GfxAsset();
 
     virtual         ~GfxAsset();
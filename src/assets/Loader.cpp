@@ -2,19 +2,25 @@
 #include "AssetInterface.h"
 #include "AssetInterfaceFactory.h"
 #include "Settings.h"
+#include "Runtime.h"
+#include "Localization.h"
 
 #include <iostream>
-#include <fstream>
 
-AssetLoader AssetLoader::Instance;
-std::vector<AssetInterface*>    AssetLoader::Assets;
+AssetHandleTable                AssetLoader::Assets(&AssetLoader::ReloadEvictedAsset);
+AssetArchive                    AssetLoader::Archive;
+std::unique_ptr<ThreadPool>     AssetLoader::Workers;
+std::unique_ptr<ThreadPool>     AssetLoader::StreamingWorkers;
+CompletedRequestQueue           AssetLoader::CompletedRequests;
+std::atomic_bool                AssetLoader::StreamingCancelled = false;
+std::unique_ptr<FileWatcher>    AssetLoader::Watcher;
+std::unordered_map<eAssetType, size_t>  AssetLoader::MemoryBudgets;
+std::unordered_map<eAssetType, size_t>  AssetLoader::StalledEvictions;
 
 AssetLoader::AssetLoader()
 {
     FileOpenStatus = -1;
-    FilePtr = nullptr;
-    FileDataBuffer = nullptr;
-    FileSize = -1;
+    FileSize = 0;
     AssetInterfaceRef = nullptr;
 }
 
@@ -23,47 +29,77 @@ AssetLoader::~AssetLoader()
     CloseAsset();
 }
 
+void AssetLoader::Shutdown()
+{
+    //  Requests that haven't started yet are dropped, the ones already loading are finished.
+    StreamingCancelled = true;
+    StreamingWorkers.reset();
+    CompletedRequests.Clear();
+    Watcher.reset();
+
+    const size_t assetsResident = AssetCache::GetResidentCount();
+
+    SceneAsset::ScenesList.clear();
+    SceneAsset::PrefetchRequests.clear();
+    Assets.Clear();
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Unloaded {} assets.", assetsResident - AssetCache::GetResidentCount());
+
+    Workers.reset();
+}
+
 bool AssetLoader::CloseAsset()
 {
-    if (!FilePtr)
+    if (!FileView)
         return false;
 
-    fclose(FilePtr);
-
-    FilePtr = nullptr;
+    //  Assets that retain data hold their own reference, so this only unmaps the file if nobody else needs it.
+    FileView.reset();
     FileOpenStatus = -1;
-    delete[] FileDataBuffer;
-    FileSize = -1;
+    FileSize = 0;
 
     return true;
 }
 
-bool AssetLoader::ParseDataFile(const std::string dataFilePath)
+bool AssetLoader::CollectDataFile(const std::string& dataFilePath, DataManifest& manifest)
 {
-    AssetLoader& instance = GetInstance();
-
     //  Try and open data file that contains files to be loaded.
     //  It may also contain included files.
-    std::ifstream dataFileStream(dataFilePath.c_str(), std::ios::in);
-    if (!dataFileStream.is_open())
+    const auto dataFile = OpenDataFile(dataFilePath);
+    if (!dataFile)
     {
         Logger::ERROR(TAG_FUNCTION_NAME, "Can't open '{}'!", dataFilePath);
+        manifest.Incomplete = true;
         return false;
     }
 
+    //  Files inside the archive never change, so there's nothing to validate manifest against.
+    if (!Archive.IsOpen())
+        manifest.AddDataFile(dataFilePath);
+
     Logger::TRACE(TAG_FUNCTION_NAME, "Reading DATA \"{}\"...", dataFilePath);
 
-    //  Assuming file is open and good, read and instantiate all referenced assets.
-    uint32_t filesRead = 0; //  How many files we already read.
-    uint32_t linesRead = 0; //  How many lines (non-comments, only data lines) we read.
+    //  Assuming file is open and good, collect all referenced assets.
     std::string buffer;
-    while (std::getline(dataFileStream, buffer, '\n'))
+    const std::string_view dataFileView((const char*)dataFile->GetData(), dataFile->GetSize());
+    size_t lineStart = 0;
+    while (lineStart < dataFileView.size())
     {
+        size_t lineEnd = dataFileView.find_first_of('\n', lineStart);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = dataFileView.size();
+
+        buffer.assign(dataFileView.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+
+        if (buffer.ends_with('\r'))
+            buffer.pop_back();
+
         //  Skip comments.
         if (buffer[0] == '/' && buffer[1] == '/')
             continue;
 
-        linesRead++;
+        manifest.LinesRead++;
 
         //  Skip empty line.
         //  This is done after 'lines read' is incremented, to correctly report errors placement.
@@ -76,8 +112,9 @@ bool AssetLoader::ParseDataFile(const std::string dataFilePath)
             //  It's an include. Open and try to parse included file.
             if (!strncmp(buffer.c_str() + 1, "include", 7))
             {
+                //  Included references are put in place of the include directive, so the order is kept.
                 Logger::TRACE(TAG_FUNCTION_NAME, "Parsing include \"{}\"...", (buffer.c_str() + 9));
-                ParseDataFile(buffer.c_str() + 9);
+                CollectDataFile(buffer.c_str() + 9, manifest);
                 continue;
             }
 
@@ -106,53 +143,399 @@ bool AssetLoader::ParseDataFile(const std::string dataFilePath)
             {
                 //  Set engine's active scene.
                 SceneAsset::ActiveScene = infoTokenValue;
+                manifest.ActiveScene = infoTokenValue;
+                manifest.HasActiveScene = true;
                 Logger::TRACE(TAG_FUNCTION_NAME, "Set \"Active Scene\" to \"{}\".", SceneAsset::ActiveScene);
                 continue;
             }
+
+            //  A scene game is likely to switch to, it's loaded in the background once data file is done.
+            if (infoTokenType == "prefetchscene")
+            {
+                manifest.PrefetchScenes.push_back(infoTokenValue);
+                continue;
+            }
         }
 
-        if (!instance.OpenAsset(buffer))
-            continue;
+        manifest.AssetReferences.push_back(buffer);
+    }
 
-        //  NOTE: this function is referenced in "Scene" asset loader.
-        //  TODO: modify this to account for asset reference duplication and don't load it more than once.
-        //  Process asset data and add it to the list.
-        AssetInterface* asset = AssetInterfaceFactory::Create(instance.GetAssetType());
-        instance.SetAssetRef(asset);
+    return true;
+}
+
+bool AssetLoader::ReadDataFile(const std::string& dataFilePath, DataManifest& manifest)
+{
+    const bool useManifest = !Archive.IsOpen() && Settings::GetValue<bool>("manifest_cache", true);
+    const std::string manifestPath = dataFilePath + ".manifest";
 
-        //  Skip script loading if scripts are disabled.
-        if (instance.GetAssetType() == eAssetType::SCRIPT && Settings::GetValue<bool>("scripts", true) == false)
+    if (useManifest && manifest.Load(manifestPath) && manifest.IsUpToDate())
+    {
+        if (manifest.HasActiveScene)
         {
-            instance.CloseAsset();
-            filesRead++;
-            continue;
+            SceneAsset::ActiveScene = manifest.ActiveScene;
+            Logger::TRACE(TAG_FUNCTION_NAME, "Set \"Active Scene\" to \"{}\".", SceneAsset::ActiveScene);
         }
 
-        asset->ParseData(instance.GetDataBufferPtr());
+        Logger::TRACE(TAG_FUNCTION_NAME, "Using compiled manifest \"{}\", {} data files are unchanged.", manifestPath, manifest.DataFiles.size());
+        return true;
+    }
 
-        //  Don't add this script asset if there was an error when parsing script.
-        if (instance.GetAssetType() == eAssetType::SCRIPT && asset->CastTo<ScriptAsset>().GetErrorsFound())
-        {
-            instance.CloseAsset();
-            filesRead++;
+    //  Manifest is missing or stale, start over with the text.
+    manifest = {};
+    if (!CollectDataFile(dataFilePath, manifest))
+        return false;
+
+    if (useManifest && !manifest.Save(manifestPath))
+        Logger::WARNING(TAG_FUNCTION_NAME, "Can't save compiled manifest \"{}\".", manifestPath);
+
+    return true;
+}
+
+bool AssetLoader::ParseDataFile(const std::string dataFilePath)
+{
+    //  Directives are applied and includes are expanded first, that's cheap and must happen in order.
+    DataManifest manifest;
+    if (!ReadDataFile(dataFilePath, manifest))
+        return false;
+
+    const std::vector<std::string>& assetReferences = manifest.AssetReferences;
+    const uint32_t linesRead = manifest.LinesRead;  //  How many lines (non-comments, only data lines) we read.
+
+    //  The expensive part (reading and parsing) is spread across all worker threads.
+    std::vector<AssetRef> loadedAssets(assetReferences.size(), nullptr);
+    ParallelFor(assetReferences.size(), [&](const size_t index) { loadedAssets[index] = LoadAsset(assetReferences[index]); });
+
+    //  Registering is done here, so lists contents are the same regardless of what thread finished first.
+    uint32_t filesRead = 0;
+    for (const AssetRef& asset : loadedAssets)
+    {
+        if (!asset)
             continue;
+
+        RegisterAsset(asset);
+        filesRead++;
+    }
+
+    for (const auto& sceneName : manifest.PrefetchScenes)
+        SceneAsset::Prefetch(sceneName);
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Reading DATA done. Read {} lines, found {} file references, loaded {}.", linesRead, assetReferences.size(), filesRead);
+    Logger::TRACE(TAG_FUNCTION_NAME, "Asset cache: {} hits, {} misses, {} assets resident.", AssetCache::GetHits(), AssetCache::GetMisses(), AssetCache::GetResidentCount());
+
+    return true;
+}
+
+AssetRef AssetLoader::LoadAsset(const std::string& path)
+{
+    AssetLoader loader;
+    if (!loader.ResolvePath(path))
+        return nullptr;
+
+    //  Skip script loading if scripts are disabled.
+    if (loader.GetAssetType() == eAssetType::SCRIPT && Settings::GetValue<bool>("scripts", true) == false)
+        return nullptr;
+
+    //  Only touch the file if the asset is not resident already.
+    return AssetCache::Acquire(loader.GetFilePathHash(), [&loader]() { return CreateAsset(loader); });
+}
+
+AssetInterface* AssetLoader::CreateAsset(AssetLoader& loader)
+{
+    if (!loader.OpenFile())
+        return nullptr;
+
+    //  Process asset data.
+    AssetInterface* asset = AssetInterfaceFactory::Create(loader.GetAssetType());
+    loader.SetAssetRef(asset);
+    asset->ParseData(loader.GetDataBufferPtr());
+    loader.CloseAsset();
+
+    //  Don't return this script asset if there was an error when parsing script.
+    if (loader.GetAssetType() == eAssetType::SCRIPT && asset->CastTo<ScriptAsset>().GetErrorsFound())
+    {
+        delete asset;
+        return nullptr;
+    }
+
+    return asset;
+}
+
+AssetHandle<AssetInterface> AssetLoader::RegisterAsset(const AssetRef& asset)
+{
+    const AssetHandle<AssetInterface> existingHandle = Assets.Find(asset->GetNameHash());
+    if (!existingHandle.IsNull())
+        return existingHandle;
+
+    const AssetHandle<AssetInterface> handle = Assets.Add(asset);
+
+    if (asset->GetAssetType() == eAssetType::SCENE)
+        SceneAsset::ScenesList.push_back(handle.As<SceneAsset>());
+
+    return handle;
+}
+
+AssetHandle<SceneAsset> AssetLoader::FindScene(const std::string& sceneName)
+{
+    //  Scenes are registered by their full path, so the name is made into one instead of comparing names of every scene.
+    const std::string scenePath = AssetBaseDir + AssetPathPrefix.at(eAssetType::SCENE) + sceneName;
+    return Assets.Find<SceneAsset>(xxh64::hash(scenePath.c_str(), scenePath.length(), 0));
+}
+
+AssetRequestHandle AssetLoader::RequestAsset(const std::string& path, const int32_t priority, AssetRequestCallback callback)
+{
+    auto request = std::make_shared<AssetRequest>(path, priority, std::move(callback));
+
+    //  Only the main thread makes requests, so no locking is needed here.
+    if (!StreamingWorkers)
+    {
+        const uint32_t threadsCount = Settings::GetValue<uint32_t>("streaming_threads", 2);
+        StreamingWorkers = std::make_unique<ThreadPool>(std::max(threadsCount, 1u));
+        StreamingCancelled = false;
+    }
+
+    StreamingWorkers->Submit([request]()
+        {
+            AssetRef asset = StreamingCancelled ? nullptr : LoadAsset(request->GetPath());
+
+            //  Nobody can see a streamed scene until it's finalized, so all of it's entities are loaded right here instead of a slice every frame.
+            if (asset && asset->GetAssetType() == eAssetType::SCENE)
+                asset->CastTo<SceneAsset>().ContinueLoading(std::chrono::steady_clock::time_point::max(), SceneAsset::LoadBatchSize);
+
+            request->SetLoaded(std::move(asset));
+            CompletedRequests.Push(request);
+        }, priority);
+
+    return request;
+}
+
+AssetRef AssetLoader::WaitRequest(const AssetRequestHandle& request)
+{
+    request->WaitLoaded();
+    FinalizeRequest(request);
+
+    return request->GetAsset();
+}
+
+uint32_t AssetLoader::FinalizeRequests(const uint32_t maxCount)
+{
+    //  Higher priority requests get finalized first, others are left for the next frames.
+    const std::vector<AssetRequestHandle> finalizeList = CompletedRequests.Take(maxCount);
+    for (const auto& request : finalizeList)
+        FinalizeRequest(request);
+
+    return (uint32_t)finalizeList.size();
+}
+
+void AssetLoader::FinalizeRequest(const AssetRequestHandle& request)
+{
+    //  Request that was waited on is still in the completed list, it's just skipped when it's turn comes.
+    if (request->IsDone())
+        return;
+
+    if (request->Asset)
+        RegisterAsset(request->Asset);
+
+    request->State = request->Asset ? AssetRequest::READY : AssetRequest::FAILED;
+
+    if (request->Callback)
+        request->Callback(request);
+}
+
+void AssetLoader::ParallelFor(const size_t count, const std::function<void(const size_t)>& job)
+{
+    static std::mutex workersMutex;
+    ThreadPool* workers = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(workersMutex);
+
+        //  Calling thread takes part in the work too, so one thread less is needed.
+        if (!Workers)
+        {
+            const uint32_t threadsCount = Settings::GetValue<uint32_t>("loader_threads", std::max(std::thread::hardware_concurrency(), 1u));
+            Workers = std::make_unique<ThreadPool>(threadsCount > 1 ? threadsCount - 1 : 0);
         }
 
-        Assets.push_back(asset);
+        workers = Workers.get();
+    }
+
+    workers->ParallelFor(count, job);
+}
+
+bool AssetLoader::MountArchive(const std::string& archivePath)
+{
+    if (!Archive.Open(archivePath))
+        return false;
 
-        if (instance.GetAssetType() == eAssetType::SCENE)
-            SceneAsset::ScenesList.push_back((SceneAsset*)asset);
+    Logger::TRACE(TAG_FUNCTION_NAME, "Assets will be read from \"{}\".", archivePath);
 
-        instance.CloseAsset();
+    return true;
+}
 
-        filesRead++;
+bool AssetLoader::WatchAssets()
+{
+    //  Files inside the archive never change.
+    if (Archive.IsOpen())
+    {
+        Logger::WARNING(TAG_FUNCTION_NAME, "Assets are read from an archive, they can't be reloaded.");
+        return false;
     }
 
-    Logger::TRACE(TAG_FUNCTION_NAME, "Reading DATA done. Read {} lines, found {} file references.", linesRead, filesRead);
+    Watcher = std::make_unique<FileWatcher>();
+    if (!Watcher->Open(AssetBaseDir))
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Can't watch \"{}\" for changes!", AssetBaseDir);
+        Watcher.reset();
+        return false;
+    }
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Watching \"{}\" for changes.", AssetBaseDir);
 
     return true;
 }
 
+uint32_t AssetLoader::ReloadChangedAssets()
+{
+    if (!Watcher)
+        return 0;
+
+    std::unordered_set<std::string> changedFiles;
+    Watcher->Poll(changedFiles);
+
+    uint32_t assetsReloaded = 0;
+    for (const auto& relativePath : changedFiles)
+    {
+        if (ReloadAsset(relativePath))
+            assetsReloaded++;
+    }
+
+    return assetsReloaded;
+}
+
+bool AssetLoader::ReloadAsset(const std::string& relativePath)
+{
+    AssetLoader loader;
+    if (!loader.ResolveFilePath(relativePath))
+        return false;
+
+    //  An asset that is not resident will be read from the new file anyway, next time somebody needs it.
+    const AssetRef previousAsset = AssetCache::Find(loader.GetFilePathHash());
+    if (!previousAsset)
+        return false;
+
+    const eAssetType assetType = loader.GetAssetType();
+    if (assetType != eAssetType::TEXT && assetType != eAssetType::SCRIPT && assetType != eAssetType::SCENE)
+    {
+        Logger::WARNING(TAG_FUNCTION_NAME, "\"{}\" has changed, but this type of asset can't be reloaded.", relativePath);
+        return false;
+    }
+
+    //  The previous instance is kept if new one can't be loaded, i.e. when file was saved with a script error.
+    AssetInterface* reloadedAsset = CreateAsset(loader);
+    if (!reloadedAsset)
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Can't reload \"{}\", previous version is kept.", relativePath);
+        return false;
+    }
+
+    const AssetRef asset = AssetCache::Replace(loader.GetFilePathHash(), reloadedAsset);
+
+    //  Handles to the asset stay the same, only what they refer to is changed.
+    Assets.Replace(asset);
+
+    //  Scenes hold their own references to the assets they use, those are patched so previous instance can be freed.
+    //  Evicted scenes are skipped, not reloaded, they get the new asset when read again. Patching doesn't count as using a scene either.
+    uint32_t referencesPatched = 0;
+    for (const auto& sceneHandle : SceneAsset::ScenesList)
+    {
+        if (SceneAsset* scene = Assets.GetResident(sceneHandle))
+            referencesPatched += scene->PatchAssetReference(previousAsset, asset);
+    }
+
+    //  Running scripts hold their own references too, and have to switch to the new program. So do language tables.
+    if (assetType == eAssetType::SCRIPT)
+        Scripting::Runtime::OnScriptReloaded(previousAsset, asset);
+    else if (assetType == eAssetType::TEXT)
+        Localization::OnTextReloaded(previousAsset, asset);
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Reloaded \"{}\", patched {} references.", relativePath, referencesPatched);
+
+    return true;
+}
+
+AssetRef AssetLoader::ReloadEvictedAsset(const std::string& filePath)
+{
+    AssetLoader loader;
+    if (!filePath.starts_with(AssetBaseDir) || !loader.ResolveFilePath(filePath.substr(AssetBaseDir.length())))
+        return nullptr;
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Loading evicted \"{}\" again.", filePath);
+
+    return AssetCache::Acquire(loader.GetFilePathHash(), [&loader]() { return CreateAsset(loader); });
+}
+
+void AssetLoader::ReadMemoryBudgets()
+{
+    MemoryBudgets.clear();
+    StalledEvictions.clear();
+
+    //  Setting name is made out of asset type folder, i.e. 'gfx/' is 'gfx_budget_mb'.
+    for (const auto& [assetType, pathPrefix] : AssetPathPrefix)
+    {
+        const std::string settingName = pathPrefix.substr(0, pathPrefix.length() - 1) + "_budget_mb";
+        const uint32_t budgetMegabytes = Settings::GetValue<uint32_t>(settingName, 0);
+        if (!budgetMegabytes)
+            continue;
+
+        MemoryBudgets[assetType] = (size_t)budgetMegabytes * 1024 * 1024;
+        Logger::TRACE(TAG_FUNCTION_NAME, "Memory budget for \"{}\" is {} MB.", pathPrefix, budgetMegabytes);
+    }
+}
+
+void AssetLoader::EnforceMemoryBudgets()
+{
+    //  Scenes are only held by the table, but the active one is handed out as a raw pointer every frame and loading ones are still being filled in.
+    const SceneAsset* activeScene = SceneAsset::ActiveScene.empty() ? nullptr : Assets.GetResident(FindScene(SceneAsset::ActiveScene));
+    const auto IsPinned = [activeScene](AssetInterface& asset)
+        {
+            const SceneAsset* scene = asset.As<SceneAsset>();
+            return scene && (scene == activeScene || scene->IsLoading());
+        };
+
+    for (const auto& [assetType, budgetBytes] : MemoryBudgets)
+    {
+        const size_t residentBytes = AssetCache::GetResidentBytes(assetType);
+        if (residentBytes <= budgetBytes)
+            continue;
+
+        //  Whatever is over budget is held by somebody, scanning again every frame won't change that.
+        const auto stalledEviction = StalledEvictions.find(assetType);
+        if (stalledEviction != StalledEvictions.end() && stalledEviction->second == residentBytes)
+            continue;
+
+        const size_t bytesFreed = Assets.Evict(assetType, residentBytes - budgetBytes, IsPinned);
+        if (!bytesFreed)
+        {
+            StalledEvictions[assetType] = residentBytes;
+            Logger::WARNING(TAG_FUNCTION_NAME, "\"{}\" assets are {} bytes over budget, but none of them can be evicted.", AssetPathPrefix.at(assetType), residentBytes - budgetBytes);
+            continue;
+        }
+
+        StalledEvictions.erase(assetType);
+        Logger::TRACE(TAG_FUNCTION_NAME, "Evicted {} bytes of \"{}\" assets, {} bytes over budget.", bytesFreed, AssetPathPrefix.at(assetType), residentBytes - budgetBytes);
+    }
+}
+
+std::shared_ptr<const FileMapping> AssetLoader::OpenDataFile(const std::string& dataFilePath)
+{
+    //  Data files are stored in the archive with their path relative to the assets base directory.
+    if (Archive.IsOpen())
+        return Archive.Find(dataFilePath);
+
+    FileErrorType errorCode = 0;
+    return FileMapping::Open(dataFilePath, errorCode);
+}
+
 const FileErrorType AssetLoader::GetError() const
 {
     return FileOpenStatus;
@@ -166,17 +549,25 @@ const eAssetType AssetLoader::GetAssetType() const
 void AssetLoader::SetAssetRef(AssetInterface* assetInterface)
 {
     AssetInterfaceRef = assetInterface;
-    assetInterface->SetData(FilePath);
+    assetInterface->SetData(FilePath, AssetType);
     assetInterface->SetDataSize(FileSize);
+
+    if (assetInterface->RetainsData())
+        assetInterface->SetDataMapping(FileView);
 }
 
 bool AssetLoader::OpenAsset(const std::string& path)
+{
+    return ResolvePath(path) && OpenFile();
+}
+
+bool AssetLoader::ResolvePath(const std::string& path)
 {
     if (path.empty())
         return false;
 
     //  Given path is relative, make it absolute.
-    FilePtr = nullptr;
+    FileView.reset();
 
     //  The asset path is relative to the specified asset type.
     //  Check if it is so first.
@@ -210,21 +601,61 @@ bool AssetLoader::OpenAsset(const std::string& path)
         return false;
     }
 
-    FileOpenStatus = fopen_s(&FilePtr, FilePath.c_str(), "r");
-    if (FileOpenStatus)
+    FilePathHash = xxh64::hash(FilePath.c_str(), FilePath.length(), 0);
+
+    return true;
+}
+
+bool AssetLoader::ResolveFilePath(const std::string& relativePath)
+{
+    FileView.reset();
+
+    for (const auto& [assetType, pathPrefix] : AssetPathPrefix)
     {
-        Logger::ERROR(TAG_FUNCTION_NAME, "Can't open \"{}\".", FilePath);
+        if (!relativePath.starts_with(pathPrefix))
+            continue;
+
+        AssetType = assetType;
+        AssetTypeHash = (HashType)assetType;
+        FileName = relativePath.substr(pathPrefix.length());
+        FilePath = AssetBaseDir + relativePath;
+        FilePathHash = xxh64::hash(FilePath.c_str(), FilePath.length(), 0);
+
+        return true;
+    }
+
+    return false;
+}
+
+bool AssetLoader::OpenFile()
+{
+    if (FilePath.empty())
         return false;
+
+    //  Map the file instead of reading it, parsers will read straight from the page cache.
+    //  When an archive is mounted, the file is just a view into it and no file system access is made at all.
+    if (Archive.IsOpen())
+    {
+        FileView = Archive.Find(std::string_view(FilePath).substr(AssetBaseDir.length()));
+        FileOpenStatus = FileView ? 0 : -1;
+    }
+    else if (Settings::GetValue<bool>("hot_reload", false))
+    {
+        //  Loose files may be edited while game runs, assets retaining their data must not point into a mapping of one.
+        FileView = FileMapping::Read(FilePath, FileOpenStatus);
+    }
+    else
+    {
+        FileView = FileMapping::Open(FilePath, FileOpenStatus);
     }
 
-    //  Allocate buffer large enough.
-    fseek(FilePtr, 0l, SEEK_END);
-    FileSize = ftell(FilePtr);
-    rewind(FilePtr);
+    if (!FileView)
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Can't open \"{}\".", FilePath);
+        return false;
+    }
 
-    FileDataBuffer = new uint8_t[FileSize];
-    memset(FileDataBuffer, 0, FileSize);
-    fread(FileDataBuffer, FileSize, 1, FilePtr);
+    FileSize = FileView->GetSize();
 
     Logger::TRACE(TAG_FUNCTION_NAME, "File: {} ({} bytes) -- OK", FileName, FileSize);
 
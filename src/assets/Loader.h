@@ -1,21 +1,20 @@
 #pragma once
 
 #include "Generic.h"
+
+#include <unordered_set>
 #include "AssetInterface.h"
+#include "AssetArchive.h"
+#include "AssetCache.h"
+#include "AssetHandleTable.h"
+#include "AssetRequest.h"
+#include "DataManifest.h"
+#include "FileMapping.h"
+#include "FileWatcher.h"
+#include "ThreadPool.h"
 #include "Logger.h"
 
-//  When adding a new type of 'asset' don't forget to put it into 'eAssetType' enumeration, but also into 'AssetPathPrefix'.
-//  Also, don't forget to modify the 'switch' statement in AssetInterfaceFactory to account for your new AssetType.
-enum class eAssetType : HashType
-{
-    TEXT = xxh64::hash("text", 4, 0),
-    GFX = xxh64::hash("gfx", 3, 0),
-    SOUND = xxh64::hash("sound", 5, 0),
-    SCRIPT = xxh64::hash("script", 6, 0),
-    SCENE = xxh64::hash("scene", 5, 0),
-    MODEL = xxh64::hash("model", 5, 0)
-};
-
+//  Every asset type has it's own folder inside 'AssetBaseDir'.
 static const std::unordered_map<eAssetType, std::string> AssetPathPrefix =
 {
     { eAssetType::TEXT, "text/" },
@@ -28,31 +27,71 @@ static const std::unordered_map<eAssetType, std::string> AssetPathPrefix =
 
 static const std::string AssetBaseDir = "./assets/";
 
+class SceneAsset;
+
+//  An instance of a loader holds the state of a single opened file, so each thread loading assets uses it's own instance.
 class AssetLoader
 {
 private:
     FileErrorType   FileOpenStatus;
     std::string     FilePath;
     std::string     FileName;
-    FILE           *FilePtr;
-    uint8_t        *FileDataBuffer;
-    long            FileSize;
+    size_t          FileSize;
+
+    std::shared_ptr<const FileMapping>  FileView;
 
     eAssetType      AssetType;
     HashType        AssetTypeHash;
+    HashType        FilePathHash;
     AssetInterface *AssetInterfaceRef;
 
-    AssetLoader();
-    ~AssetLoader();
+    static AssetArchive Archive;
+    static std::unique_ptr<ThreadPool>  Workers;
+    static std::unique_ptr<ThreadPool>  StreamingWorkers;
+
+    //  Requests that background threads are done with, waiting to be finalized on the main thread.
+    static CompletedRequestQueue            CompletedRequests;
+    static std::atomic_bool                 StreamingCancelled;
+
+    //  Only set when hot reload is enabled, see 'WatchAssets'.
+    static std::unique_ptr<FileWatcher>     Watcher;
 
-    static AssetLoader  Instance;
+    //  How many bytes of each asset type may be resident, see 'ReadMemoryBudgets'. Types that are not listed are not limited.
+    static std::unordered_map<eAssetType, size_t>   MemoryBudgets;
+    //  Resident bytes of a type when evicting it last freed nothing. Nothing is tried again until that changes.
+    static std::unordered_map<eAssetType, size_t>   StalledEvictions;
+
+    //  Register the asset and call the callback, once. Must only be called from the main thread.
+    static void FinalizeRequest(const AssetRequestHandle& request);
+
+    //  Open data file either from the mounted archive or from disk.
+    static std::shared_ptr<const FileMapping>   OpenDataFile(const std::string& dataFilePath);
+
+    //  Read data file and all of it's includes, apply engine hints and collect asset references in order they appear.
+    //  Everything found, including what files were read, is put into 'manifest'.
+    static bool CollectDataFile(const std::string& dataFilePath, DataManifest& manifest);
+
+    //  Get data file contents either from the compiled manifest saved by previous run, or by reading the data file.
+    static bool ReadDataFile(const std::string& dataFilePath, DataManifest& manifest);
+
+    //  Open the file 'loader' has resolved, create an asset of matching type and parse it. Returns nullptr on failure.
+    static AssetInterface* CreateAsset(AssetLoader& loader);
+
+    //  Parse the file found at 'relativePath' (relative to 'AssetBaseDir') again and swap it in place of the resident asset.
+    static bool ReloadAsset(const std::string& relativePath);
+
+    //  Load an asset that was evicted from 'Assets' again, given it's full path.
+    static AssetRef ReloadEvictedAsset(const std::string& filePath);
 
 public:
+    AssetLoader();
+    ~AssetLoader();
+
     const FileErrorType GetError() const;
     const eAssetType    GetAssetType() const;
     inline const uint8_t* GetDataBufferPtr() const
     {
-        return FileDataBuffer;
+        return FileView ? FileView->GetData() : nullptr;
     }
 
     void            SetAssetRef(AssetInterface* assetInterface);
@@ -60,28 +99,27 @@ public:
     bool            OpenAsset(const std::string& path);
     bool            CloseAsset();
 
-    static std::vector<AssetInterface*>     Assets;
+    //  First half of 'OpenAsset': figure out asset type and full file path, but don't open anything yet.
+    bool            ResolvePath(const std::string& path);
+    //  Second half of 'OpenAsset': map the file that 'ResolvePath' found.
+    bool            OpenFile();
 
-    static inline void Shutdown()
-    {
-        uint32_t assetsFreed = 0;
-        for (uint32_t i = 0; i < Assets.size(); ++i)
-        {
-            if (Assets[i])
-            {
-                assetsFreed++;
-                delete Assets[i];
-            }
-        }
-
-        Logger::TRACE(TAG_FUNCTION_NAME, "Unloaded {} assets.", assetsFreed);
-    }
+    //  Same as 'ResolvePath', but for a file path relative to 'AssetBaseDir', i.e. 'text/intro.txt'.
+    //  Asset type is figured out from the folder file is in.
+    bool            ResolveFilePath(const std::string& relativePath);
 
-    static inline AssetLoader& GetInstance()
+    //  Hash of the full file path, that's also the 'NameHash' asset will get.
+    inline const HashType GetFilePathHash() const
     {
-        return Instance;
+        return FilePathHash;
     }
 
+    //  Assets referenced from data files, each one is listed once. Assets referenced by scenes are held by their scenes.
+    static AssetHandleTable     Assets;
+
+    //  Drop all registered assets. Anything not referenced from elsewhere is freed right away.
+    static void Shutdown();
+
     //  Given input path with format '<asset type>:<folder>/<filename>.<extension>' this will return parsed parts of it.
     static void ParsePath(
         const std::string_view& path,
@@ -112,5 +150,52 @@ public:
     }
 
     //  Open data file and instantiate all assets that are within.
+    //  Assets are read and parsed on all worker threads, but they are registered in the order they appear in data file.
+    //  Unless 'manifest_cache' setting is off, parsed contents are cached in '<data file>.manifest' and reused until any of the files change.
     static bool ParseDataFile(const std::string dataFilePath);
+
+    //  Get a handle to asset referenced by 'path' ('<asset type>:<folder>/<filename>.<extension>').
+    //  If it's not resident yet, it's opened, created and parsed. Same file referenced by different paths is only loaded once.
+    //  This is safe to call from any thread. The asset returned is not registered anywhere, see 'RegisterAsset'.
+    static AssetRef LoadAsset(const std::string& path);
+
+    //  Add a loaded asset to the 'Assets' table, unless it's already there. Scenes also go into 'ScenesList'.
+    //  Must only be called from the main thread.
+    static AssetHandle<AssetInterface> RegisterAsset(const AssetRef& asset);
+
+    //  Get a handle to registered scene by it's name, i.e. 'menu.scene'. Returns null handle if there's no such scene.
+    static AssetHandle<SceneAsset> FindScene(const std::string& sceneName);
+
+    //  Queue loading of asset referenced by 'path' on a background thread and return right away.
+    //  Requests with higher 'priority' are started first. 'callback' is called on the main thread once request is finalized.
+    static AssetRequestHandle RequestAsset(const std::string& path, const int32_t priority = 0, AssetRequestCallback callback = nullptr);
+
+    //  Block until the request is loaded and finalize it right away. Must only be called from the main thread.
+    static AssetRef WaitRequest(const AssetRequestHandle& request);
+
+    //  Finalize at most 'maxCount' of the requests that finished loading. Call this once a frame from the main thread.
+    //  Returns how many requests were finalized.
+    static uint32_t FinalizeRequests(const uint32_t maxCount);
+
+    //  Run 'job' for every index in [0, count) on the loader worker threads, returns once all of them are done.
+    static void ParallelFor(const size_t count, const std::function<void(const size_t)>& job);
+
+    //  Make all following asset and data file reads go to the packed archive instead of the assets directory.
+    static bool MountArchive(const std::string& archivePath);
+
+    //  Start watching 'AssetBaseDir' for changed files. Not available when an archive is mounted.
+    static bool WatchAssets();
+
+    //  Read '<asset type>_budget_mb' settings, i.e. 'gfx_budget_mb=64'. Zero or missing value means there's no limit.
+    static void ReadMemoryBudgets();
+
+    //  Evict least recently used assets of every type that is over it's budget. Only assets nothing else references are evicted,
+    //  they are loaded again when accessed through their handle. Active scene and scenes that are still loading are never evicted.
+    //  Call this once a frame from the main thread.
+    static void EnforceMemoryBudgets();
+
+    //  Re-parse text, script and scene assets whose files have changed since last call and patch scenes that reference them.
+    //  Call this once a frame from the main thread, it doesn't do anything unless 'WatchAssets' was called.
+    //  Returns how many assets were reloaded.
+    static uint32_t ReloadChangedAssets();
 };
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "Localization.h"
+#include "Loader.h"
+#include "Settings.h"
+#include "Logger.h"
+
+std::vector<Localization::tLanguage> Localization::Languages;
+size_t Localization::ActiveLanguage = 0;
+
+const TextAsset* Localization::GetTable(const size_t languageIndex)
+{
+    return languageIndex < Languages.size() && Languages[languageIndex].Table ? Languages[languageIndex].Table->As<TextAsset>() : nullptr;
+}
+
+bool Localization::Init()
+{
+    const std::string languagesList = Settings::GetValue<std::string>("languages", "");
+    const std::string extension = Settings::GetValue<std::string>("language_extension", "txt");
+
+    //  No languages listed is fine, game just doesn't use localized text.
+    if (languagesList.empty())
+        return true;
+
+    for (size_t codeStart = 0; codeStart <= languagesList.length();)
+    {
+        size_t codeEnd = languagesList.find_first_of(',', codeStart);
+        if (codeEnd == std::string::npos)
+            codeEnd = languagesList.length();
+
+        const std::string code = languagesList.substr(codeStart, codeEnd - codeStart);
+        codeStart = codeEnd + 1;
+
+        if (code.empty())
+            continue;
+
+        const AssetRef table = AssetLoader::LoadAsset("text:lang/" + code + "." + extension);
+        if (!table || !table->As<TextAsset>())
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Can't load text table for language \"{}\"!", code);
+            return false;
+        }
+
+        Logger::TRACE(TAG_FUNCTION_NAME, "Language \"{}\": {} values.", code, table->As<TextAsset>()->GetValuesCount());
+        Languages.push_back({ code, table });
+    }
+
+    if (Languages.empty())
+        return true;
+
+    const std::string language = Settings::GetValue<std::string>("language", Languages.front().Code);
+    if (!SetLanguage(language))
+    {
+        Logger::WARNING(TAG_FUNCTION_NAME, "Language \"{}\" is not available, using \"{}\".", language, Languages.front().Code);
+        ActiveLanguage = 0;
+    }
+
+    return true;
+}
+
+void Localization::Shutdown()
+{
+    Languages.clear();
+    ActiveLanguage = 0;
+}
+
+bool Localization::SetLanguage(const std::string_view& code)
+{
+    for (size_t languageIndex = 0; languageIndex < Languages.size(); languageIndex++)
+    {
+        if (Languages[languageIndex].Code == code)
+        {
+            ActiveLanguage = languageIndex;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Localization::GetText(const HashType keyHash, std::string_view& value)
+{
+    const TextAsset* activeTable = GetTable(ActiveLanguage);
+    if (activeTable && activeTable->GetKeyValue(keyHash, value))
+        return true;
+
+    const TextAsset* fallbackTable = ActiveLanguage ? GetTable(0) : nullptr;
+    return fallbackTable && fallbackTable->GetKeyValue(keyHash, value);
+}
+
+void Localization::OnTextReloaded(const AssetRef& previousTable, const AssetRef& table)
+{
+    for (auto& language : Languages)
+    {
+        if (language.Table == previousTable)
+            language.Table = table;
+    }
+}
+
+bool Localization::GetText(const TextKey key, std::string_view& value)
+{
+    return GetText(key.Hash, value);
+}
+
+bool Localization::GetText(const std::string_view& key, std::string_view& value)
+{
+    return GetText(xxh64::hash(key.data(), key.length(), 0), value);
+}
@@ -0,0 +1,46 @@
+/*
+* File: Localization.h
+* Purpose: keeps text tables of every shipped language resident and answers text lookups in the active one.
+*/
+#pragma once
+
+#include "Generic.h"
+#include "TextAsset.h"
+
+class Localization
+{
+private:
+    struct tLanguage
+    {
+        std::string Code;
+        AssetRef    Table;
+    };
+
+    //  Fallback language is always the first one.
+    static std::vector<tLanguage>   Languages;
+    static size_t                   ActiveLanguage;
+
+    static const TextAsset* GetTable(const size_t languageIndex);
+
+public:
+    //  Load a table for each of the 'languages' setting (i.e. 'en,de,fr') from 'text:lang/<code>.<language_extension>' and make 'language' setting active one.
+    //  Tables are expected to be cooked, so loading them is just mapping the files.
+    static bool Init();
+    static void Shutdown();
+
+    //  Switching is just choosing another resident table, nothing is loaded or parsed.
+    static bool SetLanguage(const std::string_view& code);
+
+    static inline const std::string_view GetLanguage()
+    {
+        return ActiveLanguage < Languages.size() ? std::string_view(Languages[ActiveLanguage].Code) : std::string_view();
+    }
+
+    //  Value of the key in active language, or in fallback language if active one is missing it.
+    static bool GetText(const HashType keyHash, std::string_view& value);
+    static bool GetText(const TextKey key, std::string_view& value);
+    static bool GetText(const std::string_view& key, std::string_view& value);
+
+    //  Languages using 'previousTable' switch over to 'table', so the edited file is what's served from now on.
+    static void OnTextReloaded(const AssetRef& previousTable, const AssetRef& table);
+};
@@ -4,6 +4,8 @@
 class ModelAsset : public AssetInterface
 {
 public:
+    static constexpr eAssetType ClassAssetType = eAssetType::MODEL;
+
     ModelAsset() = default;
 
     virtual         ~ModelAsset() override = default;
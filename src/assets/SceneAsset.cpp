@@ -2,19 +2,17 @@
 #include "AssetInterfaceFactory.h"
 #include "Logger.h"
 #include "Settings.h"
-#include <fstream>
 
-std::vector<SceneAsset*> SceneAsset::ScenesList = {};
+std::vector<AssetHandle<SceneAsset>> SceneAsset::ScenesList = {};
 std::string SceneAsset::ActiveScene = {};
-
-const Json::Value& SceneAsset::GetSectionValue(const std::string& sectionName) const
-{
-        return !RootValue ? RootValue : RootValue[sectionName];
-}
+uint32_t SceneAsset::LoadBudgetMs = 0;
+std::unordered_map<std::string, AssetRequestHandle> SceneAsset::PrefetchRequests = {};
+thread_local std::vector<HashType> SceneAsset::ExpansionStack = {};
 
 SceneAsset::SceneAsset()
 {
     EntitiesIncluded = 0;
+    PendingPosition = 0;
 }
 
 SceneAsset::~SceneAsset()
@@ -23,20 +21,32 @@ SceneAsset::~SceneAsset()
 
 void SceneAsset::ParseData(const uint8_t* data)
 {
-    //  Parse actual contents of the buffer into JSON object.
-    Json::String errorString;
-    Json::Reader reader;
+    std::vector<EntityReferenceData> entities;
+    std::vector<ScriptReferenceData> scripts;
 
-    if (!reader.parse((const char*)data, (const char*)data + DataSize, RootValue))
+    if (SceneFormat::IsCooked(data, DataSize))
     {
-        Logger::ERROR(TAG_FUNCTION_NAME, "Failed to parse '{}'!", Name);
-        Logger::ERROR(TAG_FUNCTION_NAME, "Errors: {}", reader.getFormattedErrorMessages());
+        if (!ParseCooked(data, entities, scripts))
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Cooked scene '{}' is damaged!", Name);
+            return;
+        }
+    }
+    else
+    {
+        //  Everything is copied out of the text, so there's no reason to hold on to it.
+        DataMapping.reset();
 
-        return;
+        size_t errorLine = 0;
+        if (!SceneFormat::ReadText((const char*)data, data ? DataSize : 0, SceneArena, entities, scripts, errorLine))
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Failed to parse '{}', error at line {}!", Name, errorLine);
+            return;
+        }
     }
 
     //  Update entities included value to reflect how many entities there are in scene.
-    EntitiesIncluded = RootValue["entries"].size();
+    EntitiesIncluded = (uint32_t)(entities.size() + scripts.size());
 
     if (!EntitiesIncluded)
     {
@@ -44,76 +54,421 @@ void SceneAsset::ParseData(const uint8_t* data)
         return;
     }
 
-    //  Go through all the entities this scene includes and load them.
-    for (uint32_t index = 0; index < EntitiesIncluded; index++)
+    //  Scripts are needed as soon as scene is started, so they are always loaded right away. So are prefab templates, instances are made from them.
+    LoadScripts(scripts);
+    ExpandPrefabs(entities);
+    PrepareEntities(entities);
+
+    //  With a load budget, entities are loaded by 'ContinueLoadingScenes' a slice every frame instead.
+    if (!LoadBudgetMs)
+        ContinueLoading(std::chrono::steady_clock::time_point::max(), PendingEntities.size());
+}
+
+bool SceneAsset::RetainsData() const
+{
+    return true;
+}
+
+bool SceneAsset::ParseCooked(const uint8_t* data, std::vector<EntityReferenceData>& entities, std::vector<ScriptReferenceData>& scripts)
+{
+    const SceneBinHeader* header = (const SceneBinHeader*)data;
+    if (!SceneFormat::IsValid(*header, DataSize))
+        return false;
+
+    const SceneBinEntity* cookedEntities = (const SceneBinEntity*)(data + header->EntitiesOffset);
+    const SceneBinScript* cookedScripts = (const SceneBinScript*)(data + header->ScriptsOffset);
+    const SceneBinOverride* cookedOverrides = (const SceneBinOverride*)(data + header->OverridesOffset);
+    const SceneBinString* references = (const SceneBinString*)(data + header->ReferencesOffset);
+    const char* strings = (const char*)data + header->StringsOffset;
+
+    const auto GetString = [strings, header](const SceneBinString& string)
+        {
+            if (string.Offset > header->StringsSize || string.Length > header->StringsSize - string.Offset)
+                return std::string_view();
+
+            return std::string_view(strings + string.Offset, string.Length);
+        };
+
+    const auto GetReference = [references, header, &GetString](const uint32_t reference)
+        {
+            return reference < header->ReferencesCount ? GetString(references[reference]) : std::string_view();
+        };
+
+    //  Overrides are turned into records all at once, every instance takes it's share in order.
+    const auto overrides = SceneArena.NewArray<EntityOverrideData>(header->OverridesCount);
+    for (uint32_t index = 0; index < header->OverridesCount; index++)
+    {
+        const SceneBinOverride& cookedOverride = cookedOverrides[index];
+        overrides[index] = {
+            GetString(cookedOverride.Target),
+            cookedOverride.Fields,
+            { cookedOverride.Position[0], cookedOverride.Position[1], cookedOverride.Position[2] },
+            cookedOverride.Width,
+            cookedOverride.Height,
+            (cookedOverride.Fields & EntityOverrideData::SOURCE) ? GetReference(cookedOverride.Reference) : std::string_view()
+        };
+    }
+
+    size_t overridesPosition = 0;
+    entities.reserve(header->EntitiesCount);
+    for (uint32_t index = 0; index < header->EntitiesCount; index++)
+    {
+        const SceneBinEntity& cookedEntity = cookedEntities[index];
+        if (cookedEntity.OverridesCount > overrides.size() - overridesPosition)
+            return false;
+
+        entities.push_back({
+            cookedEntity.Id,
+            GetString(cookedEntity.Name),
+            (eAssetType)cookedEntity.Type,
+            { cookedEntity.Position[0], cookedEntity.Position[1], cookedEntity.Position[2] },
+            cookedEntity.Width,
+            cookedEntity.Height,
+            cookedEntity.Order,
+            GetReference(cookedEntity.Reference),
+            cookedEntity.ParentId,
+            std::span<const EntityOverrideData>(overrides).subspan(overridesPosition, cookedEntity.OverridesCount),
+            nullptr
+        });
+
+        overridesPosition += cookedEntity.OverridesCount;
+    }
+
+    scripts.reserve(header->ScriptsCount);
+    for (uint32_t index = 0; index < header->ScriptsCount; index++)
     {
-        const Json::Value& currentValue = RootValue["entries"][index];
-        const auto assetType = (eAssetType)currentValue["type"].asUInt64();
+        const SceneBinScript& cookedScript = cookedScripts[index];
+        scripts.push_back({ cookedScript.Id, GetString(cookedScript.Name), GetReference(cookedScript.Reference), nullptr });
+    }
+
+    return true;
+}
+
+void SceneAsset::LoadScripts(const std::vector<ScriptReferenceData>& scripts)
+{
+    std::vector<AssetRef> scriptAssets(scripts.size(), nullptr);
+    AssetLoader::ParallelFor(scripts.size(), [&](const size_t index) { scriptAssets[index] = AssetLoader::LoadAsset(std::string(scripts[index].SourceAsset)); });
 
-        AssetLoader& loader = AssetLoader::GetInstance();
-        if (!loader.OpenAsset(currentValue["source"].asCString()))
+    //  Scripts that failed to load are left out.
+    Scripts = SceneArena.NewArray<ScriptReferenceData>(scripts.size());
+    size_t scriptsCount = 0;
+    for (size_t index = 0; index < scripts.size(); index++)
+    {
+        if (!scriptAssets[index])
             continue;
 
-        //  Process asset data and add it to the list.
-        AssetInterface* asset = AssetInterfaceFactory::Create(loader.GetAssetType());
-        loader.SetAssetRef(asset);
+        ScriptReferenceData& scriptEntity = Scripts[scriptsCount++];
+        scriptEntity = scripts[index];
+        scriptEntity.Asset = scriptAssets[index].get();
+        ReferencedAssets.push_back(scriptAssets[index]);
+
+        Logger::TRACE(TAG_FUNCTION_NAME, "Script: {}", scriptEntity.SourceAsset);
+    }
+
+    Scripts = Scripts.first(scriptsCount);
+}
+
+void SceneAsset::ExpandPrefabs(std::vector<EntityReferenceData>& entities)
+{
+    //  Every template is loaded once, no matter how many instances there are.
+    std::vector<std::string_view> templatePaths;
+    std::unordered_map<std::string_view, size_t> templateIndices;
+    for (const auto& entity : entities)
+    {
+        if (entity.Type == eAssetType::SCENE && templateIndices.emplace(entity.SourceAsset, templatePaths.size()).second)
+            templatePaths.push_back(entity.SourceAsset);
+    }
 
-        //  Don't load script asset if scripts are disabled.
-        if (assetType == eAssetType::SCRIPT && Settings::GetValue<bool>("scripts", true) == false)
+    if (templatePaths.empty())
+        return;
+
+    //  Templates are parsed by whichever thread loads them, each one gets the stack of scenes it's nested in.
+    std::vector<HashType> expansionStack = ExpansionStack;
+    expansionStack.push_back(NameHash);
+
+    std::vector<AssetRef> templates(templatePaths.size(), nullptr);
+    AssetLoader::ParallelFor(templatePaths.size(), [&](const size_t index)
         {
-            loader.CloseAsset();
-            continue;
-        }
+            //  Scene that is a template of itself, directly or through other templates, would wait for itself to load forever.
+            const std::string templatePath(templatePaths[index]);
+            AssetLoader loader;
+            if (!loader.ResolvePath(templatePath))
+                return;
+
+            if (std::find(expansionStack.begin(), expansionStack.end(), loader.GetFilePathHash()) != expansionStack.end())
+            {
+                Logger::ERROR(TAG_FUNCTION_NAME, "Prefab \"{}\" is used by itself!", templatePath);
+                return;
+            }
+
+            const std::vector<HashType> previousStack = ExpansionStack;
+            ExpansionStack = expansionStack;
+            AssetRef templateAsset = AssetLoader::LoadAsset(templatePath);
+            ExpansionStack = previousStack;
 
-        asset->ParseData(loader.GetDataBufferPtr());
+            if (!templateAsset || !templateAsset->As<SceneAsset>())
+                return;
 
-        //  Don't add this script asset if there was an error when parsing script.
-        if (assetType == eAssetType::SCRIPT && asset->CastTo<ScriptAsset>().GetErrorsFound())
+            //  Instances share all of the template entities, so template can't be left half loaded.
+            templateAsset->CastTo<SceneAsset>().ContinueLoading(std::chrono::steady_clock::time_point::max(), LoadBatchSize);
+            templates[index] = std::move(templateAsset);
+        });
+
+    //  Instance itself doesn't load anything, it refers to the template. Template holds the assets of it's own entities.
+    std::erase_if(entities, [&](EntityReferenceData& entity)
         {
-            loader.CloseAsset();
+            if (entity.Type != eAssetType::SCENE)
+                return false;
+
+            const AssetRef& templateAsset = templates[templateIndices[entity.SourceAsset]];
+            if (!templateAsset)
+            {
+                Logger::ERROR(TAG_FUNCTION_NAME, "Can't load prefab \"{}\" for entity \"{}\"!", entity.SourceAsset, entity.Name);
+                return true;
+            }
+
+            entity.Asset = templateAsset.get();
+            return false;
+        });
+
+    for (auto& templateAsset : templates)
+    {
+        if (templateAsset)
+            ReferencedAssets.push_back(std::move(templateAsset));
+    }
+}
+
+void SceneAsset::PrepareEntities(std::vector<EntityReferenceData>& entities)
+{
+    //  Entities with the same order keep the order they were listed in. Cooked scenes are sorted already.
+    const auto IsOrderedBefore = [](const EntityReferenceData& a, const EntityReferenceData& b) { return a.Order < b.Order; };
+    if (!std::is_sorted(entities.begin(), entities.end(), IsOrderedBefore))
+        std::stable_sort(entities.begin(), entities.end(), IsOrderedBefore);
+
+    //  Arrays are made big enough for all of them, but they only become visible as their assets are loaded.
+    Graph.Allocate(SceneArena, entities.size(), Name);
+
+    //  Overrides of every prefab instance get a table the graph keeps, assets overriding template ones are loaded along with the instance.
+    PendingOverrides.assign(entities.size(), {});
+    for (size_t index = 0; index < entities.size(); index++)
+    {
+        const auto& entityOverrides = entities[index].Overrides;
+        if (entities[index].Type != eAssetType::SCENE || entityOverrides.empty())
             continue;
+
+        const auto overrides = SceneArena.NewArray<PrefabMemberOverride>(entityOverrides.size());
+        for (size_t overrideIndex = 0; overrideIndex < entityOverrides.size(); overrideIndex++)
+            overrides[overrideIndex] = { entityOverrides[overrideIndex], InvalidEntityIndex, nullptr };
+
+        PendingOverrides[index] = overrides;
+    }
+
+    PendingEntities = std::move(entities);
+    PendingPosition = 0;
+}
+
+bool SceneAsset::ContinueLoading(const std::chrono::steady_clock::time_point deadline, const size_t batchSize)
+{
+    std::lock_guard<std::mutex> lock(LoadingMutex);
+    if (!IsLoading())
+        return true;
+
+    //  Referenced assets don't depend on each other, so each batch is read and parsed in parallel.
+    std::vector<AssetRef> batchAssets;
+    std::vector<std::vector<AssetRef>> batchOverrideAssets;
+    while (PendingPosition < PendingEntities.size())
+    {
+        const size_t batchCount = std::min(std::max<size_t>(batchSize, 1), PendingEntities.size() - PendingPosition);
+        batchAssets.assign(batchCount, nullptr);
+        batchOverrideAssets.assign(batchCount, {});
+        AssetLoader::ParallelFor(batchCount, [&](const size_t index)
+            {
+                const EntityReferenceData& entity = PendingEntities[PendingPosition + index];
+                if (!entity.Asset)
+                    batchAssets[index] = AssetLoader::LoadAsset(std::string(entity.SourceAsset));
+
+                for (const auto& memberOverride : PendingOverrides[PendingPosition + index])
+                {
+                    if (memberOverride.Data.Fields & EntityOverrideData::SOURCE)
+                        batchOverrideAssets[index].push_back(AssetLoader::LoadAsset(std::string(memberOverride.Data.SourceAsset)));
+                }
+            });
+
+        //  Entities with assets that failed to load are left out. Prefab instances come with their template already.
+        for (size_t index = 0; index < batchCount; index++)
+        {
+            EntityReferenceData& entity = PendingEntities[PendingPosition + index];
+            if (!entity.Asset)
+            {
+                if (!batchAssets[index])
+                    continue;
+
+                entity.Asset = batchAssets[index].get();
+                ReferencedAssets.push_back(std::move(batchAssets[index]));
+            }
+
+            //  Template entity keeps it's own asset if the one overriding it failed to load.
+            const auto overrides = PendingOverrides[PendingPosition + index];
+            size_t overrideAssetIndex = 0;
+            for (auto& memberOverride : overrides)
+            {
+                if (!(memberOverride.Data.Fields & EntityOverrideData::SOURCE))
+                    continue;
+
+                AssetRef& overrideAsset = batchOverrideAssets[index][overrideAssetIndex++];
+                if (!overrideAsset)
+                {
+                    Logger::ERROR(TAG_FUNCTION_NAME, "Can't load \"{}\" that \"{}\" overrides \"{}\" with!", memberOverride.Data.SourceAsset, entity.Name, memberOverride.Data.Target);
+                    memberOverride.Data.Fields &= ~EntityOverrideData::SOURCE;
+                    continue;
+                }
+
+                memberOverride.Asset = overrideAsset.get();
+                ReferencedAssets.push_back(std::move(overrideAsset));
+            }
+
+            const SceneAsset* prefab = entity.Type == eAssetType::SCENE ? entity.Asset->As<SceneAsset>() : nullptr;
+            Graph.AddEntity(entity, prefab ? &prefab->Graph : nullptr, overrides);
         }
 
-        AssetLoader::Assets.push_back(asset);
+        PendingPosition += batchCount;
+
+        if (std::chrono::steady_clock::now() >= deadline)
+            break;
+    }
+
+    if (PendingPosition < PendingEntities.size())
+        return false;
+
+    PendingEntities = {};
+    PendingOverrides = {};
+    PendingPosition = 0;
+    Graph.Build(SceneArena);
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Scene \"{}\" takes {} bytes of arena.", Name, SceneArena.GetBytesAllocated());
+
+    return true;
+}
+
+void SceneAsset::ContinueLoadingScenes()
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(LoadBudgetMs);
+
+    //  Active scene goes first, so what's on screen fills in before anything else. Evicted scenes are not brought back just to be loaded.
+    SceneAsset* activeScene = ActiveScene.empty() ? nullptr : AssetLoader::Assets.GetResident(AssetLoader::FindScene(ActiveScene));
+    if (activeScene && !activeScene->ContinueLoading(deadline, LoadBatchSize))
+        return;
+
+    for (const auto& sceneHandle : ScenesList)
+    {
+        SceneAsset* scene = AssetLoader::Assets.GetResident(sceneHandle);
+        if (scene && !scene->ContinueLoading(deadline, LoadBatchSize))
+            return;
+    }
+}
+
+void SceneAsset::Prefetch(const std::string& sceneName)
+{
+    if (PrefetchRequests.contains(sceneName) || AssetLoader::Assets.GetResident(AssetLoader::FindScene(sceneName)))
+        return;
+
+    PrefetchRequests.emplace(sceneName, AssetLoader::RequestAsset("scene:" + sceneName, PrefetchPriority, nullptr));
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Prefetching scene \"{}\".", sceneName);
+}
+
+bool SceneAsset::SetActive(const std::string& sceneName)
+{
+    //  Waiting for a request registers the scene, if it's loaded by now that's all that happens.
+    const auto prefetchRequest = PrefetchRequests.find(sceneName);
+    if (prefetchRequest != PrefetchRequests.end())
+    {
+        AssetLoader::WaitRequest(prefetchRequest->second);
+        PrefetchRequests.erase(prefetchRequest);
+    }
 
-        //  Scripts go into their own list.
-        if (assetType == eAssetType::SCRIPT)
+    if (AssetLoader::FindScene(sceneName).IsNull())
+    {
+        Logger::WARNING(TAG_FUNCTION_NAME, "Scene \"{}\" was not prefetched, loading it now.", sceneName);
+
+        const AssetRef scene = AssetLoader::LoadAsset("scene:" + sceneName);
+        if (!scene || !scene->As<SceneAsset>())
         {
-            const std::string_view sourceName = currentValue["source"].asCString();
-            const size_t scriptNameOffset = sourceName.find_last_of("/") + 1;
+            Logger::ERROR(TAG_FUNCTION_NAME, "Can't load scene \"{}\"!", sceneName);
+            return false;
+        }
+
+        AssetLoader::RegisterAsset(scene);
+    }
+
+    ActiveScene = sceneName;
+    Logger::TRACE(TAG_FUNCTION_NAME, "Set \"Active Scene\" to \"{}\".", ActiveScene);
 
-            ScriptReferenceData tempScriptEntity = {
-                currentValue["id"].asUInt64(),
-                sourceName.substr(scriptNameOffset, sourceName.size() - scriptNameOffset).data(),
-                sourceName.data(),
-                asset
-            };
+    return true;
+}
 
-            Scripts.push_back(tempScriptEntity);
+float_t SceneAsset::GetLoadProgress() const
+{
+    return IsLoading() ? (float_t)PendingPosition / PendingEntities.size() : 1.f;
+}
 
-            Logger::TRACE(TAG_FUNCTION_NAME, "Script: {}", tempScriptEntity.SourceAsset);
+SceneAsset* SceneAsset::GetActive()
+{
+    return ActiveScene.empty() ? nullptr : AssetLoader::Assets.Get(AssetLoader::FindScene(ActiveScene));
+}
+
+uint32_t SceneAsset::PatchAssetReference(const AssetRef& previousAsset, const AssetRef& asset)
+{
+    //  Scene may be loading on another thread, if it's a prefab template.
+    std::lock_guard<std::mutex> lock(LoadingMutex);
+    uint32_t referencesPatched = 0;
 
+    for (auto& referencedAsset : ReferencedAssets)
+    {
+        if (referencedAsset == previousAsset)
+            referencedAsset = asset;
+    }
+
+    //  Templates hold the assets of their own entities, instances of this scene see them through the template.
+    const SceneEntities& entities = Graph.GetEntities();
+    for (size_t index = 0; index < entities.Count; index++)
+    {
+        SceneAsset* prefab = entities.Types[index] == eAssetType::SCENE ? entities.Assets[index]->As<SceneAsset>() : nullptr;
+        if (prefab && prefab != previousAsset.get())
+            referencesPatched += prefab->PatchAssetReference(previousAsset, asset);
+    }
+
+    //  Reloaded template must be whole before instances are pointed to it.
+    if (const SceneAsset* previousPrefab = previousAsset->As<SceneAsset>())
+    {
+        SceneAsset& prefab = asset->CastTo<SceneAsset>();
+        prefab.ContinueLoading(std::chrono::steady_clock::time_point::max(), LoadBatchSize);
+        referencesPatched += Graph.PatchTemplate(&previousPrefab->Graph, &prefab.Graph);
+    }
+
+    referencesPatched += Graph.PatchAsset(previousAsset.get(), asset.get());
+
+    for (auto& script : Scripts)
+    {
+        if (script.Asset != previousAsset.get())
             continue;
-        }
 
-        //  The rest goes into the Entities list.
-        EntityReferenceData tempRefEntity = {
-            currentValue["id"].asUInt64(),
-            currentValue["name"].asCString(),
-            assetType,
-            { currentValue["position"][0].asFloat(), currentValue["position"][1].asFloat(), currentValue["position"][2].asFloat() },
-            currentValue["width"].asUInt(),
-            currentValue["height"].asUInt(),
-            currentValue["order"].asUInt(),
-            currentValue["source"].asCString(),
-            currentValue["parent"].asUInt(),
-            asset
-        };
+        script.Asset = asset.get();
+        referencesPatched++;
+    }
 
-        Entities.push_back(tempRefEntity);
+    //  Entities still waiting to be added may have their assets already, i.e. prefab members. Those are copied into 'Entities' once loaded.
+    for (size_t position = PendingPosition; position < PendingEntities.size(); position++)
+    {
+        if (PendingEntities[position].Asset != previousAsset.get())
+            continue;
 
-        Logger::TRACE(TAG_FUNCTION_NAME, "Entity: {}", tempRefEntity.Name);
+        PendingEntities[position].Asset = asset.get();
+        referencesPatched++;
     }
 
-    ScenesList.push_back(this);
+    //  Templates used directly or through other templates may have a different number of entities now.
+    Graph.UpdateMemberHandles();
+
+    return referencesPatched;
 }
\ No newline at end of file
@@ -2,7 +2,10 @@
 
 #include "Loader.h"
 #include "AssetInterface.h"
-#include "Types.h"
+#include "SceneGraph.h"
+
+#include <chrono>
+#include <mutex>
 
 //	text = 0x80a69b9688ccaf52 9270267953831259986
 //	gfx = 0x28a480fa8bad468a 2928607471271233162
@@ -11,55 +14,147 @@
 //	scene = 0x34ebd9f0e7011c68 3813381138190244968
 //  moidel = 
 
-struct EntityReferenceData
-{
-    uint64_t    Id;
-    std::string Name;
-    eAssetType  Type;
-    vec3f       Position;
-    uint32_t    Width;
-    uint32_t    Height;
-    uint32_t    Order;
-    std::string SourceAsset;
-    uint64_t    ParentId;
-
-    AssetInterface* Asset;
-};
-
-struct ScriptReferenceData
-{
-    uint64_t    Id;
-    std::string Name;
-    std::string SourceAsset;
-
-    AssetInterface* Asset;
-};
-
 class SceneAsset : public AssetInterface
 {
 private:
-    Json::Value     RootValue;
     uint32_t        EntitiesIncluded;
-    std::vector<EntityReferenceData>    Entities;
-    std::vector<ScriptReferenceData>    Scripts;
 
-    const Json::Value& GetSectionValue(const std::string& sectionName) const;
+    //  Owns everything scene makes while parsing.
+    Arena                               SceneArena;
+    SceneGraph                          Graph;
+    std::span<ScriptReferenceData>      Scripts;
+    //  Every asset entities and scripts refer to, held here so they stay resident while scene is.
+    std::vector<AssetRef>               ReferencedAssets;
+
+    //  Entities waiting for their assets to be loaded, in 'Order'. Everything before 'PendingPosition' is done.
+    std::vector<EntityReferenceData>    PendingEntities;
+    //  Overrides of pending prefab instances, same order as 'PendingEntities'. Tables live in the arena, the graph keeps them once instance is added.
+    std::vector<std::span<PrefabMemberOverride>>    PendingOverrides;
+    size_t                              PendingPosition;
+    //  Scene used as a prefab template by a few scenes loading at once is finished by whichever gets to it first.
+    std::mutex                          LoadingMutex;
+
+    //  Cooked scene is used as is, records only have their strings fixed up. Scene keeps the mapping, strings point right into it.
+    bool            ParseCooked(const uint8_t* data, std::vector<EntityReferenceData>& entities, std::vector<ScriptReferenceData>& scripts);
+
+    void            LoadScripts(const std::vector<ScriptReferenceData>& scripts);
+    //  Load templates of prefab instances and point every instance to it's template, template entities are shared by all of the instances.
+    //  Instances of templates that failed to load, or that use themselves, are left out.
+    void            ExpandPrefabs(std::vector<EntityReferenceData>& entities);
+    //  Sort parsed entities by 'Order', make room for them in 'Entities' arrays and queue them for loading.
+    void            PrepareEntities(std::vector<EntityReferenceData>& entities);
+
+    //  Name hashes of scenes expanding prefabs on this thread, outermost first.
+    static thread_local std::vector<HashType>   ExpansionStack;
+
+    //  Prefetched scenes are not needed yet, so anything else streamed is loaded before them.
+    static constexpr int32_t PrefetchPriority = -100;
 
 public:
+    static constexpr eAssetType ClassAssetType = eAssetType::SCENE;
+
     SceneAsset();
 
     virtual         ~SceneAsset();
     virtual void    ParseData(const uint8_t* data) override;
+    virtual bool    RetainsData() const override;
 
-    inline const std::vector<ScriptReferenceData>&   GetScripts() const
+    inline const std::span<const ScriptReferenceData>   GetScripts() const
     {
         return Scripts;
     }
-    inline const std::vector<EntityReferenceData>&  GetEntities() const
+    //  Entities and their indices, see 'SceneGraph'. Entity queries and passes below just forward to it.
+    inline const SceneGraph&        GetGraph() const
+    {
+        return Graph;
+    }
+    inline const SceneEntities&     GetEntities() const
+    {
+        return Graph.GetEntities();
+    }
+    inline EntityReferenceData      GetEntity(const size_t index) const
+    {
+        return Graph.GetEntity(index);
+    }
+
+    inline uint32_t FindEntityByName(const std::string_view& name) const
+    {
+        return Graph.FindEntityByName(name);
+    }
+    inline uint32_t FindEntityByName(const HashType nameHash) const
+    {
+        return Graph.FindEntityByName(nameHash);
+    }
+    inline uint32_t FindEntityById(const uint64_t id) const
+    {
+        return Graph.FindEntityById(id);
+    }
+
+    inline uint32_t FindPrefabMember(const uint32_t instanceIndex, const std::string_view& name) const
     {
-        return Entities;
+        return Graph.FindPrefabMember(instanceIndex, name);
     }
 
-    static std::vector<SceneAsset*>     ScenesList;
+    inline std::span<const uint32_t> FindChildren(const uint64_t parentId) const
+    {
+        return Graph.FindChildren(parentId);
+    }
+
+    //  Scene that's set as active one, if it's loaded.
+    static SceneAsset*              GetActive();
+
+    //  Load assets of pending entities, 'batchSize' at a time, until all of them are done or 'deadline' has passed. At least one batch is always loaded.
+    //  Entities become visible in 'Order' as soon as their assets are there. Returns true once everything is loaded.
+    bool            ContinueLoading(const std::chrono::steady_clock::time_point deadline, const size_t batchSize);
+
+    inline bool     IsLoading() const
+    {
+        return PendingPosition < PendingEntities.size();
+    }
+
+    //  From 0 to 1, so a loading screen can show it.
+    float_t         GetLoadProgress() const;
+
+    //  Spend up to 'LoadBudgetMs' loading scenes that are not done yet, active scene first. Call it once every frame.
+    static void     ContinueLoadingScenes();
+
+    //  Time scenes may spend loading every frame ('load_budget_ms' setting). Zero means scenes are loaded all at once, in 'ParseData'.
+    static uint32_t LoadBudgetMs;
+
+    //  How many entities have their assets loaded at once when loading incrementally.
+    static constexpr size_t LoadBatchSize = 16;
+
+    template <class F>
+    inline void     UpdateEntities(F&& update) const
+    {
+        Graph.UpdateEntities(std::forward<F>(update));
+    }
+    template <class F>
+    inline void     RenderEntities(F&& render) const
+    {
+        Graph.RenderEntities(std::forward<F>(render));
+    }
+    inline void     SetEntityPosition(const size_t index, const vec3f& position)
+    {
+        Graph.SetEntityPosition(index, position);
+    }
+    inline void     UpdateTransforms()
+    {
+        Graph.UpdateTransforms();
+    }
+
+    //  Point every entity and script referencing 'previousAsset' to 'asset' instead. Returns how many references were changed.
+    uint32_t        PatchAssetReference(const AssetRef& previousAsset, const AssetRef& asset);
+
+    //  Start loading scene 'sceneName' (i.e. 'level01.scene') and everything it refers to on a background thread, so switching to it later doesn't stall.
+    //  Does nothing if scene is loaded or being prefetched already. Must only be called from the main thread.
+    static void     Prefetch(const std::string& sceneName);
+
+    //  Make 'sceneName' the active scene. Prefetched scene is only waited for if it's not done yet, any other scene is loaded right here.
+    static bool     SetActive(const std::string& sceneName);
+
+    static std::vector<AssetHandle<SceneAsset>> ScenesList;
     static std::string                  ActiveScene;
+    //  Scenes that 'Prefetch' was asked for and that were not made active yet, by name.
+    static std::unordered_map<std::string, AssetRequestHandle>  PrefetchRequests;
 };
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "SceneFormat.h"
+
+#include <algorithm>
+
+void SceneFormat::ReadPosition(JsonStreamReader& reader, vec3f& position)
+{
+    float_t* coordinates[] = { &position.X, &position.Y, &position.Z };
+    size_t coordinateIndex = 0;
+    for (bool hasElement = reader.BeginArray(); hasElement; hasElement = reader.NextElement(), coordinateIndex++)
+    {
+        if (coordinateIndex < std::size(coordinates))
+            reader.ReadFloat(*coordinates[coordinateIndex]);
+        else
+            reader.SkipValue();
+    }
+}
+
+void SceneFormat::ReadOverride(JsonStreamReader& reader, Arena& arena, EntityOverrideData& entityOverride)
+{
+    entityOverride = {};
+    std::string_view stringValue;
+    uint64_t numberValue = 0;
+
+    std::string_view key;
+    for (bool hasKey = reader.BeginObject(key); hasKey; hasKey = reader.NextKey(key))
+    {
+        if (key == "target" && reader.ReadString(stringValue))
+            entityOverride.Target = arena.CopyString(stringValue);
+        else if (key == "position")
+        {
+            ReadPosition(reader, entityOverride.Position);
+            entityOverride.Fields |= EntityOverrideData::POSITION;
+        }
+        else if (key == "width" && reader.ReadUInt64(numberValue))
+        {
+            entityOverride.Width = (uint32_t)numberValue;
+            entityOverride.Fields |= EntityOverrideData::WIDTH;
+        }
+        else if (key == "height" && reader.ReadUInt64(numberValue))
+        {
+            entityOverride.Height = (uint32_t)numberValue;
+            entityOverride.Fields |= EntityOverrideData::HEIGHT;
+        }
+        else if (key == "source" && reader.ReadString(stringValue))
+        {
+            entityOverride.SourceAsset = arena.CopyString(stringValue);
+            entityOverride.Fields |= EntityOverrideData::SOURCE;
+        }
+        else if (!reader.HasFailed())
+            reader.SkipValue();
+    }
+}
+
+void SceneFormat::ReadEntry(JsonStreamReader& reader, Arena& arena, std::vector<EntityReferenceData>& entities, std::vector<ScriptReferenceData>& scripts)
+{
+    //  Fields that are not there stay zero.
+    EntityReferenceData entry = {};
+    std::string_view stringValue;
+    uint64_t numberValue = 0;
+
+    std::string_view key;
+    for (bool hasKey = reader.BeginObject(key); hasKey; hasKey = reader.NextKey(key))
+    {
+        if (key == "id")
+            reader.ReadUInt64(entry.Id);
+        else if (key == "name" && reader.ReadString(stringValue))
+            entry.Name = arena.CopyString(stringValue);
+        else if (key == "type" && reader.ReadUInt64(numberValue))
+            entry.Type = (eAssetType)numberValue;
+        else if (key == "position")
+            ReadPosition(reader, entry.Position);
+        else if (key == "width" && reader.ReadUInt64(numberValue))
+            entry.Width = (uint32_t)numberValue;
+        else if (key == "height" && reader.ReadUInt64(numberValue))
+            entry.Height = (uint32_t)numberValue;
+        else if (key == "order" && reader.ReadUInt64(numberValue))
+            entry.Order = (uint32_t)numberValue;
+        else if (key == "source" && reader.ReadString(stringValue))
+            entry.SourceAsset = arena.CopyString(stringValue);
+        else if (key == "parent")
+            reader.ReadUInt64(entry.ParentId);
+        else if (key == "overrides")
+        {
+            std::vector<EntityOverrideData> overrides;
+            for (bool hasElement = reader.BeginArray(); hasElement; hasElement = reader.NextElement())
+                ReadOverride(reader, arena, overrides.emplace_back());
+
+            const auto entryOverrides = arena.NewArray<EntityOverrideData>(overrides.size());
+            std::copy(overrides.begin(), overrides.end(), entryOverrides.begin());
+            entry.Overrides = entryOverrides;
+        }
+        else if (!reader.HasFailed())
+            reader.SkipValue();
+    }
+
+    //  Scripts go into their own list.
+    if (entry.Type == eAssetType::SCRIPT)
+    {
+        const size_t scriptNameOffset = entry.SourceAsset.find_last_of("/") + 1;
+        scripts.push_back({ entry.Id, entry.SourceAsset.substr(scriptNameOffset), entry.SourceAsset, nullptr });
+        return;
+    }
+
+    entities.push_back(entry);
+}
+
+bool SceneFormat::ReadText(const char* data, const size_t size, Arena& arena, std::vector<EntityReferenceData>& entities, std::vector<ScriptReferenceData>& scripts, size_t& errorLine)
+{
+    //  Entries are turned into records as soon as they are read, the text is never kept in any other form.
+    JsonStreamReader reader(data, size);
+
+    std::string_view key;
+    for (bool hasKey = reader.BeginObject(key); hasKey; hasKey = reader.NextKey(key))
+    {
+        if (key != "entries")
+        {
+            reader.SkipValue();
+            continue;
+        }
+
+        for (bool hasEntry = reader.BeginArray(); hasEntry; hasEntry = reader.NextElement())
+            ReadEntry(reader, arena, entities, scripts);
+    }
+
+    if (reader.HasFailed())
+    {
+        errorLine = reader.GetLine();
+        return false;
+    }
+
+    return true;
+}
+
+void SceneFormat::Cook(const std::span<const EntityReferenceData> entities, const std::span<const ScriptReferenceData> scripts, std::vector<char>& cookedData)
+{
+    std::string strings;
+    std::unordered_map<std::string_view, SceneBinString> stringsIndex;
+    std::vector<SceneBinString> references;
+    std::unordered_map<std::string_view, uint32_t> referencesIndex;
+
+    //  Same string is only stored once, names and sources are often repeated in generated scenes.
+    const auto AddString = [&strings, &stringsIndex](const std::string_view& string)
+        {
+            const auto entry = stringsIndex.find(string);
+            if (entry != stringsIndex.end())
+                return entry->second;
+
+            const SceneBinString cookedString = { (uint32_t)strings.size(), (uint32_t)string.size() };
+            strings.append(string);
+            stringsIndex.emplace(string, cookedString);
+
+            return cookedString;
+        };
+
+    const auto AddReference = [&references, &referencesIndex, &AddString](const std::string_view& sourceAsset)
+        {
+            const auto entry = referencesIndex.find(sourceAsset);
+            if (entry != referencesIndex.end())
+                return entry->second;
+
+            const uint32_t referenceIndex = (uint32_t)references.size();
+            references.push_back(AddString(sourceAsset));
+            referencesIndex.emplace(sourceAsset, referenceIndex);
+
+            return referenceIndex;
+        };
+
+    //  Entities are written out in 'Order', that's how scene keeps them once loaded.
+    std::vector<const EntityReferenceData*> sortedEntities;
+    sortedEntities.reserve(entities.size());
+    for (const auto& entity : entities)
+        sortedEntities.push_back(&entity);
+
+    std::stable_sort(sortedEntities.begin(), sortedEntities.end(), [](const EntityReferenceData* a, const EntityReferenceData* b) { return a->Order < b->Order; });
+
+    std::vector<SceneBinEntity> cookedEntities;
+    std::vector<SceneBinOverride> cookedOverrides;
+    cookedEntities.reserve(entities.size());
+    for (const auto* sortedEntity : sortedEntities)
+    {
+        const EntityReferenceData& entity = *sortedEntity;
+        for (const auto& entityOverride : entity.Overrides)
+        {
+            cookedOverrides.push_back({
+                AddString(entityOverride.Target),
+                entityOverride.Fields,
+                (entityOverride.Fields & EntityOverrideData::SOURCE) ? AddReference(entityOverride.SourceAsset) : UINT32_MAX,
+                { entityOverride.Position.X, entityOverride.Position.Y, entityOverride.Position.Z },
+                entityOverride.Width,
+                entityOverride.Height,
+                0
+            });
+        }
+
+        cookedEntities.push_back({
+            entity.Id,
+            (uint64_t)entity.Type,
+            entity.ParentId,
+            { entity.Position.X, entity.Position.Y, entity.Position.Z },
+            entity.Width,
+            entity.Height,
+            entity.Order,
+            AddString(entity.Name),
+            AddReference(entity.SourceAsset),
+            (uint32_t)entity.Overrides.size()
+        });
+    }
+
+    std::vector<SceneBinScript> cookedScripts;
+    cookedScripts.reserve(scripts.size());
+    for (const auto& script : scripts)
+        cookedScripts.push_back({ script.Id, AddString(script.Name), AddReference(script.SourceAsset), 0 });
+
+    SceneBinHeader header = { SceneBinMagic, SceneBinVersion, (uint32_t)cookedEntities.size(), (uint32_t)cookedScripts.size(), (uint32_t)references.size(), (uint32_t)strings.size(), (uint32_t)cookedOverrides.size(), 0 };
+    header.EntitiesOffset = sizeof(SceneBinHeader);
+    header.ScriptsOffset = header.EntitiesOffset + cookedEntities.size() * sizeof(SceneBinEntity);
+    header.OverridesOffset = header.ScriptsOffset + cookedScripts.size() * sizeof(SceneBinScript);
+    header.ReferencesOffset = header.OverridesOffset + cookedOverrides.size() * sizeof(SceneBinOverride);
+    header.StringsOffset = header.ReferencesOffset + ((references.size() * sizeof(SceneBinString) + 7) & ~(size_t)7);
+
+    cookedData.assign(header.StringsOffset + strings.size(), 0);
+    memcpy(cookedData.data(), &header, sizeof(header));
+    memcpy(cookedData.data() + header.EntitiesOffset, cookedEntities.data(), cookedEntities.size() * sizeof(SceneBinEntity));
+    memcpy(cookedData.data() + header.ScriptsOffset, cookedScripts.data(), cookedScripts.size() * sizeof(SceneBinScript));
+    memcpy(cookedData.data() + header.OverridesOffset, cookedOverrides.data(), cookedOverrides.size() * sizeof(SceneBinOverride));
+    memcpy(cookedData.data() + header.ReferencesOffset, references.data(), references.size() * sizeof(SceneBinString));
+    memcpy(cookedData.data() + header.StringsOffset, strings.data(), strings.size());
+}
+
+bool SceneFormat::IsCooked(const uint8_t* data, const size_t size)
+{
+    if (!data || size < sizeof(SceneBinHeader))
+        return false;
+
+    const SceneBinHeader* header = (const SceneBinHeader*)data;
+    return header->Magic == SceneBinMagic && header->Version == SceneBinVersion;
+}
+
+bool SceneFormat::IsValid(const SceneBinHeader& header, const size_t size)
+{
+    const auto IsSectionValid = [size](const uint64_t offset, const uint64_t count, const size_t elementSize)
+        {
+            return offset % 8 == 0 && offset <= size && count <= (size - offset) / elementSize;
+        };
+
+    return IsSectionValid(header.EntitiesOffset, header.EntitiesCount, sizeof(SceneBinEntity)) &&
+        IsSectionValid(header.ScriptsOffset, header.ScriptsCount, sizeof(SceneBinScript)) &&
+        IsSectionValid(header.OverridesOffset, header.OverridesCount, sizeof(SceneBinOverride)) &&
+        IsSectionValid(header.ReferencesOffset, header.ReferencesCount, sizeof(SceneBinString)) &&
+        IsSectionValid(header.StringsOffset, header.StringsSize, 1);
+}
@@ -0,0 +1,149 @@
+#pragma once
+/*
+* File: SceneFormat.h
+* Purpose: records scenes are made of, and the two forms scenes are stored in: JSON text and cooked binary.
+*/
+#include "AssetInterface.h"
+#include "Types.h"
+#include "Arena.h"
+#include "JsonStreamReader.h"
+
+//  Changes a prefab instance makes to one of the template entities, only fields listed in 'Fields' are used.
+struct EntityOverrideData
+{
+    enum eField : uint32_t
+    {
+        POSITION = 1 << 0,
+        WIDTH = 1 << 1,
+        HEIGHT = 1 << 2,
+        SOURCE = 1 << 3
+    };
+
+    //  Name of the template entity.
+    std::string_view    Target;
+    uint32_t            Fields;
+    vec3f               Position;
+    uint32_t            Width;
+    uint32_t            Height;
+    std::string_view    SourceAsset;
+};
+
+//  Reference data records live in the scene's arena, so they are freed all at once with the scene. Their strings are either in the arena too,
+//  or in the cooked file scene keeps mapped. The assets they point to are kept alive by the scene itself (see 'ReferencedAssets').
+struct EntityReferenceData
+{
+    uint64_t            Id;
+    std::string_view    Name;
+    eAssetType          Type;
+    vec3f               Position;
+    uint32_t            Width;
+    uint32_t            Height;
+    uint32_t            Order;
+    std::string_view    SourceAsset;
+    uint64_t            ParentId;
+
+    //  Entity of 'SCENE' type is a prefab instance, 'SourceAsset' is the template scene. These are the changes made to template entities.
+    std::span<const EntityOverrideData> Overrides;
+
+    AssetInterface*     Asset;
+};
+
+struct ScriptReferenceData
+{
+    uint64_t            Id;
+    std::string_view    Name;
+    std::string_view    SourceAsset;
+
+    AssetInterface*     Asset;
+};
+
+//  Cooked scene layout (usually '.scenebin', but packer also cooks every scene it puts into an archive, keeping it's name):
+//      [SceneBinHeader]
+//      [EntitiesCount x SceneBinEntity]
+//      [ScriptsCount x SceneBinScript]
+//      [OverridesCount x SceneBinOverride]   overrides of all prefab instances, in the same order as entities, each one has 'OverridesCount' of them.
+//      [ReferencesCount x SceneBinString]    every distinct source asset, records refer to them by index.
+//      [StringsSize bytes]                   all strings, each one stored once, without terminating zero.
+//  Every section starts at an 8 byte boundary. Records are read right from the mapped file, only strings and assets are fixed up.
+constexpr uint32_t  SceneBinMagic = 0x5347544d;     //  'MTGS'
+constexpr uint32_t  SceneBinVersion = 2;
+
+struct SceneBinHeader
+{
+    uint32_t    Magic;
+    uint32_t    Version;
+    uint32_t    EntitiesCount;
+    uint32_t    ScriptsCount;
+    uint32_t    ReferencesCount;
+    uint32_t    StringsSize;
+    uint32_t    OverridesCount;
+    uint32_t    Padding;
+    uint64_t    EntitiesOffset;
+    uint64_t    ScriptsOffset;
+    uint64_t    OverridesOffset;
+    uint64_t    ReferencesOffset;
+    uint64_t    StringsOffset;
+};
+
+//  Offset is relative to the strings section.
+struct SceneBinString
+{
+    uint32_t    Offset;
+    uint32_t    Length;
+};
+
+struct SceneBinEntity
+{
+    uint64_t        Id;
+    uint64_t        Type;
+    uint64_t        ParentId;
+    float_t         Position[3];
+    uint32_t        Width;
+    uint32_t        Height;
+    uint32_t        Order;
+    SceneBinString  Name;
+    uint32_t        Reference;
+    uint32_t        OverridesCount;
+};
+
+struct SceneBinScript
+{
+    uint64_t        Id;
+    SceneBinString  Name;
+    uint32_t        Reference;
+    uint32_t        Padding;
+};
+
+//  'Reference' is only valid when 'Fields' has 'SOURCE' set.
+struct SceneBinOverride
+{
+    SceneBinString  Target;
+    uint32_t        Fields;
+    uint32_t        Reference;
+    float_t         Position[3];
+    uint32_t        Width;
+    uint32_t        Height;
+    uint32_t        Padding;
+};
+
+static_assert(sizeof(SceneBinHeader) == 72 && sizeof(SceneBinEntity) == 64 && sizeof(SceneBinScript) == 24 && sizeof(SceneBinOverride) == 40);
+
+class SceneFormat
+{
+private:
+    static void     ReadEntry(JsonStreamReader& reader, Arena& arena, std::vector<EntityReferenceData>& entities, std::vector<ScriptReferenceData>& scripts);
+    static void     ReadOverride(JsonStreamReader& reader, Arena& arena, EntityOverrideData& entityOverride);
+    static void     ReadPosition(JsonStreamReader& reader, vec3f& position);
+
+public:
+    //  Read scene JSON text into records, strings are copied into 'arena'. Records don't have assets set. Returns false and the line error is at if text is malformed.
+    static bool     ReadText(const char* data, const size_t size, Arena& arena, std::vector<EntityReferenceData>& entities, std::vector<ScriptReferenceData>& scripts, size_t& errorLine);
+
+    //  Write records out in cooked form.
+    static void     Cook(const std::span<const EntityReferenceData> entities, const std::span<const ScriptReferenceData> scripts, std::vector<char>& cookedData);
+
+    static bool     IsCooked(const uint8_t* data, const size_t size);
+
+    //  Are all sections of the cooked scene inside of the 'size' bytes.
+    static bool     IsValid(const SceneBinHeader& header, const size_t size);
+};
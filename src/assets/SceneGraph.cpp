@@ -0,0 +1,449 @@
+#include "SceneGraph.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+SceneGraph::SceneGraph()
+{
+    DirtyCount = 0;
+    FirstDirty = 0;
+    HandlesCount = 0;
+}
+
+void SceneGraph::Allocate(Arena& arena, const size_t capacity, const std::string_view& sceneName)
+{
+    SceneName = sceneName;
+
+    Entities.Count = 0;
+    Entities.Positions = arena.NewArray<vec3f>(capacity);
+    Entities.WorldPositions = arena.NewArray<vec3f>(capacity);
+    Entities.Widths = arena.NewArray<uint32_t>(capacity);
+    Entities.Heights = arena.NewArray<uint32_t>(capacity);
+    Entities.Orders = arena.NewArray<uint32_t>(capacity);
+    Entities.ParentIds = arena.NewArray<uint64_t>(capacity);
+    Entities.Types = arena.NewArray<eAssetType>(capacity);
+    Entities.Assets = arena.NewArray<AssetInterface*>(capacity);
+    Entities.Ids = arena.NewArray<uint64_t>(capacity);
+    Entities.Names = arena.NewArray<std::string_view>(capacity);
+    Entities.SourceAssets = arena.NewArray<std::string_view>(capacity);
+    Entities.Templates = arena.NewArray<const SceneGraph*>(capacity);
+    Entities.Overrides = arena.NewArray<std::span<PrefabMemberOverride>>(capacity);
+
+    NameIndex.clear();
+    IdIndex.clear();
+    NameIndex.reserve(capacity);
+    IdIndex.reserve(capacity);
+
+    Children = {};
+    ChildrenRanges.clear();
+    HierarchyOrder = {};
+    HierarchyParents = {};
+    SubtreeEnds = {};
+    TransformsDirty = {};
+    HierarchyPositions = {};
+    DirtyCount = 0;
+    FirstDirty = 0;
+    HandlesCount = 0;
+    MemberRanges.clear();
+}
+
+void SceneGraph::AddEntity(const EntityReferenceData& entity, const SceneGraph* prefab, const std::span<PrefabMemberOverride> overrides)
+{
+    const uint32_t index = (uint32_t)Entities.Count++;
+    Entities.Positions[index] = entity.Position;
+    //  Parents might not be added yet, entity is placed properly once the hierarchy is built.
+    Entities.WorldPositions[index] = entity.Position;
+    Entities.Widths[index] = entity.Width;
+    Entities.Heights[index] = entity.Height;
+    Entities.Orders[index] = entity.Order;
+    Entities.ParentIds[index] = entity.ParentId;
+    Entities.Types[index] = entity.Type;
+    Entities.Assets[index] = entity.Asset;
+    Entities.Ids[index] = entity.Id;
+    Entities.Names[index] = entity.Name;
+    Entities.SourceAssets[index] = entity.SourceAsset;
+    Entities.Templates[index] = prefab;
+    Entities.Overrides[index] = overrides;
+
+    if (prefab)
+        ResolveOverrides(index);
+
+    if (!entity.Name.empty() && !NameIndex.emplace(xxh64::hash(entity.Name.data(), entity.Name.length(), 0), index).second)
+        Logger::WARNING(TAG_FUNCTION_NAME, "Scene \"{}\" has more than one entity named \"{}\"!", SceneName, entity.Name);
+
+    if (!IdIndex.emplace(entity.Id, index).second)
+        Logger::WARNING(TAG_FUNCTION_NAME, "Scene \"{}\" has more than one entity with id {}!", SceneName, entity.Id);
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Entity: {}", entity.Name);
+}
+
+void SceneGraph::Build(Arena& arena)
+{
+    BuildChildrenIndex(arena);
+    BuildHierarchy(arena);
+    UpdateMemberHandles();
+}
+
+void SceneGraph::BuildChildrenIndex(Arena& arena)
+{
+    //  Entities are in 'Order' already, stable sort by parent keeps it within each group.
+    Children = arena.NewArray<uint32_t>(Entities.Count);
+    for (uint32_t index = 0; index < Entities.Count; index++)
+        Children[index] = index;
+
+    std::stable_sort(Children.begin(), Children.end(), [this](const uint32_t a, const uint32_t b) { return Entities.ParentIds[a] < Entities.ParentIds[b]; });
+
+    ChildrenRanges.clear();
+    for (uint32_t position = 0; position < Children.size();)
+    {
+        const uint64_t parentId = Entities.ParentIds[Children[position]];
+        uint32_t groupEnd = position + 1;
+        while (groupEnd < Children.size() && Entities.ParentIds[Children[groupEnd]] == parentId)
+            groupEnd++;
+
+        ChildrenRanges.emplace(parentId, std::make_pair(position, groupEnd - position));
+        position = groupEnd;
+    }
+}
+
+void SceneGraph::BuildHierarchy(Arena& arena)
+{
+    const uint32_t count = (uint32_t)Entities.Count;
+    HierarchyOrder = arena.NewArray<uint32_t>(count);
+    HierarchyParents = arena.NewArray<uint32_t>(count);
+    SubtreeEnds = arena.NewArray<uint32_t>(count);
+    TransformsDirty = arena.NewArray<uint8_t>(count);
+    HierarchyPositions = arena.NewArray<uint32_t>(count);
+    std::fill(HierarchyPositions.begin(), HierarchyPositions.end(), InvalidEntityIndex);
+
+    //  Depth first walk, each stack element is an entity and position of it's parent.
+    uint32_t position = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    const auto AddSubtree = [&](const uint32_t rootIndex)
+        {
+            stack.emplace_back(rootIndex, InvalidEntityIndex);
+            while (!stack.empty())
+            {
+                const auto [index, parentPosition] = stack.back();
+                stack.pop_back();
+
+                if (HierarchyPositions[index] != InvalidEntityIndex)
+                    continue;
+
+                HierarchyOrder[position] = index;
+                HierarchyParents[position] = parentPosition;
+                HierarchyPositions[index] = position;
+
+                //  Entities without "id" can't be anyone's parent, zero parent id is the top level group.
+                //  Children are pushed in reverse, so they are visited in 'Order'.
+                const auto children = Entities.Ids[index] ? FindChildren(Entities.Ids[index]) : std::span<const uint32_t>();
+                for (auto child = children.rbegin(); child != children.rend(); child++)
+                    stack.emplace_back(*child, position);
+
+                position++;
+            }
+        };
+
+    for (uint32_t index = 0; index < count; index++)
+    {
+        const uint64_t parentId = Entities.ParentIds[index];
+        const uint32_t parentIndex = parentId ? FindEntityById(parentId) : InvalidEntityIndex;
+        if (parentId && parentIndex == InvalidEntityIndex)
+            Logger::WARNING(TAG_FUNCTION_NAME, "Entity \"{}\" parent {} doesn't exist!", Entities.Names[index], parentId);
+
+        if (parentIndex == InvalidEntityIndex || parentIndex == index)
+            AddSubtree(index);
+    }
+
+    //  Whatever is left is only reachable through a parent loop.
+    for (uint32_t index = 0; index < count && position < count; index++)
+    {
+        if (HierarchyPositions[index] != InvalidEntityIndex)
+            continue;
+
+        Logger::WARNING(TAG_FUNCTION_NAME, "Entity \"{}\" is a part of a parent loop!", Entities.Names[index]);
+        AddSubtree(index);
+    }
+
+    //  Subtree sizes are added up from the leaves, children always come after their parent.
+    for (uint32_t treePosition = 0; treePosition < count; treePosition++)
+        SubtreeEnds[treePosition] = 1;
+
+    for (uint32_t treePosition = count; treePosition-- > 0;)
+    {
+        if (HierarchyParents[treePosition] != InvalidEntityIndex)
+            SubtreeEnds[HierarchyParents[treePosition]] += SubtreeEnds[treePosition];
+    }
+
+    for (uint32_t treePosition = 0; treePosition < count; treePosition++)
+        SubtreeEnds[treePosition] += treePosition;
+
+    std::fill(TransformsDirty.begin(), TransformsDirty.end(), 1);
+    DirtyCount = count;
+    FirstDirty = 0;
+    UpdateTransforms();
+}
+
+void SceneGraph::SetEntityPosition(const size_t index, const vec3f& position)
+{
+    Entities.Positions[index] = position;
+
+    //  Until hierarchy is built, every entity is where it says it is.
+    if (HierarchyPositions.empty())
+    {
+        Entities.WorldPositions[index] = position;
+        return;
+    }
+
+    const uint32_t treePosition = HierarchyPositions[index];
+    if (TransformsDirty[treePosition])
+        return;
+
+    TransformsDirty[treePosition] = 1;
+    FirstDirty = DirtyCount++ ? std::min(FirstDirty, treePosition) : treePosition;
+}
+
+void SceneGraph::UpdateTransforms()
+{
+    //  Sweep starts at the first dirty position and stops as soon as the last one is cleared.
+    const uint32_t count = (uint32_t)HierarchyOrder.size();
+    for (uint32_t position = FirstDirty; DirtyCount && position < count;)
+    {
+        if (!TransformsDirty[position])
+        {
+            position++;
+            continue;
+        }
+
+        //  Parent of this subtree is up to date already, it came earlier. The whole subtree is one run, so it's just a straight sweep.
+        for (const uint32_t subtreeEnd = SubtreeEnds[position]; position < subtreeEnd; position++)
+        {
+            const uint32_t index = HierarchyOrder[position];
+            const uint32_t parentPosition = HierarchyParents[position];
+            const vec3f& localPosition = Entities.Positions[index];
+
+            if (parentPosition == InvalidEntityIndex)
+                Entities.WorldPositions[index] = localPosition;
+            else
+            {
+                const vec3f& parentPosition3 = Entities.WorldPositions[HierarchyOrder[parentPosition]];
+                Entities.WorldPositions[index] = { parentPosition3.X + localPosition.X, parentPosition3.Y + localPosition.Y, parentPosition3.Z + localPosition.Z };
+            }
+
+            if (TransformsDirty[position])
+            {
+                TransformsDirty[position] = 0;
+                DirtyCount--;
+            }
+        }
+    }
+}
+
+uint32_t SceneGraph::FindEntityByName(const std::string_view& name) const
+{
+    const size_t separatorPosition = name.find('/');
+    if (separatorPosition == std::string_view::npos)
+        return FindEntityByName(xxh64::hash(name.data(), name.length(), 0));
+
+    return FindPrefabMember(FindEntityByName(name.substr(0, separatorPosition)), name.substr(separatorPosition + 1));
+}
+
+uint32_t SceneGraph::FindPrefabMember(const uint32_t instanceIndex, const std::string_view& name) const
+{
+    if (instanceIndex >= Entities.Count || !Entities.Templates[instanceIndex])
+        return InvalidEntityIndex;
+
+    //  Entity is looked up in the template, the rest of the path is looked up by the template itself.
+    const uint32_t memberHandle = Entities.Templates[instanceIndex]->FindEntityByName(name);
+    if (memberHandle == InvalidEntityIndex)
+        return InvalidEntityIndex;
+
+    const auto range = std::lower_bound(MemberRanges.begin(), MemberRanges.end(), instanceIndex, [](const std::pair<uint32_t, uint32_t>& range, const uint32_t index) { return range.second < index; });
+    if (range == MemberRanges.end() || range->second != instanceIndex)
+        return InvalidEntityIndex;
+
+    return range->first + memberHandle;
+}
+
+uint32_t SceneGraph::FindEntityByName(const HashType nameHash) const
+{
+    const auto entry = NameIndex.find(nameHash);
+    return entry != NameIndex.end() ? entry->second : InvalidEntityIndex;
+}
+
+uint32_t SceneGraph::FindEntityById(const uint64_t id) const
+{
+    const auto entry = IdIndex.find(id);
+    return entry != IdIndex.end() ? entry->second : InvalidEntityIndex;
+}
+
+std::span<const uint32_t> SceneGraph::FindChildren(const uint64_t parentId) const
+{
+    const auto entry = ChildrenRanges.find(parentId);
+    if (entry == ChildrenRanges.end())
+        return {};
+
+    return std::span<const uint32_t>(Children).subspan(entry->second.first, entry->second.second);
+}
+
+EntityReferenceData SceneGraph::GetEntity(const size_t handle) const
+{
+    if (handle >= Entities.Count)
+    {
+        const auto& [firstHandle, instanceIndex] = FindMemberRange((uint32_t)handle);
+        const uint32_t memberHandle = (uint32_t)handle - firstHandle;
+        EntityReferenceData member = Entities.Templates[instanceIndex]->GetEntity(memberHandle);
+        for (const auto& memberOverride : Entities.Overrides[instanceIndex])
+        {
+            if (memberOverride.MemberIndex != memberHandle)
+                continue;
+
+            if (memberOverride.Data.Fields & EntityOverrideData::POSITION)
+                member.Position = memberOverride.Data.Position;
+            if (memberOverride.Data.Fields & EntityOverrideData::WIDTH)
+                member.Width = memberOverride.Data.Width;
+            if (memberOverride.Data.Fields & EntityOverrideData::HEIGHT)
+                member.Height = memberOverride.Data.Height;
+            if (memberOverride.Data.Fields & EntityOverrideData::SOURCE)
+            {
+                member.SourceAsset = memberOverride.Data.SourceAsset;
+                member.Asset = memberOverride.Asset;
+            }
+        }
+
+        return member;
+    }
+
+    const size_t index = handle;
+    return {
+        Entities.Ids[index],
+        Entities.Names[index],
+        Entities.Types[index],
+        Entities.Positions[index],
+        Entities.Widths[index],
+        Entities.Heights[index],
+        Entities.Orders[index],
+        Entities.SourceAssets[index],
+        Entities.ParentIds[index],
+        {},
+        Entities.Assets[index]
+    };
+}
+
+vec3f SceneGraph::GetWorldPosition(const size_t handle) const
+{
+    return GetMemberPosition({}, {}, (uint32_t)handle);
+}
+
+const std::pair<uint32_t, uint32_t>& SceneGraph::FindMemberRange(const uint32_t handle) const
+{
+    //  Ranges are in handle order, the one that starts last at or before 'handle' has it.
+    const auto range = std::upper_bound(MemberRanges.begin(), MemberRanges.end(), handle, [](const uint32_t handle, const std::pair<uint32_t, uint32_t>& range) { return handle < range.first; });
+    return *(range - 1);
+}
+
+void SceneGraph::ResolveOverrides(const size_t index)
+{
+    const SceneGraph* prefab = Entities.Templates[index];
+    for (auto& memberOverride : Entities.Overrides[index])
+    {
+        const std::string_view& target = memberOverride.Data.Target;
+        memberOverride.MemberIndex = prefab->FindEntityByName(xxh64::hash(target.data(), target.length(), 0));
+        if (memberOverride.MemberIndex == InvalidEntityIndex)
+            Logger::WARNING(TAG_FUNCTION_NAME, "Prefab \"{}\" doesn't have entity \"{}\" that \"{}\" overrides!", Entities.SourceAssets[index], target, Entities.Names[index]);
+    }
+}
+
+bool SceneGraph::IsInSubtree(const uint32_t rootIndex, const uint32_t index) const
+{
+    const uint32_t rootPosition = HierarchyPositions[rootIndex];
+    const uint32_t position = HierarchyPositions[index];
+    return rootPosition <= position && position < SubtreeEnds[rootPosition];
+}
+
+vec3f SceneGraph::GetOverriddenPosition(const vec3f& origin, const std::span<const PrefabMemberOverride> overrides, const uint32_t index) const
+{
+    const vec3f& worldPosition = Entities.WorldPositions[index];
+    vec3f position = { origin.X + worldPosition.X, origin.Y + worldPosition.Y, origin.Z + worldPosition.Z };
+
+    //  Overridden position of a parent moves it's whole subtree by the same amount.
+    for (const auto& memberOverride : overrides)
+    {
+        if (!(memberOverride.Data.Fields & EntityOverrideData::POSITION) || memberOverride.MemberIndex == InvalidEntityIndex || !IsInSubtree(memberOverride.MemberIndex, index))
+            continue;
+
+        const vec3f& templatePosition = Entities.Positions[memberOverride.MemberIndex];
+        position.X += memberOverride.Data.Position.X - templatePosition.X;
+        position.Y += memberOverride.Data.Position.Y - templatePosition.Y;
+        position.Z += memberOverride.Data.Position.Z - templatePosition.Z;
+    }
+
+    return position;
+}
+
+vec3f SceneGraph::GetMemberPosition(const vec3f& origin, const std::span<const PrefabMemberOverride> overrides, const uint32_t handle) const
+{
+    if (handle < Entities.Count)
+        return GetOverriddenPosition(origin, overrides, handle);
+
+    const auto& [firstHandle, instanceIndex] = FindMemberRange(handle);
+    return Entities.Templates[instanceIndex]->GetMemberPosition(GetOverriddenPosition(origin, overrides, instanceIndex), Entities.Overrides[instanceIndex], handle - firstHandle);
+}
+
+uint32_t SceneGraph::PatchAsset(const AssetInterface* previousAsset, AssetInterface* asset)
+{
+    uint32_t referencesPatched = 0;
+    for (auto& entityAsset : Entities.Assets.first(Entities.Count))
+    {
+        if (entityAsset != previousAsset)
+            continue;
+
+        entityAsset = asset;
+        referencesPatched++;
+    }
+
+    for (const auto& overrides : Entities.Overrides.first(Entities.Count))
+    {
+        for (auto& memberOverride : overrides)
+        {
+            if (memberOverride.Asset != previousAsset)
+                continue;
+
+            memberOverride.Asset = asset;
+            referencesPatched++;
+        }
+    }
+
+    return referencesPatched;
+}
+
+uint32_t SceneGraph::PatchTemplate(const SceneGraph* previousPrefab, const SceneGraph* prefab)
+{
+    uint32_t instancesPatched = 0;
+    for (size_t index = 0; index < Entities.Count; index++)
+    {
+        if (Entities.Templates[index] != previousPrefab)
+            continue;
+
+        Entities.Templates[index] = prefab;
+        ResolveOverrides(index);
+        instancesPatched++;
+    }
+
+    return instancesPatched;
+}
+
+void SceneGraph::UpdateMemberHandles()
+{
+    //  Same order members are rendered in, every instance takes all the handles it's template has.
+    MemberRanges.clear();
+    HandlesCount = (uint32_t)Entities.Count;
+    for (uint32_t index = 0; index < Entities.Count; index++)
+    {
+        if (!Entities.Templates[index])
+            continue;
+
+        MemberRanges.emplace_back(HandlesCount, index);
+        HandlesCount += Entities.Templates[index]->HandlesCount;
+    }
+}
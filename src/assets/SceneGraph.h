@@ -0,0 +1,201 @@
+#pragma once
+/*
+* File: SceneGraph.h
+* Purpose: entities of a scene and everything worked out from them: lookups by name and id, children of every parent and world positions.
+*          Knows nothing about loading, entities are handed to it one at a time as their assets become available.
+*          Prefab instance is a single entity referring to the template graph, template entities are shared by every instance of it.
+*/
+#include "SceneFormat.h"
+
+class SceneGraph;
+
+//  Change a prefab instance makes to one of the template entities. Only the template's own entities can be overridden, not the ones of prefabs nested in it.
+struct PrefabMemberOverride
+{
+    EntityOverrideData  Data;
+    //  Template entity 'Data.Target' refers to, or 'InvalidEntityIndex' if template doesn't have it.
+    uint32_t            MemberIndex;
+    //  Loaded from 'Data.SourceAsset', if 'SOURCE' field is overridden.
+    AssetInterface*     Asset;
+};
+
+//  Scene entities stored as structure of arrays, element 'i' of every array belongs to the same entity.
+//  All arrays live in the scene's arena and are sorted by 'Order', so passes over them go front to back in draw order.
+//  Only the first 'Count' elements are valid, the rest is still being loaded (see 'SceneAsset::ContinueLoading').
+struct SceneEntities
+{
+    size_t                          Count = 0;
+
+    //  Hot data, touched by update and render passes every frame.
+    //  Positions are relative to the parent entity, world positions are worked out from them by 'SceneGraph::UpdateTransforms'.
+    std::span<vec3f>                Positions;
+    std::span<vec3f>                WorldPositions;
+    std::span<uint32_t>             Widths;
+    std::span<uint32_t>             Heights;
+    std::span<uint32_t>             Orders;
+    std::span<uint64_t>             ParentIds;
+    std::span<eAssetType>           Types;
+    std::span<AssetInterface*>      Assets;
+
+    //  Cold data, only needed to find an entity or to tell what it was made from.
+    std::span<uint64_t>             Ids;
+    std::span<std::string_view>     Names;
+    std::span<std::string_view>     SourceAssets;
+    //  Template graph and overrides of prefab instances, nullptr and empty for other entities.
+    std::span<const SceneGraph*>                    Templates;
+    std::span<std::span<PrefabMemberOverride>>      Overrides;
+};
+
+//  Returned by entity queries when there's no such entity.
+constexpr uint32_t  InvalidEntityIndex = UINT32_MAX;
+
+class SceneGraph
+{
+private:
+    //  Owner's name, for warnings.
+    std::string_view    SceneName;
+    SceneEntities       Entities;
+
+    //  Filled in as entities are added, map to entity index.
+    std::unordered_map<HashType, uint32_t>  NameIndex;
+    std::unordered_map<uint64_t, uint32_t>  IdIndex;
+    //  Indices of entities grouped by their parent id, each group is in 'Order'. 'ChildrenRanges' maps parent id to it's group (first, count).
+    //  Only built once all entities are added.
+    std::span<uint32_t>                                         Children;
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> ChildrenRanges;
+
+    //  Entity hierarchy flattened in depth first order, every parent comes before it's children and a whole subtree is one contiguous range.
+    //  Arrays below are indexed by position in this order, except 'HierarchyPositions', that maps entity index back to it's position.
+    std::span<uint32_t>     HierarchyOrder;
+    //  Position of the parent, or 'InvalidEntityIndex' for top level entities.
+    std::span<uint32_t>     HierarchyParents;
+    //  Position right after the last entity of the subtree.
+    std::span<uint32_t>     SubtreeEnds;
+    std::span<uint8_t>      TransformsDirty;
+    std::span<uint32_t>     HierarchyPositions;
+    //  How many positions are marked dirty and the first of them, so frames where nothing moved don't look at 'TransformsDirty' at all.
+    uint32_t                DirtyCount;
+    uint32_t                FirstDirty;
+
+    //  Entity handles are entity indices, followed by handles of prefab members, every instance takes as many as it's template has.
+    //  'MemberRanges' is the first member handle and index of every instance, in 'Order'.
+    uint32_t                                    HandlesCount;
+    std::vector<std::pair<uint32_t, uint32_t>>  MemberRanges;
+
+    void            BuildChildrenIndex(Arena& arena);
+    //  Must be called after 'BuildChildrenIndex'. Entities with a parent that doesn't exist, or that are a part of a parent loop, become top level ones.
+    void            BuildHierarchy(Arena& arena);
+    //  Member handles range (first handle, instance index) 'handle' is in.
+    const std::pair<uint32_t, uint32_t>&    FindMemberRange(const uint32_t handle) const;
+    //  Point overrides of instance at 'index' to the template entities they change.
+    void            ResolveOverrides(const size_t index);
+    //  Is entity at 'index' a part of subtree that starts with entity at 'rootIndex'.
+    bool            IsInSubtree(const uint32_t rootIndex, const uint32_t index) const;
+    //  World position of entity at 'index' in an instance placed at 'origin', moved by position overrides of it or of it's parents.
+    vec3f           GetOverriddenPosition(const vec3f& origin, const std::span<const PrefabMemberOverride> overrides, const uint32_t index) const;
+    //  Same for any entity handle, members of nested prefabs are looked up a level at a time.
+    vec3f           GetMemberPosition(const vec3f& origin, const std::span<const PrefabMemberOverride> overrides, const uint32_t handle) const;
+
+    template <class F>
+    void            RenderMembers(F& render, const uint32_t handleBase, const vec3f& origin, const std::span<const PrefabMemberOverride> overrides) const
+    {
+        //  Members of every instance are rendered right after it, with the instance's world position as their origin.
+        uint32_t memberBase = (uint32_t)Entities.Count;
+        for (uint32_t index = 0; index < Entities.Count; index++)
+        {
+            uint32_t width = Entities.Widths[index];
+            uint32_t height = Entities.Heights[index];
+            AssetInterface* asset = Entities.Assets[index];
+            for (const auto& memberOverride : overrides)
+            {
+                if (memberOverride.MemberIndex != index)
+                    continue;
+
+                if (memberOverride.Data.Fields & EntityOverrideData::WIDTH)
+                    width = memberOverride.Data.Width;
+                if (memberOverride.Data.Fields & EntityOverrideData::HEIGHT)
+                    height = memberOverride.Data.Height;
+                if (memberOverride.Data.Fields & EntityOverrideData::SOURCE)
+                    asset = memberOverride.Asset;
+            }
+
+            const vec3f position = GetOverriddenPosition(origin, overrides, index);
+            render(handleBase + index, Entities.Types[index], position, width, height, asset);
+
+            if (const SceneGraph* prefab = Entities.Templates[index])
+            {
+                prefab->RenderMembers(render, handleBase + memberBase, position, Entities.Overrides[index]);
+                memberBase += prefab->HandlesCount;
+            }
+        }
+    }
+
+public:
+    SceneGraph();
+
+    //  Make room for 'capacity' entities in 'arena'. Anything added before is forgotten.
+    void            Allocate(Arena& arena, const size_t capacity, const std::string_view& sceneName);
+    //  Entities must be added in 'Order', no more than there's room for. Prefab instance also gives the template graph, that must be built already, and it's overrides.
+    void            AddEntity(const EntityReferenceData& entity, const SceneGraph* prefab = nullptr, const std::span<PrefabMemberOverride> overrides = {});
+    //  Work out children and the hierarchy once every entity is added, world positions are up to date after it.
+    void            Build(Arena& arena);
+
+    inline const SceneEntities&     GetEntities() const
+    {
+        return Entities;
+    }
+
+    //  Entity indices are below 'GetEntities().Count', prefab members take the rest of handles. Members only have handles once graph is built.
+    inline uint32_t                 GetHandlesCount() const
+    {
+        return HandlesCount;
+    }
+
+    //  Whole entity record put together from all the arrays, for when more than a couple of fields is needed.
+    //  Prefab members are the template's records with instance's overrides applied, their ids and names are the template's ones.
+    EntityReferenceData             GetEntity(const size_t handle) const;
+    vec3f                           GetWorldPosition(const size_t handle) const;
+
+    //  Entity queries, all of them take the same time no matter how many entities there are. Entity handle is returned, or 'InvalidEntityIndex'.
+    //  If a few entities share a name, the one that comes first in 'Order' is found.
+    //  Entities of prefab instances are found by path, i.e. 'StartButton/Text'. Name hash and id only find entities listed in the scene itself.
+    uint32_t        FindEntityByName(const std::string_view& name) const;
+    uint32_t        FindEntityByName(const HashType nameHash) const;
+    uint32_t        FindEntityById(const uint64_t id) const;
+
+    //  Handle of template entity 'name' for prefab instance at 'instanceIndex', nested prefabs are looked up a level at a time.
+    uint32_t        FindPrefabMember(const uint32_t instanceIndex, const std::string_view& name) const;
+
+    //  Indices of entities with 'ParentId' equal to 'parentId', in 'Order'. Zero parent id gives top level entities.
+    std::span<const uint32_t>       FindChildren(const uint64_t parentId) const;
+
+    //  Update pass, 'update(index, position)' is called for every entity in 'Order' with it's position relative to the parent. Use 'SetEntityPosition' to move it.
+    template <class F>
+    inline void     UpdateEntities(F&& update) const
+    {
+        for (size_t index = 0; index < Entities.Count; index++)
+            update(index, Entities.Positions[index]);
+    }
+
+    //  Render pass, 'render(handle, type, worldPosition, width, height, asset)' is called for every entity in 'Order'. Members of a prefab instance come right after it.
+    template <class F>
+    inline void     RenderEntities(F&& render) const
+    {
+        RenderMembers(render, 0, {}, {});
+    }
+
+    //  Move an entity relative to it's parent. It's subtree world positions are updated next time 'UpdateTransforms' is called.
+    //  Only entities of the scene itself can be moved, prefab members move along with their instance.
+    void            SetEntityPosition(const size_t index, const vec3f& position);
+
+    //  Work out world positions of entities that were moved and all of their children, in one pass over the flattened hierarchy. Subtrees nobody moved are skipped.
+    void            UpdateTransforms();
+
+    //  Point every entity and override referencing 'previousAsset' to 'asset' instead. Returns how many references were changed.
+    uint32_t        PatchAsset(const AssetInterface* previousAsset, AssetInterface* asset);
+    //  Point instances of 'previousPrefab' to 'prefab' instead, overrides are matched to it's entities by name again. Returns how many instances were changed.
+    //  Member handles are not updated, see 'UpdateMemberHandles'.
+    uint32_t        PatchTemplate(const SceneGraph* previousPrefab, const SceneGraph* prefab);
+    //  Work out member handles again, once any template this graph uses, directly or through other templates, has changed.
+    void            UpdateMemberHandles();
+};
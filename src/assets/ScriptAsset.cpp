@@ -1,6 +1,10 @@
 #include "ScriptAsset.h"
+#include "ScriptCompiler.h"
+#include "ScriptLinker.h"
 #include "Logger.h"
 
+using Scripting::Token;
+
 ScriptAsset::ScriptAsset()
 {
     ErrorsFound = 0;
@@ -10,397 +14,431 @@ ScriptAsset::~ScriptAsset()
 {
 }
 
-//  TODO:   this implementation is very trivial - LOTS of redundant string copies on each iteration. Once all parser stuff is done - re-do without using string copy.
 /// <summary>
-/// Parse input <param>data</param> string and generate an IR code to be executed later by the scripting engine.
+/// Parse input <param>data</param> string and compile it into bytecode to be executed later by the scripting engine.
 /// Important! This method expects to not be called manually, since it depends on a 'DataSize' value of this class instance to be set before.
 /// </summary>
 /// <param name="data">A pointer to a buffer containing complete script strings</param>
 void ScriptAsset::ParseData(const uint8_t* data)
 {
-    //  NOTE: half of these are not needed with current implementation, that's for future.
-    struct tParserState
+    //  Tokens point right into the buffer, only names and values that end up in IR are copied.
+    Scripting::Lexer lexer((const char*)data, data ? DataSize : 0);
+
+    for (Token token = lexer.Next(); token.Type != Token::END; token = lexer.Next())
     {
-        bool            IsFunction              = false;
-        bool            IsFunctionArguments     = false;
-        bool            IsFunctionBody          = false;
-        bool            IsCommentary            = false;
-        bool            IsAssignmentOperator    = false;
-        bool            IsFunctionCall          = false;
-        bool            IsFunctionCallArguments = false;
-        bool            IsString                = false;
-        bool            IsVariableDeclaration   = false;
-        bool            IsIncludeDirective      = false;
-        bool            IsCondition             = false;
-
-        struct tContext
-        {
-            size_t      LastFunctionIndex = 0;
-            std::string FunctionName = {};
-        }               Context = {};
-    } ParserState;
+        if (token.Type == Token::NEWLINE)
+            continue;
 
-    //  This will modify the 'subject' string to replace all occurrences of 'search' with 'replace'.
-    const auto ReplaceStringInPlace = [](std::string& subject, const std::string& search, const std::string& replace)
+        //  Is it include directive?
+        if (token.Type == Token::DIRECTIVE && token.Text == "#include")
         {
-            size_t pos = 0;
-            while ((pos = subject.find(search, pos)) != std::string::npos) {
-                subject.replace(pos, search.length(), replace);
-                pos += replace.length();
+            const Token path = lexer.Next();
+            if (path.Type != Token::STRING || path.Text.length() <= 2)
+            {
+                SyntaxError(path, "empty include directive found");
+                SkipLine(lexer);
+                continue;
             }
-        };
 
-    //  This will remove all 'search' characters from the beginning of a string.
-    const auto TrimLeftInPlace = [](std::string& subject, const char search)
-        {
-            if (subject.starts_with(search) && subject.length())
-                subject = subject.substr(subject.find_first_not_of(search));
-        };
+            //  TODO: parse include directive. That will make an instance of 'ScriptAsset' and pass this directive path there.
+            if (!ExpectLineEnd(lexer))
+                SkipLine(lexer);
+
+            continue;
+        }
 
-    //  This version is to be used in a function definition string.
-    //  Parsed output will be written to an 'arguments' list.
-    const auto ParseArgumentsList = [&](const std::string& input, const std::string& functionName, std::vector<std::string>& arguments)
+        //  Is it function? Broken function leaves the parser lost, so nothing after it is read.
+        if (token.Type == Token::IDENTIFIER && token.Text == "function")
         {
-            if (!input.length())
-                return;
+            if (!ParseFunction(lexer))
+                break;
 
-            std::stringstream argumentsString(input);
-            std::string token;
-            size_t argumentIndex = 1;
+            continue;
+        }
 
-            while (std::getline(argumentsString, token, ','))
-            {
-                if (token.length())
-                    ReplaceStringInPlace(token, " ", "");
-
-                if (!token.length())
-                {
-                    Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: empty argument #{} name in '{}' function arguments list.", argumentIndex, functionName);
-                    ErrorsFound++;
-                    argumentIndex++;
-                    continue;
-                }
-
-                if (token == "function")
-                {
-                    Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: unexpected usage of keyword as #{} '{}' function argument", argumentIndex, functionName);
-                    ErrorsFound++;
-                    argumentIndex++;
-                    continue;
-                }
-
-                arguments.push_back(token);
-                argumentIndex++;
-            }
-        };
+        //  None of the above. Unknown token.
+        SyntaxError(token, fmt::format("unknown token found '{}'", token.Text));
+        SkipLine(lexer);
+    }
 
-    //  This version is to be used in a function call string.
-    //  Parsed arguments list will be written into 'arguments' list.
-    //  It's different because of support for string arguments (quoted string). Since function definition only describes arguments names - function call, however, expects actual arguments values and that can include string.
-    const auto ParseArgumentsListCall = [&](const std::string& input, const std::string& functionName, const std::string& calleeFunctionName, std::vector<std::string>& arguments)
-        {
-            if (!input.length())
-                return;
+    Logger::TRACE(TAG_FUNCTION_NAME, "Found {} functions.", Functions.size());
 
-            std::stringstream argumentsString(input);
-            std::string token;
-            size_t argumentIndex = 1;
-            bool isQuotedString = false;
-            std::string quotedString;
+    //  Script with syntax errors is never run, so there's no point compiling it.
+    if (!ErrorsFound)
+    {
+        Scripting::Compiler compiler(Program, Name);
+        for (const auto& function : Functions)
+            compiler.CompileFunction(function);
 
-            while (std::getline(argumentsString, token, ','))
-            {
-                if (token.length() && !isQuotedString)
-                    ReplaceStringInPlace(token, " ", "");
-
-                if (!token.length())
-                {
-                    Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: empty function '{}' call argument #{}, called from {}.", functionName, argumentIndex, calleeFunctionName);
-                    ErrorsFound++;
-                    argumentIndex++;
-                    continue;
-                }
-
-                const auto quoteCharPos = token.find_first_of('"');
-                if (isQuotedString)
-                {
-                    //  Is it end of a quoted string?
-                    if (quoteCharPos != std::string::npos)
-                    {
-                        quotedString += token.substr(0, quoteCharPos);
-
-                        arguments.push_back(quotedString);
-
-                        quotedString.clear();
-                        isQuotedString = false;
-                        argumentIndex++;
-                        continue;
-                    }
-
-                    //  No quote character in this string and it's a quoted string - add it to the last buffer and go on.
-                    quotedString += token;
-                    quotedString += ",";
-                    continue;
-                }
-                else
-                {
-                    //  Not a quoted string, just an argument name.
-                    if (quoteCharPos == std::string::npos)
-                    {
-                        arguments.push_back(token);
-
-                        argumentIndex++;
-                        continue;
-                    }
-
-                    //  Beginning of a quoted string?
-                    if (quoteCharPos == 0)
-                    {
-                        const auto lastQuotePos = token.find_last_of('"');
-
-                        //  Is there immediately an end quote in the string?
-                        if (lastQuotePos != std::string::npos && lastQuotePos != 0)
-                        {
-                            arguments.push_back(token.substr(1, lastQuotePos - 1));
-                            argumentIndex++;
-                            continue;
-                        }
-
-                        //  There's no quote character in this string after start quote.
-                        quotedString = token.substr(1);
-                        quotedString += ",";
-                        isQuotedString = true;
-                        continue;
-                    }
-
-                    //  That's an error if none of the above worked out.
-                    Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: unexpected token found in '{}' function call, called from '{}'.", functionName, calleeFunctionName);
-                    ErrorsFound++;
-                }
-            }
-        };
+        ErrorsFound += compiler.GetErrorsFound();
+    }
 
-    //  Make a copy of the string to remove all unnecessary stuff.
-    std::string dataString((const char* const)data, DataSize);
-    ReplaceStringInPlace(dataString, "\t", "");
-    ReplaceStringInPlace(dataString, "  ", "");
+    //  Calls can only be linked once every function of the script is compiled.
+    if (!ErrorsFound)
+    {
+        Scripting::Linker linker(Program, Name);
+        linker.Link();
 
-    //  String stream to iterate through and tokenize each line.
-    std::stringstream parserDataString(dataString);
-    std::string currentTokenString;
+        ErrorsFound += linker.GetErrorsFound();
+    }
 
-    while (std::getline(parserDataString, currentTokenString, '\n'))
-    {
-        Logger::TRACE(TAG_FUNCTION_NAME, "Token: {}", currentTokenString);
+    Functions.clear();
+}
 
-        if (!currentTokenString.length())
-            continue;
+bool ScriptAsset::ParseFunction(Scripting::Lexer& lexer)
+{
+    const Token name = lexer.Next();
+    if (name.Type != Token::IDENTIFIER)
+    {
+        SyntaxError(name, "malformed function definition! Can't find function name");
+        return false;
+    }
 
-        TrimLeftInPlace(currentTokenString, ' ');
+    if (lexer.Next().Type != Token::LEFT_PARENTHESIS)
+    {
+        SyntaxError(name, "malformed function definition! Can't find arguments list");
+        return false;
+    }
 
-        //  Is it commentary?
-        if (currentTokenString.starts_with("//"))
-        {
-            continue;
-        }
+    Scripting::FunctionDefinition& function = Functions.emplace_back();
+    function.Name = name.Text;
 
-        //  Is it include directive?
-        if (currentTokenString.starts_with("#include"))
+    //  Function arguments.
+    if (lexer.Peek().Type == Token::RIGHT_PARENTHESIS)
+        lexer.Next();
+    else
+    {
+        for (size_t argumentIndex = 1;; argumentIndex++)
         {
-            //  Can't have that inside function body.
-            if (ParserState.IsFunctionBody)
+            const Token argument = lexer.Next();
+            if (argument.Type != Token::IDENTIFIER || argument.Text == "function")
             {
-                Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: unexpected include keyword found inside function body.");
-                ErrorsFound++;
-                return;
+                SyntaxError(argument, fmt::format("unexpected '{}' as #{} '{}' function argument", argument.Text, argumentIndex, function.Name));
+                return false;
             }
 
-            auto quotedString = currentTokenString.substr(currentTokenString.find_first_of('"') + 1);
-            quotedString = quotedString.substr(0, quotedString.find_first_of('"') - 1);
+            function.Arguments.emplace_back(argument.Text);
+
+            const Token separator = lexer.Next();
+            if (separator.Type == Token::RIGHT_PARENTHESIS)
+                break;
 
-            if (!quotedString.length())
+            if (separator.Type != Token::COMMA)
             {
-                Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: empty include directive found.");
-                ErrorsFound++;
-                return;
+                SyntaxError(separator, fmt::format("malformed '{}' function arguments list", function.Name));
+                return false;
             }
-
-            //  TODO: parse include directive. That will make an instance of 'ScriptAsset' and pass this directive path there.
-            continue;
         }
+    }
+
+    //  Function body can start on the same line or any line after.
+    Token token = lexer.Next();
+    while (token.Type == Token::NEWLINE)
+        token = lexer.Next();
+
+    if (token.Type != Token::LEFT_BRACE)
+    {
+        SyntaxError(token, fmt::format("function '{}' is missing it's body", function.Name));
+        return false;
+    }
 
-        //  Is it function?
-        if (currentTokenString.starts_with("function"))
+    uint32_t conditionDepth = 0;
+    for (token = lexer.Next();; token = lexer.Next())
+    {
+        switch (token.Type)
         {
-            //  Can't have another function definition inside function body.
-            if (ParserState.IsFunctionBody)
-            {
-                Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: unexpected function keyword found inside function body.");
-                ErrorsFound++;
-                return;
-            }
+        case Token::NEWLINE:
+            continue;
 
-            //  Malformed function definition?
-            if (currentTokenString.find_first_of('(') == std::string::npos || currentTokenString.find_first_of(')') == std::string::npos)
+        //  Function body ends?
+        case Token::RIGHT_BRACE:
+            if (conditionDepth)
             {
-                Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: malformed function definition! Can't find arguments list.");
-                ErrorsFound++;
-                return;
+                SyntaxError(token, fmt::format("function '{}' has {} condition(s) without 'endif'", function.Name, conditionDepth));
+                return false;
             }
+            return true;
 
-            ParserState.IsFunction = true;
+        case Token::END:
+            SyntaxError(token, fmt::format("function '{}' body is never closed", function.Name));
+            return false;
 
-            //  Get function name.
-            auto functionName = currentTokenString.substr(currentTokenString.find_first_of(' '));
-            functionName = functionName.substr(1, functionName.find_first_of('(') - 1);
+        //  Can't have that inside function body.
+        case Token::DIRECTIVE:
+            SyntaxError(token, "unexpected include keyword found inside function body");
+            return false;
 
-            //  Get function arguments.
-            auto argumentsString = currentTokenString.substr(currentTokenString.find_first_of('('));
-            argumentsString = argumentsString.substr(1, argumentsString.find_first_of(')') - 1);
+        default:
+            break;
+        }
 
-            Scripting::FunctionDefinition thisFunction;
-            thisFunction.Name = functionName;
+        if (token.Type == Token::IDENTIFIER && token.Text == "function")
+        {
+            SyntaxError(token, "unexpected function keyword found inside function body");
+            return false;
+        }
 
-            ParseArgumentsList(argumentsString, functionName, thisFunction.Arguments);
+        if (!ParseStatement(lexer, token, function, conditionDepth))
+            SkipLine(lexer);
+    }
+}
 
-            Functions.push_back(thisFunction);
+bool ScriptAsset::ParseStatement(Scripting::Lexer& lexer, const Token& firstToken, Scripting::FunctionDefinition& function, uint32_t& conditionDepth)
+{
+    if (firstToken.Type != Token::IDENTIFIER)
+    {
+        SyntaxError(firstToken, fmt::format("unknown token found '{}'", firstToken.Text));
+        return false;
+    }
 
-            ParserState.Context.FunctionName = functionName;
-            ParserState.Context.LastFunctionIndex = Functions.size() - 1;
+    //  Is it condition statement?
+    if (firstToken.Text == "if")
+    {
+        if (!ParseCondition(lexer, function))
+            return false;
 
-            continue;
-        }
+        conditionDepth++;
+        return true;
+    }
 
-        //  Function body?
-        if (currentTokenString.starts_with("{"))
+    //  Condition statement ends?
+    if (firstToken.Text == "endif")
+    {
+        if (!conditionDepth)
         {
-            ParserState.IsFunctionBody = true;
-            continue;
+            SyntaxError(firstToken, fmt::format("'endif' without condition in function '{}'", function.Name));
+            return false;
         }
 
-        //  Function body ends?
-        if (ParserState.IsFunctionBody && currentTokenString.starts_with("}"))
-        {
-            ParserState.IsFunctionBody = false;
-            ParserState.IsFunction = false;
+        conditionDepth--;
+        function.ControlFlow.emplace_back(new Scripting::ConditionStatement(Scripting::ControlFlowElement::CONDITION_END));
 
-            continue;
-        }
+        return ExpectLineEnd(lexer);
+    }
 
-        //  Is it function call?
-        if (!currentTokenString.starts_with("if") && currentTokenString.find_first_of("=") == std::string::npos && currentTokenString.find_first_of("(") != std::string::npos && currentTokenString.find_first_of(")") != std::string::npos)
-        {
-            ParserState.IsFunctionCall = true;
+    //  Is it function call?
+    if (lexer.Peek().Type == Token::LEFT_PARENTHESIS)
+    {
+        lexer.Next();
 
-            auto calledFunctionName = currentTokenString.substr(0, currentTokenString.find_first_of('('));
-            ReplaceStringInPlace(calledFunctionName, " ", "");
+        std::vector<std::string> arguments;
+        if (!ParseCallArguments(lexer, arguments) || !ExpectLineEnd(lexer))
+            return false;
 
-            auto calledFunctionArguments = currentTokenString.substr(currentTokenString.find_first_of('(') + 1);
-            calledFunctionArguments = calledFunctionArguments.substr(0, calledFunctionArguments.find_first_of(')'));
+        auto* call = new Scripting::FunctionCallStatement(std::string(firstToken.Text), arguments);
+        call->Line = firstToken.Line;
+        function.ControlFlow.emplace_back(call);
 
-            //  Check if that function exists.
-            //  Actually, don't do that. The function might be declared afterwards, so let's do it after all parser stuff is done.
-            /*
-            const auto functionRef = std::find_if(Functions.begin(), Functions.end(), [&](const Scripting::FunctionDefinition& f) { return f.Name == calledFunctionName; });
-            if (functionRef == std::end(Functions))
-            {
-                Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: function '{}' called from '{}' was not found.", calledFunctionName, ParserState.Context.FunctionName);
-                ErrorsFound++;
-                return;
-            }
-            */
-
-            //  Parse arguments list.
-            std::vector<std::string> argumentsList;
-            ParseArgumentsListCall(calledFunctionArguments, calledFunctionName, ParserState.Context.FunctionName, argumentsList);
-            /*
-            //  Check if number of arguments that's passed in called function match the expected number of arguments for that function.
-            if (argumentsList.size() != functionRef->Arguments.size())
-            {
-                Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: function's '{}' number of arguments doesn't match the function prototype, called from '{}'.", calledFunctionName, ParserState.Context.FunctionName);
-                ErrorsFound++;
-                return;
-            }
-            */
+        return true;
+    }
 
-            auto currentFunction = std::find_if(Functions.begin(), Functions.end(), [&](const Scripting::FunctionDefinition& f) { return ParserState.Context.FunctionName == f.Name; });
+    //  Assignment operator? Line break is not consumed, so the rest of the statement loop isn't thrown off.
+    if (lexer.Peek().Type != Token::ASSIGN)
+    {
+        SyntaxError(firstToken, fmt::format("'{}' is neither a function call nor an assignment", firstToken.Text));
+        return false;
+    }
 
-            auto item = new Scripting::FunctionCallStatement(calledFunctionName, argumentsList, 0);
-            currentFunction->ControlFlow.push_back(item);
+    lexer.Next();
 
-            ParserState.IsFunctionCall = false;
+    const Token value = lexer.Next();
+    if (value.Type != Token::IDENTIFIER && value.Type != Token::NUMBER && value.Type != Token::STRING)
+    {
+        SyntaxError(value, fmt::format("malformed '{}' function's variable '{}' syntax", function.Name, firstToken.Text));
+        return false;
+    }
 
-            continue;
-        }
+    //  Function call result assigned to a variable?
+    if (value.Type == Token::IDENTIFIER && lexer.Peek().Type == Token::LEFT_PARENTHESIS)
+    {
+        lexer.Next();
 
-        //  Is it condition statement?
-        if (currentTokenString.starts_with("if") && currentTokenString.find_first_of("(") != std::string::npos && currentTokenString.find_first_of(")") != std::string::npos)
-        {
-            ParserState.IsCondition = true;
+        std::vector<std::string> arguments;
+        if (!ParseCallArguments(lexer, arguments) || !ExpectLineEnd(lexer))
+            return false;
 
-            auto conditionStatement = currentTokenString.substr(currentTokenString.find_last_of("(") + 1);
-            conditionStatement = conditionStatement.substr(0, conditionStatement.find_first_of(")") - 1);
+        auto* call = new Scripting::FunctionCallStatement(std::string(value.Text), arguments);
+        call->ResultVariableName = firstToken.Text;
+        call->ResultVariableIndex = FindOrAddVariable(function, firstToken.Text, {});
+        call->Line = value.Line;
+        function.ControlFlow.emplace_back(call);
 
-            //  No condition statement?
-            if (!conditionStatement.length())
-            {
-                Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: function's '{}' condition statement is missing it's body.", ParserState.Context.FunctionName);
-                ErrorsFound++;
-                return;
-            }
+        return true;
+    }
 
-            auto currentFunction = std::find_if(Functions.begin(), Functions.end(), [&](const Scripting::FunctionDefinition& f) { return ParserState.Context.FunctionName == f.Name; });
+    if (!ExpectLineEnd(lexer))
+        return false;
 
-            //currentFunction->ControlFlow.push_back({ Scripting::ControlFlowElement::CONDITION_START, (size_t)-1 });
+    const size_t variableIndex = FindOrAddVariable(function, firstToken.Text, value.Text);
+    function.ControlFlow.emplace_back(new Scripting::AssignmentStatement(std::string(firstToken.Text), variableIndex, std::string(value.Text)));
 
-            continue;
+    return true;
+}
+
+bool ScriptAsset::ParseCondition(Scripting::Lexer& lexer, Scripting::FunctionDefinition& function)
+{
+    const Token openingParenthesis = lexer.Next();
+    if (openingParenthesis.Type != Token::LEFT_PARENTHESIS)
+    {
+        SyntaxError(openingParenthesis, fmt::format("function's '{}' condition statement is missing it's body", function.Name));
+        return false;
+    }
+
+    const auto IsOperand = [](const Token& token) { return token.Type == Token::IDENTIFIER || token.Type == Token::NUMBER || token.Type == Token::STRING; };
+
+    //  Nothing is added to the function until the whole condition is read.
+    std::vector<std::unique_ptr<Scripting::ControlFlowElement>> conditionElements;
+    conditionElements.emplace_back(new Scripting::ConditionStatement(Scripting::ControlFlowElement::CONDITION_START));
+
+    //  Every comparison can be in parentheses of it's own, i.e. 'if ((a > 1) && (b < 2))'.
+    while (true)
+    {
+        const bool hasParentheses = lexer.Peek().Type == Token::LEFT_PARENTHESIS;
+        if (hasParentheses)
+            lexer.Next();
+
+        const Token leftHandSide = lexer.Next();
+        if (!IsOperand(leftHandSide))
+        {
+            SyntaxError(leftHandSide, fmt::format("unexpected '{}' in function's '{}' condition", leftHandSide.Text, function.Name));
+            return false;
         }
 
-        //  Condition statement ends?
-        if (currentTokenString.starts_with("endif") && ParserState.IsCondition && ParserState.IsFunctionBody)
+        auto conditionType = Scripting::ConditionStatement::CONDITION_TYPE_NONE;
+        switch (lexer.Peek().Type)
         {
-            ParserState.IsCondition = false;
+        case Token::EQUALS:
+            conditionType = Scripting::ConditionStatement::CONDITION_TYPE_EQUALS;
+            break;
+        case Token::NOT_EQUALS:
+            conditionType = Scripting::ConditionStatement::CONDITION_TYPE_NOT_EQUALS;
+            break;
+        case Token::LESS_THAN:
+            conditionType = Scripting::ConditionStatement::CONDITION_TYPE_LESS_THAN;
+            break;
+        case Token::GREATER_THAN:
+            conditionType = Scripting::ConditionStatement::CONDITION_TYPE_GREATER_THAN;
+            break;
+        case Token::LESS_OR_EQUAL:
+            conditionType = Scripting::ConditionStatement::CONDITION_TYPE_LESSOREQUAL_THAN;
+            break;
+        case Token::GREATER_OR_EQUAL:
+            conditionType = Scripting::ConditionStatement::CONDITION_TYPE_GREATEROREQUAL_THAN;
+            break;
+        default:
+            break;
+        }
 
-            auto currentFunction = std::find_if(Functions.begin(), Functions.end(), [&](const Scripting::FunctionDefinition& f) { return ParserState.Context.FunctionName == f.Name; });
+        Token rightHandSide = {};
+        if (conditionType != Scripting::ConditionStatement::CONDITION_TYPE_NONE)
+        {
+            lexer.Next();
+            rightHandSide = lexer.Next();
+            if (!IsOperand(rightHandSide))
+            {
+                SyntaxError(rightHandSide, fmt::format("unexpected '{}' in function's '{}' condition", rightHandSide.Text, function.Name));
+                return false;
+            }
+        }
 
-            auto item = new Scripting::ConditionStatement(Scripting::ControlFlowElement::CONDITION_END);
-            currentFunction->ControlFlow.push_back(item);
+        conditionElements.emplace_back(new Scripting::ConditionStatement(conditionType, std::string(leftHandSide.Text), std::string(rightHandSide.Text)));
 
-            continue;
+        if (hasParentheses && lexer.Next().Type != Token::RIGHT_PARENTHESIS)
+        {
+            SyntaxError(leftHandSide, fmt::format("unclosed parenthesis in function's '{}' condition", function.Name));
+            return false;
         }
 
-        //  Assignment operator?
-        if (currentTokenString.find_first_of("=") != std::string::npos)
-        {
-            const auto equalsOpPos = currentTokenString.find_first_of('=');
+        const Token::eTokenType relationType = lexer.Peek().Type;
+        if (relationType != Token::LOGICAL_AND && relationType != Token::LOGICAL_OR)
+            break;
 
-            auto varName = currentTokenString.substr(0, equalsOpPos);
-            ReplaceStringInPlace(varName, " ", "");
+        lexer.Next();
+        conditionElements.emplace_back(new Scripting::ConditionRelationStatement(relationType == Token::LOGICAL_AND ?
+            Scripting::ConditionRelationStatement::CONDITION_OPERATOR_LOGICAL_AND : Scripting::ConditionRelationStatement::CONDITION_OPERATOR_LOGICAL_OR));
+    }
 
-            auto varRightSide = currentTokenString.substr(equalsOpPos + 1);
-            ReplaceStringInPlace(varRightSide, " ", "");
+    const Token closingParenthesis = lexer.Next();
+    if (closingParenthesis.Type != Token::RIGHT_PARENTHESIS)
+    {
+        SyntaxError(closingParenthesis, fmt::format("unclosed parenthesis in function's '{}' condition", function.Name));
+        return false;
+    }
 
-            auto currentFunction = std::find_if(Functions.begin(), Functions.end(), [&](const Scripting::FunctionDefinition& f) { return ParserState.Context.FunctionName == f.Name; });
+    if (!ExpectLineEnd(lexer))
+        return false;
 
-            if (!varName.length() || !varRightSide.length())
-            {
-                Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: malformed '{}' function's variable syntax.", currentFunction->Name);
-                ErrorsFound++;
-                return;
-            }
+    for (auto& element : conditionElements)
+        function.ControlFlow.push_back(std::move(element));
 
-            currentFunction->Variables.push_back({ varName, varRightSide });
+    return true;
+}
 
-            auto item = new Scripting::AssignmentStatement(varName, currentFunction->Variables.size() - 1, varRightSide);
-            currentFunction->ControlFlow.push_back(item);
+bool ScriptAsset::ParseCallArguments(Scripting::Lexer& lexer, std::vector<std::string>& arguments)
+{
+    if (lexer.Peek().Type == Token::RIGHT_PARENTHESIS)
+    {
+        lexer.Next();
+        return true;
+    }
 
-            continue;
+    for (size_t argumentIndex = 1;; argumentIndex++)
+    {
+        const Token argument = lexer.Next();
+        if (argument.Type != Token::IDENTIFIER && argument.Type != Token::NUMBER && argument.Type != Token::STRING)
+        {
+            SyntaxError(argument, fmt::format("unexpected '{}' as function call argument #{}", argument.Text, argumentIndex));
+            return false;
         }
 
-        //  None of the above. Unknown string.
-        Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: unknown token found '{}'.", currentTokenString);
-        ErrorsFound++;
+        arguments.emplace_back(argument.Text);
+
+        const Token separator = lexer.Next();
+        if (separator.Type == Token::RIGHT_PARENTHESIS)
+            return true;
+
+        if (separator.Type != Token::COMMA)
+        {
+            SyntaxError(separator, fmt::format("unexpected '{}' after function call argument #{}", separator.Text, argumentIndex));
+            return false;
+        }
     }
+}
 
-    Logger::TRACE(TAG_FUNCTION_NAME, "Found {} functions.", Functions.size());
+bool ScriptAsset::ExpectLineEnd(Scripting::Lexer& lexer)
+{
+    //  Line break is left for the caller, so the statement loop sees it.
+    const Token& token = lexer.Peek();
+    if (token.Type == Token::NEWLINE || token.Type == Token::END)
+        return true;
+
+    SyntaxError(token, fmt::format("unexpected '{}' at the end of statement", token.Text));
+    return false;
 }
+
+void ScriptAsset::SyntaxError(const Token& token, const std::string& message)
+{
+    Logger::ERROR(TAG_FUNCTION_NAME, "Syntax Parse Error: {} ('{}', line {}, column {}).", message, Name, token.Line, token.Column);
+    ErrorsFound++;
+}
+
+void ScriptAsset::SkipLine(Scripting::Lexer& lexer)
+{
+    if (lexer.GetLastTokenType() == Token::NEWLINE)
+        return;
+
+    while (lexer.Peek().Type != Token::NEWLINE && lexer.Peek().Type != Token::END)
+        lexer.Next();
+}
+
+size_t ScriptAsset::FindOrAddVariable(Scripting::FunctionDefinition& function, const std::string_view& name, const std::string_view& value)
+{
+    for (size_t index = 0; index < function.Variables.size(); index++)
+    {
+        if (function.Variables[index].Name == name)
+            return index;
+    }
+
+    function.Variables.push_back({ std::string(name), std::string(value) });
+    return function.Variables.size() - 1;
+}
\ No newline at end of file
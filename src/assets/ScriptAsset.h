@@ -1,5 +1,7 @@
 #pragma once
 #include "AssetInterface.h"
+#include "ScriptLexer.h"
+#include "Bytecode.h"
 
 namespace Scripting
 {
@@ -50,20 +52,24 @@ namespace Scripting
     //  Example: myFunction(arg1)
     //           ^^^^^^^^^^^^^^^^
     //          that's the statement.
-    //  Essentially, this describes a function call:
-    //  it's name, parsed arguments list and a global index to that function in Functions list.
+    //  Essentially, this describes a function call: it's name and parsed arguments list. What is called is only known once script is linked.
+    //  Arguments are kept as they are written, so string arguments still have their quotes.
     struct FunctionCallStatement : public ControlFlowElement
     {
         std::string     FunctionName;
         std::vector<std::string>    Arguments;
-        size_t          GlobalFunctionIndex;
+        //  Variable the result is assigned to, i.e. 'handle = GetEntityByName("Button")'. Empty if result is not used.
+        std::string     ResultVariableName;
+        size_t          ResultVariableIndex;
+        uint32_t        Line;
 
-        inline FunctionCallStatement(const std::string functionName, const std::vector<std::string> arguments, const size_t globalFunctionIndex)
+        inline FunctionCallStatement(const std::string functionName, const std::vector<std::string> arguments)
         {
             Type = FUNCTION_CALL;
             FunctionName = functionName;
             Arguments = arguments;
-            GlobalFunctionIndex = globalFunctionIndex;
+            ResultVariableIndex = 0;
+            Line = 0;
         }
     };
 
@@ -72,6 +78,7 @@ namespace Scripting
     //               ^^^^^^^^^
     //              that's the statement.
     //  There are Left Hand Side and Right Hand Side of the statement.
+    //  A body with 'CONDITION_TYPE_NONE' only has Left Hand Side, that has to be true, i.e. 'if (isVisible)'.
     struct ConditionStatement : public ControlFlowElement
     {
         enum tConditionType
@@ -119,47 +126,49 @@ namespace Scripting
             CONDITION_OPERATOR_LOGICAL_AND,
             CONDITION_OPERATOR_LOGICAL_OR,
         }               RelationType;
+
+        explicit inline ConditionRelationStatement(const ConditionOperator relationType)
+        {
+            Type = CONDITION_OPERATOR;
+            RelationType = relationType;
+        }
     };
 
     //  An actual function that script contains.
     //  This includes the function's name, arguments list, local variables and a control flow.
+    //  It's only what parser hands over to the compiler, script keeps the compiled bytecode (see 'CompiledScript').
     struct FunctionDefinition
     {
         std::string                     Name;
         std::vector<std::string>        Arguments;
         std::vector<VariableDefinition> Variables;
-        std::vector<ControlFlowElement*> ControlFlow;
-
-        //  FIXME: this will sometims cause a crash! Probably, something is left uninitialized...
-        ~FunctionDefinition()
-        {
-            if (ControlFlow.size())
-            {
-                for (size_t i = 0; i < ControlFlow.size(); i++)
-                {
-                    if (ControlFlow[i])
-                        delete ControlFlow[i];
-                }
-            }
-        }
-
-        FunctionDefinition()
-        {
-            Name = {};
-            Arguments = {};
-            Variables = {};
-            ControlFlow = {};
-        }
+        std::vector<std::unique_ptr<ControlFlowElement>>    ControlFlow;
     };
 };
 
 class ScriptAsset : public AssetInterface
 {
 protected:
+    //  Parsed functions, only kept until they are compiled.
     std::vector<Scripting::FunctionDefinition>     Functions;
+    Scripting::CompiledScript           Program;
     uint32_t                            ErrorsFound;
 
+    //  Parser, each method consumes the construct it's named after. Statement ends with the line break after it.
+    //  Returns false on syntax error, the rest of the line is left for the caller to skip.
+    bool            ParseFunction(Scripting::Lexer& lexer);
+    bool            ParseStatement(Scripting::Lexer& lexer, const Scripting::Token& firstToken, Scripting::FunctionDefinition& function, uint32_t& conditionDepth);
+    bool            ParseCondition(Scripting::Lexer& lexer, Scripting::FunctionDefinition& function);
+    bool            ParseCallArguments(Scripting::Lexer& lexer, std::vector<std::string>& arguments);
+    bool            ExpectLineEnd(Scripting::Lexer& lexer);
+    void            SyntaxError(const Scripting::Token& token, const std::string& message);
+
+    static void     SkipLine(Scripting::Lexer& lexer);
+    static size_t   FindOrAddVariable(Scripting::FunctionDefinition& function, const std::string_view& name, const std::string_view& value);
+
 public:
+    static constexpr eAssetType ClassAssetType = eAssetType::SCRIPT;
+
     ScriptAsset();
 
     virtual         ~ScriptAsset();
@@ -170,8 +179,8 @@ public:
         return ErrorsFound;
     }
 
-    inline const auto GetFunctions() const
+    inline const Scripting::CompiledScript& GetProgram() const
     {
-        return Functions;
+        return Program;
     }
 };
\ No newline at end of file
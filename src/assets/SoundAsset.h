@@ -5,6 +5,8 @@
 class SoundAsset : public AssetInterface
 {
 public:
+    static constexpr eAssetType ClassAssetType = eAssetType::SOUND;
+
     SoundAsset();
 
     virtual         ~SoundAsset();
@@ -1,8 +1,16 @@
 #include "TextAsset.h"
 #include "Logger.h"
 
+#include <bit>
+#include <algorithm>
+
 TextAsset::TextAsset()
 {
+    TextSlots = nullptr;
+    SlotsCount = 0;
+    TextPool = nullptr;
+    PoolSize = 0;
+    ValuesCount = 0;
 }
 
 TextAsset::~TextAsset()
@@ -11,34 +19,167 @@ TextAsset::~TextAsset()
 
 void TextAsset::ParseData(const uint8_t* data)
 {
-    //  TODO: replace with std::getline.
-    char* currentToken = nullptr;
+    if (IsCooked(data, DataSize))
+    {
+        if (!ParseCooked(data))
+            Logger::ERROR(TAG_FUNCTION_NAME, "Cooked text '{}' is damaged!", Name);
+
+        return;
+    }
 
-    currentToken = strtok((char*)data, "\n");
-    while (currentToken)
+    ParseText(data);
+}
+
+void TextAsset::ParseText(const uint8_t* data)
+{
+    //  The buffer is a read-only file mapping, so walk it line by line without modifying or copying anything.
+    const std::string_view buffer((const char*)data, data ? DataSize : 0);
+    TextPool = buffer.data();
+    PoolSize = buffer.size();
+
+    //  There can't be more values than lines, that's enough to size the table once and never grow it.
+    const size_t linesCount = std::count(buffer.begin(), buffer.end(), '\n') + 1;
+    ParsedSlots.assign(std::bit_ceil(linesCount * 2), { 0, EmptySlot, 0 });
+    TextSlots = ParsedSlots.data();
+    SlotsCount = ParsedSlots.size();
+    const size_t slotsMask = SlotsCount - 1;
+
+    size_t lineStart = 0;
+    while (lineStart < buffer.size())
     {
-        if (currentToken[0] != '#')
-        {
-            const size_t keyLength = strchr(currentToken, '=') - currentToken;
+        size_t lineEnd = buffer.find_first_of('\n', lineStart);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = buffer.size();
 
-            const HashType keyHash = xxh64::hash(currentToken, keyLength, 0);
-            const std::string value(currentToken + keyLength + 1);
+        std::string_view currentLine = buffer.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
 
-            TextValues.emplace(std::make_pair(keyHash, value));
+        if (currentLine.ends_with('\r'))
+            currentLine.remove_suffix(1);
+
+        if (currentLine.empty() || currentLine[0] == '#')
+            continue;
+
+        const size_t keyLength = currentLine.find_first_of('=');
+        if (keyLength == std::string_view::npos)
+        {
+            Logger::WARNING(TAG_FUNCTION_NAME, "Line without a value in '{}': \"{}\".", Name, currentLine);
+            continue;
         }
-        currentToken = strtok(nullptr, "\n");
+
+        const HashType keyHash = xxh64::hash(currentLine.data(), keyLength, 0);
+        const std::string_view value = currentLine.substr(keyLength + 1);
+
+        //  Linear probing. First value with the same key wins, same as it always did.
+        size_t slotIndex = keyHash & slotsMask;
+        while (ParsedSlots[slotIndex].ValueOffset != EmptySlot && ParsedSlots[slotIndex].KeyHash != keyHash)
+            slotIndex = (slotIndex + 1) & slotsMask;
+
+        if (ParsedSlots[slotIndex].ValueOffset != EmptySlot)
+            continue;
+
+        ParsedSlots[slotIndex] = { keyHash, (uint32_t)(value.data() - TextPool), (uint32_t)value.length() };
+        ValuesCount++;
+    }
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Read {} tokens.", ValuesCount);
+}
+
+bool TextAsset::ParseCooked(const uint8_t* data)
+{
+    const TextBinHeader* header = (const TextBinHeader*)data;
+
+    //  Table must be a power of two in size, aligned and fit in the file, values must fit in the file as well.
+    //  It must also have at least one empty slot, since that's where a lookup of a missing key stops.
+    if (!std::has_single_bit(header->SlotsCount) || header->ValuesCount >= header->SlotsCount ||
+        header->SlotsOffset % alignof(tTextSlot) || header->SlotsOffset > DataSize ||
+        header->SlotsCount > (DataSize - header->SlotsOffset) / sizeof(tTextSlot) ||
+        header->PoolOffset > DataSize || DataSize - header->PoolOffset > UINT32_MAX)
+        return false;
+
+    TextSlots = (const tTextSlot*)(data + header->SlotsOffset);
+    SlotsCount = header->SlotsCount;
+    TextPool = (const char*)data + header->PoolOffset;
+    PoolSize = DataSize - header->PoolOffset;
+    ValuesCount = header->ValuesCount;
+
+    //  Slots are not checked one by one, that'd mean touching every page of the table on load. A bad value is cut to the file end instead.
+    Logger::TRACE(TAG_FUNCTION_NAME, "Mapped {} cooked tokens.", ValuesCount);
+
+    return true;
+}
+
+bool TextAsset::RetainsData() const
+{
+    return true;
+}
+
+bool TextAsset::IsCooked(const uint8_t* data, const size_t size)
+{
+    if (!data || size < sizeof(TextBinHeader))
+        return false;
+
+    const TextBinHeader* header = (const TextBinHeader*)data;
+    return header->Magic == TextBinMagic && header->Version == TextBinVersion;
+}
+
+void TextAsset::Cook(std::vector<char>& cookedData) const
+{
+    const uint64_t slotsOffset = sizeof(TextBinHeader);
+    const uint64_t poolOffset = slotsOffset + SlotsCount * sizeof(tTextSlot);
+
+    cookedData.assign(poolOffset, 0);
+
+    //  Values are packed one after another, in slot order.
+    std::vector<tTextSlot> cookedSlots(TextSlots, TextSlots + SlotsCount);
+    for (auto& slot : cookedSlots)
+    {
+        if (slot.ValueOffset == EmptySlot)
+            continue;
+
+        const uint32_t cookedOffset = (uint32_t)(cookedData.size() - poolOffset);
+        cookedData.insert(cookedData.end(), TextPool + slot.ValueOffset, TextPool + slot.ValueOffset + slot.ValueLength);
+        slot.ValueOffset = cookedOffset;
     }
 
-    Logger::TRACE(TAG_FUNCTION_NAME, "Read {} tokens.", TextValues.size());
+    const TextBinHeader header = { TextBinMagic, TextBinVersion, ValuesCount, SlotsCount, slotsOffset, poolOffset };
+    memcpy(cookedData.data(), &header, sizeof(header));
+    memcpy(cookedData.data() + slotsOffset, cookedSlots.data(), cookedSlots.size() * sizeof(tTextSlot));
 }
 
-const std::string& TextAsset::GetKeyValue(const HashType keyHash) const
+const TextAsset::tTextSlot* TextAsset::FindSlot(const HashType keyHash) const
 {
-    return TextValues.at(keyHash);
+    if (!SlotsCount)
+        return nullptr;
+
+    //  Cooked table is not checked slot by slot, so even if it's damaged and has no empty slot, probing ends after going around once.
+    const size_t slotsMask = SlotsCount - 1;
+    size_t slotIndex = keyHash & slotsMask;
+    for (size_t probesCount = 0; probesCount < SlotsCount && TextSlots[slotIndex].ValueOffset != EmptySlot; probesCount++, slotIndex = (slotIndex + 1) & slotsMask)
+    {
+        if (TextSlots[slotIndex].KeyHash == keyHash)
+            return &TextSlots[slotIndex];
+    }
+
+    return nullptr;
 }
 
-const std::string& TextAsset::GetKeyValue(const std::string& key) const
+bool TextAsset::GetKeyValue(const HashType keyHash, std::string_view& value) const
 {
-    const HashType keyHash = xxh64::hash(key.c_str(), key.length(), 0);
-    return TextValues.at(keyHash);
-}
\ No newline at end of file
+    const tTextSlot* slot = FindSlot(keyHash);
+    if (!slot || slot->ValueOffset > PoolSize)
+        return false;
+
+    value = std::string_view(TextPool + slot->ValueOffset, std::min<size_t>(slot->ValueLength, PoolSize - slot->ValueOffset));
+    return true;
+}
+
+bool TextAsset::GetKeyValue(const TextKey key, std::string_view& value) const
+{
+    return GetKeyValue(key.Hash, value);
+}
+
+bool TextAsset::GetKeyValue(const std::string_view& key, std::string_view& value) const
+{
+    return GetKeyValue(xxh64::hash(key.data(), key.length(), 0), value);
+}
@@ -2,18 +2,90 @@
 
 #include "AssetInterface.h"
 
+//  Cooked text layout (usually '.textbin', but packer also cooks every text file it puts into an archive, keeping it's name):
+//      [TextBinHeader]
+//      [SlotsCount x tTextSlot]    the same open addressing table 'TextAsset' builds when it parses plain text, starts at 'SlotsOffset'.
+//      [UTF-8 values]              starts at 'PoolOffset', slot value offsets are relative to it.
+//  It's used right from the mapped file, nothing is parsed or copied.
+constexpr uint32_t  TextBinMagic = 0x5447544d;  //  'MTGT'
+constexpr uint32_t  TextBinVersion = 1;
+
+struct TextBinHeader
+{
+    uint32_t    Magic;
+    uint32_t    Version;
+    uint64_t    ValuesCount;
+    uint64_t    SlotsCount;
+    uint64_t    SlotsOffset;
+    uint64_t    PoolOffset;
+};
+
+//  A key for 'TextAsset::GetKeyValue', hashed at compile time: 'GetKeyValue(TextKey("MenuHeader"), value)'.
+//  It's explicit, so plain literals go to the 'std::string_view' overload instead of being ambiguous.
+struct TextKey
+{
+    HashType    Hash;
+
+    template <size_t N>
+    explicit consteval TextKey(const char (&key)[N])
+        : Hash(xxh64::hash(key, N - 1, 0))
+    {
+    }
+};
+
 class TextAsset : public AssetInterface
 {
-    std::unordered_map<HashType, std::string>   TextValues;
+    //  A slot of the open addressing table. Value is referenced by it's offset into the mapped file, which this asset retains.
+    //  This is also how slots are stored in cooked text, so the layout must not change.
+    struct tTextSlot
+    {
+        HashType    KeyHash;
+        uint32_t    ValueOffset;
+        uint32_t    ValueLength;
+    };
+
+    static_assert(sizeof(tTextSlot) == 16);
+
+    //  Marks a slot nobody has taken yet.
+    static constexpr uint32_t EmptySlot = UINT32_MAX;
+
+    //  Size is always a power of two and at least twice the number of values, so probing stays short.
+    //  Slots either point into 'ParsedSlots' or straight into the mapped cooked file.
+    const tTextSlot*        TextSlots;
+    size_t                  SlotsCount;
+    std::vector<tTextSlot>  ParsedSlots;
+    const char*             TextPool;
+    size_t                  PoolSize;
+    size_t                  ValuesCount;
+
+    const tTextSlot*        FindSlot(const HashType keyHash) const;
+
+    void            ParseText(const uint8_t* data);
+    bool            ParseCooked(const uint8_t* data);
 
 public:
+    static constexpr eAssetType ClassAssetType = eAssetType::TEXT;
+
     TextAsset();
 
     virtual         ~TextAsset();
     virtual void    ParseData(const uint8_t* data) override;
+    virtual bool    RetainsData() const override;
+
+    //  Get text value by hashed key. Returns false if there's no such key, 'value' is left untouched then.
+    bool            GetKeyValue(const HashType keyHash, std::string_view& value) const;
+    //  Get text value by key hashed at compile time.
+    bool            GetKeyValue(const TextKey key, std::string_view& value) const;
+    //  Get text value by key string, it's hashed on every call.
+    bool            GetKeyValue(const std::string_view& key, std::string_view& value) const;
+
+    inline const size_t GetValuesCount() const
+    {
+        return ValuesCount;
+    }
+
+    //  Write this asset's values out in cooked form. Only values are copied, comments and keys are not needed anymore.
+    void            Cook(std::vector<char>& cookedData) const;
 
-    //  Get text value by hashed key.
-    const std::string&  GetKeyValue(const HashType keyHash) const;
-    //  Get text value by key string.
-    const std::string&  GetKeyValue(const std::string& key) const;
-};
\ No newline at end of file
+    static bool     IsCooked(const uint8_t* data, const size_t size);
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include "Generic.h"
 
+#include <mutex>
+
 #if defined(WIN32)
 #define __func__ __FUNCTION__
 #endif
@@ -10,8 +12,13 @@
 class Logger {
 
 private:
+    //  Assets are loaded from several threads at once, this keeps each message in one piece.
+    static inline std::mutex OutputMutex;
+
     static void verror(fmt::string_view tag, fmt::string_view format, fmt::format_args args)
     {
+        std::lock_guard<std::mutex> lock(OutputMutex);
+
         fmt::print(fmt::emphasis::bold | fmt::fg(fmt::color::red), "[{}]: ", tag);
         fmt::vprint(format, args);
         fmt::print("\n");
@@ -23,6 +30,8 @@ private:
 
     static void vtrace(fmt::string_view tag, fmt::string_view format, fmt::format_args args)
     {
+        std::lock_guard<std::mutex> lock(OutputMutex);
+
         fmt::print(fmt::fg(fmt::color::green), "[{}]: ", tag);
         fmt::vprint(format, args);
         fmt::print("\n");
@@ -30,6 +39,8 @@ private:
 
     static void vwarning(fmt::string_view tag, fmt::string_view format, fmt::format_args args)
     {
+        std::lock_guard<std::mutex> lock(OutputMutex);
+
         fmt::print(fmt::fg(fmt::color::yellow), "[{}]: ", tag);
         fmt::vprint(format, args);
         fmt::print("\n");
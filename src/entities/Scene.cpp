@@ -8,6 +8,10 @@ std::vector<Node*> Scene::Nodes = {};
 
 void Scene::Update(const float_t timeDelta)
 {
+    //  Whatever was moved during last frame gets it's world position before anything looks at it.
+    if (SceneAsset* activeScene = SceneAsset::GetActive())
+        activeScene->UpdateTransforms();
+
     if (!Nodes.size())
         return;
 
@@ -20,6 +24,11 @@ void Scene::Update(const float_t timeDelta)
 
 void Scene::Render(SDL_Renderer* renderer, const float_t timeDelta)
 {
+    //  Active scene that is still being loaded a slice every frame shows how far along it is.
+    const SceneAsset* activeScene = SceneAsset::GetActive();
+    if (activeScene && activeScene->IsLoading())
+        RenderLoadProgress(renderer, activeScene->GetLoadProgress());
+
     if (!Nodes.size())
         return;
 
@@ -30,6 +39,22 @@ void Scene::Render(SDL_Renderer* renderer, const float_t timeDelta)
     }
 }
 
+void Scene::RenderLoadProgress(SDL_Renderer* renderer, const float_t progress)
+{
+    int outputWidth = 0;
+    int outputHeight = 0;
+    if (!SDL_GetCurrentRenderOutputSize(renderer, &outputWidth, &outputHeight))
+        return;
+
+    const float_t barHeight = 8.f;
+    const SDL_FRect frame = { outputWidth * 0.25f, outputHeight - barHeight * 4.f, outputWidth * 0.5f, barHeight };
+    const SDL_FRect fill = { frame.x, frame.y, frame.w * std::clamp(progress, 0.f, 1.f), frame.h };
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+    SDL_RenderRect(renderer, &frame);
+    SDL_RenderFillRect(renderer, &fill);
+}
+
 bool Scene::Init()
 {
     if (!SceneAsset::ActiveScene.empty())
@@ -13,6 +13,9 @@ private:
 
     static std::vector<Node*>   Nodes;
 
+    //  Bar along the bottom of the screen, 'progress' is from 0 to 1.
+    static void             RenderLoadProgress(SDL_Renderer* renderer, const float_t progress);
+
 public:
     Scene() = default;
 
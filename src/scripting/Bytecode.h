@@ -0,0 +1,137 @@
+#pragma once
+/*
+* File: Bytecode.h
+* Purpose: compiled form of a script, what the runtime actually runs.
+*/
+#include "Value.h"
+
+namespace Scripting
+{
+    //  Every instruction is 32 bits, in one of two layouts:
+    //      [ opcode 8 | A 8 | B 8 | C 8 ]
+    //      [ opcode 8 | A 8 | Bx 16     ]
+    //  A, B and C are registers, Bx is an index into one of the script tables or a jump target relative to the function start.
+    using Instruction = uint32_t;
+
+    enum eOpcode : uint8_t
+    {
+        OP_LOAD_CONSTANT = 0,   //  R[A] = Constants[Bx]
+        OP_LOAD_SELF,           //  R[A] = this
+        OP_MOVE,                //  R[A] = R[B]
+        OP_EQUAL,               //  R[A] = R[B] == R[C]
+        OP_NOT_EQUAL,           //  R[A] = R[B] != R[C]
+        OP_LESS,                //  R[A] = R[B] < R[C], 'greater than' is this with operands swapped
+        OP_LESS_OR_EQUAL,       //  R[A] = R[B] <= R[C]
+        OP_AND,                 //  R[A] = R[B] && R[C]
+        OP_OR,                  //  R[A] = R[B] || R[C]
+        OP_JUMP,                //  go to Bx
+        OP_JUMP_IF_FALSE,       //  go to Bx unless R[A] is true
+        OP_CALL,                //  call CallSites[Bx], arguments are R[A] and registers right after it
+        OP_CALL_NATIVE,         //  same, for calls linked to a native
+        OP_RETURN,
+
+        OP_COUNT
+    };
+
+    constexpr const char* OpcodeNames[OP_COUNT] =
+    {
+        "LOAD_CONSTANT",
+        "LOAD_SELF",
+        "MOVE",
+        "EQUAL",
+        "NOT_EQUAL",
+        "LESS",
+        "LESS_OR_EQUAL",
+        "AND",
+        "OR",
+        "JUMP",
+        "JUMP_IF_FALSE",
+        "CALL",
+        "CALL_NATIVE",
+        "RETURN"
+    };
+
+    constexpr inline Instruction EncodeInstruction(const eOpcode opcode, const uint8_t a, const uint8_t b, const uint8_t c)
+    {
+        return (Instruction)opcode | ((Instruction)a << 8) | ((Instruction)b << 16) | ((Instruction)c << 24);
+    }
+
+    constexpr inline Instruction EncodeInstruction(const eOpcode opcode, const uint8_t a, const uint16_t bx)
+    {
+        return (Instruction)opcode | ((Instruction)a << 8) | ((Instruction)bx << 16);
+    }
+
+    constexpr inline eOpcode GetOpcode(const Instruction instruction)
+    {
+        return (eOpcode)(instruction & 0xFF);
+    }
+
+    constexpr inline uint8_t GetA(const Instruction instruction)
+    {
+        return (uint8_t)(instruction >> 8);
+    }
+
+    constexpr inline uint8_t GetB(const Instruction instruction)
+    {
+        return (uint8_t)(instruction >> 16);
+    }
+
+    constexpr inline uint8_t GetC(const Instruction instruction)
+    {
+        return (uint8_t)(instruction >> 24);
+    }
+
+    constexpr inline uint16_t GetBx(const Instruction instruction)
+    {
+        return (uint16_t)(instruction >> 16);
+    }
+
+    //  Register value that means 'nowhere', i.e. call result nobody uses.
+    constexpr uint8_t   NoRegister = 0xFF;
+    //  Call site target before scripts are linked.
+    constexpr uint32_t  UnresolvedTarget = UINT32_MAX;
+
+    struct CallSite
+    {
+        //  Interned name of the function called.
+        uint32_t    NameId;
+        //  Index of the function in the same script, or of the native for 'OP_CALL_NATIVE'. 'UnresolvedTarget' until script is linked.
+        uint32_t    Target;
+        //  Where the call is in script source, for error messages.
+        uint32_t    Line;
+        uint8_t     ArgumentsCount;
+        uint8_t     ResultRegister;
+    };
+
+    struct CompiledFunction
+    {
+        uint32_t    NameId;
+        //  Range of 'CompiledScript::Code' function takes.
+        uint32_t    CodeOffset;
+        uint32_t    CodeSize;
+        //  Arguments take the first registers, variables come after them, temporaries after those.
+        uint8_t     ArgumentsCount;
+        uint8_t     RegistersCount;
+    };
+
+    //  All functions of a script share one code array and one constant pool, so running a script touches a few contiguous blocks and nothing else.
+    struct CompiledScript
+    {
+        std::vector<Instruction>        Code;
+        std::vector<Value>              Constants;
+        std::vector<CallSite>           CallSites;
+        std::vector<CompiledFunction>   Functions;
+
+        //  Returns nullptr if there's no function with this interned name.
+        inline const CompiledFunction*  FindFunction(const uint32_t nameId) const
+        {
+            for (const auto& function : Functions)
+            {
+                if (function.NameId == nameId)
+                    return &function;
+            }
+
+            return nullptr;
+        }
+    };
+}
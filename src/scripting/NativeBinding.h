@@ -0,0 +1,301 @@
+#pragma once
+/*
+* File: NativeBinding.h
+* Purpose: bind plain C++ functions to scripts. Argument and result conversion for each function is generated at compile time.
+*/
+#include "VirtualMachine.h"
+#include "StringTable.h"
+
+#include <optional>
+#include <tuple>
+#include <utility>
+
+class ScriptAsset;
+
+namespace Scripting
+{
+    //  Entity of the active scene, by it's index there.
+    struct Entity
+    {
+        static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+        uint32_t    Index;
+    };
+
+    //  Function of the script that passed it, i.e. an event handler.
+    struct FunctionReference
+    {
+        uint32_t    Index;
+    };
+
+    //  How a C++ type is passed between natives and scripts. 'Get' returns false if value is not of this type.
+    //  Types without a specialization can't be used by natives, that's a compile error.
+    template <typename T>
+    struct NativeType;
+
+    //  Any value, as it is.
+    template <>
+    struct NativeType<Value>
+    {
+        static constexpr const char* Name = "value";
+
+        static inline bool  Get(const Value& value, Value& output)
+        {
+            output = value;
+            return true;
+        }
+
+        static inline Value Make(const Value& value)
+        {
+            return value;
+        }
+    };
+
+    //  Every value is either true or false, so any type is accepted.
+    template <>
+    struct NativeType<bool>
+    {
+        static constexpr const char* Name = "boolean";
+
+        static inline bool  Get(const Value& value, bool& output)
+        {
+            output = value.IsTrue();
+            return true;
+        }
+
+        static inline Value Make(const bool boolean)
+        {
+            return Value::MakeBoolean(boolean);
+        }
+    };
+
+    template <typename T> requires (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+    struct NativeType<T>
+    {
+        static constexpr const char* Name = "number";
+
+        static inline bool  Get(const Value& value, T& output)
+        {
+            if (value.Type != Value::NUMBER)
+                return false;
+
+            output = (T)value.Number;
+            return true;
+        }
+
+        static inline Value Make(const T number)
+        {
+            return Value::MakeNumber((double)number);
+        }
+    };
+
+    //  Strings scripts pass are interned, so they stay valid after the call. Returned ones are interned too, that takes a lock.
+    template <>
+    struct NativeType<std::string_view>
+    {
+        static constexpr const char* Name = "string";
+
+        static inline bool  Get(const Value& value, std::string_view& output)
+        {
+            if (value.Type != Value::STRING)
+                return false;
+
+            output = value.GetString();
+            return true;
+        }
+
+        static inline Value Make(const std::string_view& string)
+        {
+            return Value::MakeString(StringTable::Get(StringTable::Intern(string)));
+        }
+    };
+
+    //  Returning entity with 'InvalidIndex' gives script 'nil'.
+    template <>
+    struct NativeType<Entity>
+    {
+        static constexpr const char* Name = "entity";
+
+        static inline bool  Get(const Value& value, Entity& output)
+        {
+            if (value.Type != Value::ENTITY)
+                return false;
+
+            output.Index = value.Index;
+            return true;
+        }
+
+        static inline Value Make(const Entity& entity)
+        {
+            return entity.Index != Entity::InvalidIndex ? Value::MakeIndex(Value::ENTITY, entity.Index) : Value();
+        }
+    };
+
+    template <>
+    struct NativeType<FunctionReference>
+    {
+        static constexpr const char* Name = "function";
+
+        static inline bool  Get(const Value& value, FunctionReference& output)
+        {
+            if (value.Type != Value::FUNCTION)
+                return false;
+
+            output.Index = value.Index;
+            return true;
+        }
+
+        static inline Value Make(const FunctionReference& function)
+        {
+            return Value::MakeIndex(Value::FUNCTION, function.Index);
+        }
+    };
+
+    template <>
+    struct NativeType<ScriptAsset*>
+    {
+        static constexpr const char* Name = "script";
+
+        static inline bool  Get(const Value& value, ScriptAsset*& output)
+        {
+            if (value.Type != Value::SCRIPT)
+                return false;
+
+            output = (ScriptAsset*)value.Object;
+            return true;
+        }
+
+        static inline Value Make(ScriptAsset* script)
+        {
+            return script ? Value::MakeObject(Value::SCRIPT, script) : Value();
+        }
+    };
+
+    //  'nil' is an empty optional. Optional arguments at the end of the list can be left out by scripts.
+    template <typename T>
+    struct NativeType<std::optional<T>>
+    {
+        static constexpr const char* Name = NativeType<T>::Name;
+
+        static inline bool  Get(const Value& value, std::optional<T>& output)
+        {
+            if (value.Type == Value::NIL)
+            {
+                output.reset();
+                return true;
+            }
+
+            return NativeType<T>::Get(value, output.emplace());
+        }
+
+        static inline Value Make(const std::optional<T>& optional)
+        {
+            return optional ? NativeType<T>::Make(*optional) : Value();
+        }
+    };
+
+    template <typename T>
+    constexpr bool IsOptionalArgument = false;
+
+    template <typename T>
+    constexpr bool IsOptionalArgument<std::optional<T>> = true;
+
+    //  Script arguments of a native, 'VirtualMachine&' in front is not one of them.
+    template <typename Function>
+    struct NativeSignature;
+
+    template <typename Result, typename... Arguments>
+    struct NativeSignature<Result (*)(Arguments...)>
+    {
+        using ResultType = Result;
+        using ArgumentsTuple = std::tuple<std::decay_t<Arguments>...>;
+
+        static constexpr bool   TakesMachine = false;
+        static constexpr size_t ArgumentsCount = sizeof...(Arguments);
+    };
+
+    //  Natives that take the machine can fail, by setting an error with 'VirtualMachine::SetError'.
+    template <typename Result, typename... Arguments>
+    struct NativeSignature<Result (*)(VirtualMachine&, Arguments...)> : public NativeSignature<Result (*)(Arguments...)>
+    {
+        static constexpr bool   TakesMachine = true;
+    };
+
+    template <typename... Arguments>
+    constexpr size_t GetRequiredArgumentsCount(std::tuple<Arguments...>*)
+    {
+        constexpr bool isOptional[] = { IsOptionalArgument<Arguments>..., false };
+
+        size_t requiredCount = sizeof...(Arguments);
+        while (requiredCount && isOptional[requiredCount - 1])
+            requiredCount--;
+
+        return requiredCount;
+    }
+
+    //  Calls 'Function' with arguments converted from registers and converts the result back. All of it is resolved at compile time,
+    //  so a call costs a type check per argument and the call itself.
+    template <auto Function>
+    class NativeBinding
+    {
+    private:
+        using Signature = NativeSignature<decltype(Function)>;
+        using ResultType = typename Signature::ResultType;
+
+        template <size_t Index, typename T>
+        static inline bool  GetArgument(VirtualMachine& machine, const Value* arguments, T& output)
+        {
+            if (NativeType<T>::Get(arguments[Index], output))
+                return true;
+
+            return machine.SetError(fmt::format("expected {} as argument #{}, got {}", NativeType<T>::Name, Index + 1, arguments[Index].GetTypeName()));
+        }
+
+        template <typename... Arguments>
+        static inline decltype(auto) Invoke(VirtualMachine& machine, Arguments&... arguments)
+        {
+            if constexpr (Signature::TakesMachine)
+                return Function(machine, arguments...);
+            else
+                return Function(arguments...);
+        }
+
+        template <size_t... Indices>
+        static inline bool  Call(VirtualMachine& machine, const Value* arguments, Value& result, std::index_sequence<Indices...>)
+        {
+            //  Arguments are converted before the call, so native is free to call back into the machine.
+            typename Signature::ArgumentsTuple values;
+            if (!(GetArgument<Indices>(machine, arguments, std::get<Indices>(values)) && ...))
+                return false;
+
+            if constexpr (std::is_void_v<ResultType>)
+                Invoke(machine, std::get<Indices>(values)...);
+            else
+                result = NativeType<std::decay_t<ResultType>>::Make(Invoke(machine, std::get<Indices>(values)...));
+
+            if constexpr (Signature::TakesMachine)
+                return !machine.TakeError();
+            else
+                return true;
+        }
+
+    public:
+        static constexpr uint8_t    ArgumentsCount = (uint8_t)Signature::ArgumentsCount;
+        static constexpr uint8_t    RequiredArgumentsCount = (uint8_t)GetRequiredArgumentsCount((typename Signature::ArgumentsTuple*)nullptr);
+
+        static_assert(Signature::ArgumentsCount < NoRegister, "Native takes more arguments than there are registers!");
+
+        static bool         Call(VirtualMachine& machine, const Value* arguments, Value& result)
+        {
+            return Call(machine, arguments, result, std::make_index_sequence<Signature::ArgumentsCount>());
+        }
+    };
+
+    //  Registers 'Function' under 'name', i.e. 'RegisterNative<&GetEntityByName>("GetEntityByName")'.
+    template <auto Function>
+    inline bool RegisterNative(const std::string_view& name)
+    {
+        using Binding = NativeBinding<Function>;
+        return Natives::Register(name, &Binding::Call, Binding::RequiredArgumentsCount, Binding::ArgumentsCount);
+    }
+}
@@ -0,0 +1,39 @@
+#include "Natives.h"
+#include "Bytecode.h"
+#include "StringTable.h"
+#include "Logger.h"
+
+namespace Scripting
+{
+    std::vector<NativeDefinition> Natives::Definitions;
+
+    bool Natives::Register(const std::string_view& name, const NativeFunction function, const uint8_t minimumArgumentsCount, const uint8_t maximumArgumentsCount)
+    {
+        const uint32_t nameId = StringTable::Intern(name);
+        if (Find(nameId) != UnresolvedTarget)
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Native '{}' is already registered!", name);
+            return false;
+        }
+
+        if (minimumArgumentsCount > maximumArgumentsCount || maximumArgumentsCount >= NoRegister)
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Native '{}' has invalid arguments count ({} to {})!", name, minimumArgumentsCount, maximumArgumentsCount);
+            return false;
+        }
+
+        Definitions.push_back({ nameId, function, minimumArgumentsCount, maximumArgumentsCount });
+        return true;
+    }
+
+    uint32_t Natives::Find(const uint32_t nameId)
+    {
+        for (size_t index = 0; index < Definitions.size(); index++)
+        {
+            if (Definitions[index].NameId == nameId)
+                return (uint32_t)index;
+        }
+
+        return UnresolvedTarget;
+    }
+}
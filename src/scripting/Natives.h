@@ -0,0 +1,43 @@
+#pragma once
+/*
+* File: Natives.h
+* Purpose: engine functions scripts can call.
+*/
+#include "Value.h"
+
+namespace Scripting
+{
+    class VirtualMachine;
+
+    //  Arguments are the caller's registers, there are always as many as native accepts, trailing ones not passed are 'nil'.
+    //  Calling back into the machine may overwrite them, so they have to be read before that.
+    //  Returns false on error, after setting it with 'VirtualMachine::SetError'.
+    using NativeFunction = bool (*)(VirtualMachine& machine, const Value* arguments, Value& result);
+
+    struct NativeDefinition
+    {
+        uint32_t        NameId;
+        NativeFunction  Function;
+        //  Calls with less arguments than 'MaximumArgumentsCount' get the rest as 'nil'.
+        uint8_t         MinimumArgumentsCount;
+        uint8_t         MaximumArgumentsCount;
+    };
+
+    //  Natives are registered once, before any script is loaded, linked scripts refer to them by index after that.
+    //  Engine functions are bound with 'RegisterNative' (see NativeBinding.h), which generates the 'NativeFunction' for them.
+    class Natives
+    {
+    private:
+        static std::vector<NativeDefinition>    Definitions;
+
+    public:
+        static bool     Register(const std::string_view& name, const NativeFunction function, const uint8_t minimumArgumentsCount, const uint8_t maximumArgumentsCount);
+        //  Returns 'UnresolvedTarget' if there's no native with this interned name.
+        static uint32_t Find(const uint32_t nameId);
+
+        static inline const NativeDefinition& Get(const uint32_t index)
+        {
+            return Definitions[index];
+        }
+    };
+}
@@ -1,18 +1,40 @@
 #include "Runtime.h"
 #include "SceneAsset.h"
 #include "ScriptAsset.h"
+#include "StringTable.h"
+#include "Loader.h"
 #include "Logger.h"
 
 namespace Scripting
 {
 
+    VirtualMachine Runtime::Machine;
+    std::vector<Runtime::tScriptInstance> Runtime::Scripts;
     std::string Runtime::LastError;
+    std::string Runtime::NextScene;
 
     //  An instance of a scripting engine expects active scene to have at least one script loaded.
     //  Script execution begins within 'main' function.
-    //  If 'update' function is present, the it'll be called each frame.
-    //  At the very start of execution, the engine will 'call' main function and try to read it's control flow.
-    //  The function's control flow is a simple list of statements to be executed.
+    //  If 'update' function is present, then it'll be called each frame, with frame time delta as it's argument.
+    //  All scripts share one virtual machine, so they all run on the main thread one after another.
+
+    /// <summary>
+    /// Register engine functions scripts can call.
+    /// </summary>
+    /// <returns>Were all of them registered.</returns>
+    bool Runtime::Init()
+    {
+        bool registered = true;
+        registered &= RegisterNative<&GetEntityByName>("GetEntityByName");
+        registered &= RegisterNative<&AddEvent>("AddEvent");
+        registered &= RegisterNative<&FadeOut>("FadeOut");
+        registered &= RegisterNative<&Unload>("Unload");
+        registered &= RegisterNative<&StartScript>("StartScript");
+        registered &= RegisterNative<&PrefetchScene>("PrefetchScene");
+        registered &= RegisterNative<&SwitchScene>("SwitchScene");
+
+        return registered;
+    }
 
     /// <summary>
     /// Begin execution of a scripts for the current scene.
@@ -27,14 +49,16 @@ namespace Scripting
             return false;
         }
 
-        const auto sceneRefIterator = std::find_if(SceneAsset::ScenesList.cbegin(), SceneAsset::ScenesList.cend(), [&](SceneAsset* const scene) { return scene->GetName() == SceneAsset::ActiveScene; });
-        if (sceneRefIterator == SceneAsset::ScenesList.end())
+        const auto scene = SceneAsset::GetActive();
+        if (!scene)
         {
             Logger::ERROR(TAG_FUNCTION_NAME, "Active scene is not in loaded scenes list!");
             return false;
         }
 
-        const auto scene = *sceneRefIterator;
+        //  Scripts of the previous scene are not updated anymore.
+        Scripts.clear();
+
         const auto sceneScripts = scene->GetScripts();
         if (!sceneScripts.size())
         {
@@ -45,11 +69,17 @@ namespace Scripting
         //  Run through all scene scripts and execute 'main' function.
         for (const auto& script : sceneScripts)
         {
-            auto& thisScript = script.Asset->CastTo<ScriptAsset>();
-            const auto executionResult = RunScript(thisScript);
+            auto* thisScript = script.Asset->As<ScriptAsset>();
+            if (!thisScript)
+                continue;
+
+            //  Scene holds it's scripts, so they are resident.
+            AddScript(AssetCache::Find(thisScript->GetNameHash()));
+
+            const auto executionResult = RunScript(*thisScript);
             if (!executionResult)
             {
-                Logger::ERROR(TAG_FUNCTION_NAME, "Script Runtime Error: failed to run script's '{}' main function in scene '{}'.", thisScript.GetName(), scene->GetName());
+                Logger::ERROR(TAG_FUNCTION_NAME, "Script Runtime Error: failed to run script's '{}' main function in scene '{}'.", thisScript->GetName(), scene->GetName());
                 if (LastError.length())
                 {
                     Logger::ERROR(TAG_FUNCTION_NAME, "Script Runtime Error Description: ");
@@ -63,6 +93,8 @@ namespace Scripting
 
     void Runtime::Stop()
     {
+        Scripts.clear();
+        NextScene.clear();
         Logger::TRACE(TAG_FUNCTION_NAME, "Runtime has stopped.");
     }
 
@@ -72,7 +104,73 @@ namespace Scripting
     /// <param name="delta">A time delta</param>
     void Runtime::Update(const float_t delta)
     {
-        //  TODO: core logic of script execution.
+        const Value arguments[] = { Value::MakeNumber(delta) };
+
+        //  Scripts may start other scripts while being updated, so list can grow as it's walked.
+        for (size_t index = 0; index < Scripts.size(); index++)
+        {
+            const tScriptInstance instance = Scripts[index];
+            if (!instance.UpdateFunction)
+                continue;
+
+            ScriptAsset& script = instance.Script->CastTo<ScriptAsset>();
+            if (Machine.Call(script.GetProgram(), *instance.UpdateFunction, Value::MakeObject(Value::SCRIPT, &script), arguments))
+                continue;
+
+            //  Same error would come up every frame, so script's 'update' is not called again, until it's reloaded.
+            Logger::ERROR(TAG_FUNCTION_NAME, "Script Runtime Error: {} (script '{}', function 'update'). Script won't be updated anymore.", Machine.GetLastError(), script.GetName());
+            Scripts[index].UpdateFunction = nullptr;
+        }
+
+        //  Switching scenes replaces the scripts, so it can't happen while they are being walked.
+        if (NextScene.empty())
+            return;
+
+        const std::string sceneName = std::move(NextScene);
+        NextScene.clear();
+        if (!SceneAsset::SetActive(sceneName))
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Can't switch to scene '{}', previous one stays active.", sceneName);
+            return;
+        }
+
+        Start();
+    }
+
+    void Runtime::OnScriptReloaded(const AssetRef& previousScript, const AssetRef& script)
+    {
+        static const uint32_t updateNameId = StringTable::Intern("update");
+
+        for (auto& instance : Scripts)
+        {
+            if (instance.Script != previousScript)
+                continue;
+
+            instance.Script = script;
+            instance.UpdateFunction = instance.IsUnloaded ? nullptr : script->CastTo<ScriptAsset>().GetProgram().FindFunction(updateNameId);
+        }
+    }
+
+    void Runtime::AddScript(const AssetRef& script)
+    {
+        static const uint32_t updateNameId = StringTable::Intern("update");
+        const CompiledFunction* updateFunction = script->CastTo<ScriptAsset>().GetProgram().FindFunction(updateNameId);
+
+        for (auto& instance : Scripts)
+        {
+            if (instance.Script != script)
+                continue;
+
+            if (instance.IsUnloaded)
+            {
+                instance.UpdateFunction = updateFunction;
+                instance.IsUnloaded = false;
+            }
+
+            return;
+        }
+
+        Scripts.push_back({ script, updateFunction, false });
     }
 
     /// <summary>
@@ -83,10 +181,13 @@ namespace Scripting
     /// </summary>
     /// <param name="script">A script to be executed</param>
     /// <param name="functionName">Optional function name that script has, to be executed, instead of main function</param>
-    bool Runtime::RunScript(ScriptAsset& script, const std::string& functionName)
+    /// <param name="arguments">Arguments function is called with</param>
+    bool Runtime::RunScript(ScriptAsset& script, const std::string& functionName, const std::span<const Value> arguments)
     {
+        const CompiledScript& program = script.GetProgram();
+
         //  There were no functions in this script at all.
-        if (!script.GetFunctions().size())
+        if (!program.Functions.size())
         {
             LastError = "Script '";
             LastError += script.GetName();
@@ -95,8 +196,8 @@ namespace Scripting
             return false;
         }
 
-        const auto functionDataRef = std::find_if(script.GetFunctions().cbegin(), script.GetFunctions().cend(), [&](const FunctionDefinition& func) { return func.Name == functionName; });
-        if (functionDataRef == script.GetFunctions().end())
+        const CompiledFunction* function = program.FindFunction(StringTable::Intern(functionName));
+        if (!function)
         {
             LastError = "Function '";
             LastError += functionName;
@@ -105,23 +206,85 @@ namespace Scripting
             return false;
         }
 
-        Logger::TRACE(TAG_FUNCTION_NAME, "Script '{}' control flow: ", script.GetName());
-        constexpr char ControlFlowElementTypeString[][21] = {
-            "VARIABLE_ASSIGNMENT",
-            "FUNCTION_CALL",
-            "CONDITION_START",
-            "CONDITION_BODY",
-            "CONDITION_END",
-        };
-
-        size_t itemIndex = 0;
-        for (const auto item : functionDataRef->ControlFlow)
+        if (!Machine.Call(program, *function, Value::MakeObject(Value::SCRIPT, &script), arguments))
         {
-            Logger::TRACE(TAG_FUNCTION_NAME, "#{}, Type: {}", itemIndex, ControlFlowElementTypeString[item->Type - 1]);
-            itemIndex++;
+            LastError = Machine.GetLastError();
+            return false;
         }
 
-        return false;
+        return true;
+    }
+
+    //  GetEntityByName(name), entity of the active scene, 'nil' if there's none. Entities of prefab instances are found as 'Instance/Entity'.
+    Entity Runtime::GetEntityByName(const std::string_view name)
+    {
+        const SceneAsset* scene = SceneAsset::GetActive();
+        return { scene ? scene->FindEntityByName(name) : Entity::InvalidIndex };
+    }
+
+    //  AddEvent(entity, event, handler), entity is 'nil' when script looked up one that's not there.
+    void Runtime::AddEvent(const std::optional<Entity> entity, const std::string_view event, const FunctionReference handler)
+    {
+        //  TODO: there are no entity events yet, handler is never called.
+        Logger::WARNING(TAG_FUNCTION_NAME, "Entity events are not supported yet, '{}' handler is ignored.", event);
+    }
+
+    //  FadeOut(duration), in milliseconds.
+    void Runtime::FadeOut(const double duration)
+    {
+        //  TODO: screen transitions.
+        Logger::WARNING(TAG_FUNCTION_NAME, "Screen fade is not supported yet.");
+    }
+
+    //  Unload(script), script is not updated anymore.
+    void Runtime::Unload(ScriptAsset* script)
+    {
+        for (auto& instance : Scripts)
+        {
+            if (instance.Script.get() != script)
+                continue;
+
+            instance.UpdateFunction = nullptr;
+            instance.IsUnloaded = true;
+        }
+    }
+
+    //  StartScript(path, [argument]), path is an asset path with optional function name after it, i.e. 'script:transition/levelload.script/LoadLevel'.
+    //  Function is 'main' if it's not given. Script is updated from now on, if it has 'update' function.
+    void Runtime::StartScript(VirtualMachine& machine, std::string_view path, const std::optional<Value> argument)
+    {
+        std::string functionName = "main";
+        const size_t separatorPosition = path.rfind('/');
+        if (separatorPosition != std::string_view::npos && path.find('.', separatorPosition) == std::string_view::npos)
+        {
+            functionName = path.substr(separatorPosition + 1);
+            path = path.substr(0, separatorPosition);
+        }
+
+        const AssetRef asset = AssetLoader::LoadAsset(std::string(path));
+        ScriptAsset* script = asset ? asset->As<ScriptAsset>() : nullptr;
+        if (!script)
+        {
+            machine.SetError(fmt::format("can't load script '{}'", path));
+            return;
+        }
+
+        AddScript(asset);
+
+        if (!RunScript(*script, functionName, argument ? std::span<const Value>(&*argument, 1) : std::span<const Value>()))
+            machine.SetError(fmt::format("script '{}' failed: {}", path, LastError));
+    }
+
+    //  PrefetchScene(name), start loading scene (i.e. 'level01.scene') in the background, so switching to it later doesn't stall.
+    void Runtime::PrefetchScene(const std::string_view sceneName)
+    {
+        SceneAsset::Prefetch(std::string(sceneName));
+    }
+
+    //  SwitchScene(name), make it the active scene at the end of this frame and start it's scripts. Prefetched scene is only waited for if it's not done yet.
+    void Runtime::SwitchScene(const std::string_view sceneName)
+    {
+        NextScene = sceneName;
     }
 
 }
\ No newline at end of file
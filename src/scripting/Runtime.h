@@ -2,6 +2,7 @@
 
 #include "Generic.h"
 #include "ScriptAsset.h"
+#include "NativeBinding.h"
 
 namespace Scripting
 {
@@ -10,15 +11,44 @@ namespace Scripting
     class Runtime
     {
     protected:
-        static std::vector<uint32_t>    LoadedScripts;
+        struct tScriptInstance
+        {
+            //  Held here, so script started by another one stays loaded, and one that's reloaded stays alive until it's swapped.
+            AssetRef                    Script;
+            //  Looked up once at start, so frames don't search functions by name. nullptr if script has no 'update'.
+            const CompiledFunction*     UpdateFunction;
+            //  Script asked for this one to not be updated anymore, it's not resumed on reload.
+            bool                        IsUnloaded;
+        };
+
+        static VirtualMachine           Machine;
+        static std::vector<tScriptInstance> Scripts;
         static std::string              LastError;
+        //  Scene 'SwitchScene' asked for, it's made active once every script is done with this frame.
+        static std::string              NextScene;
+
+        //  Script that's running already is not added again, it's 'update' still runs once a frame. Unloaded one is updated again.
+        static void         AddScript(const AssetRef& script);
+        static bool         RunScript(ScriptAsset& script, const std::string& functionName = "main", const std::span<const Value> arguments = {});
 
-        static bool         RunScript(ScriptAsset& script, const std::string& functionName = "main");
+        //  Natives, registered in 'Init'.
+        static Entity       GetEntityByName(const std::string_view name);
+        static void         AddEvent(const std::optional<Entity> entity, const std::string_view event, const FunctionReference handler);
+        static void         FadeOut(const double duration);
+        static void         Unload(ScriptAsset* script);
+        static void         StartScript(VirtualMachine& machine, std::string_view path, const std::optional<Value> argument);
+        static void         PrefetchScene(const std::string_view sceneName);
+        static void         SwitchScene(const std::string_view sceneName);
 
     public:
+        //  Scripts are linked as they are loaded, so this has to be done before any of them are.
+        static bool         Init();
         static bool         Start();
         static void         Stop();
         static void         Update(const float_t delta);
+
+        //  Instances of 'previousScript' are moved over to 'script' and get it's 'update', so next frame runs the new program.
+        static void         OnScriptReloaded(const AssetRef& previousScript, const AssetRef& script);
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,344 @@
+#include "ScriptCompiler.h"
+#include "StringTable.h"
+#include "Logger.h"
+
+#include <charconv>
+#include <cstring>
+
+namespace Scripting
+{
+    //  'NoRegister' is reserved, so that's one register less than a byte can address.
+    static constexpr uint32_t MaxRegisters = NoRegister;
+
+    Compiler::Compiler(CompiledScript& script, const std::string_view& scriptName) : Script(script)
+    {
+        ScriptName = scriptName;
+        ErrorsFound = 0;
+        Function = nullptr;
+        Compiled = {};
+        NextTemporary = 0;
+        RegistersUsed = 0;
+        IsInCondition = false;
+        ConditionRegister = NoRegister;
+        ConditionRelation = OP_AND;
+    }
+
+    void Compiler::Error(const std::string& message)
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Script Compile Error: {} (script '{}', function '{}').", message, ScriptName, Function ? Function->Name : std::string());
+        ErrorsFound++;
+    }
+
+    void Compiler::Emit(const Instruction instruction)
+    {
+        Script.Code.push_back(instruction);
+    }
+
+    uint8_t Compiler::FindLocal(const std::string_view& name) const
+    {
+        //  Every operand is looked up here, literals included, so nothing is interned. Names of locals are, when they are declared.
+        const uint32_t nameId = StringTable::Find(name);
+        if (nameId == StringTable::InvalidId)
+            return NoRegister;
+
+        for (size_t index = 0; index < Locals.size(); index++)
+        {
+            if (Locals[index] == nameId)
+                return (uint8_t)index;
+        }
+
+        return NoRegister;
+    }
+
+    uint8_t Compiler::AllocateTemporary()
+    {
+        if (NextTemporary >= MaxRegisters)
+        {
+            Error("statement needs more registers than there are");
+            return 0;
+        }
+
+        const uint8_t temporary = (uint8_t)NextTemporary++;
+        RegistersUsed = std::max(RegistersUsed, NextTemporary);
+
+        return temporary;
+    }
+
+    uint16_t Compiler::AddConstant(const Value& value)
+    {
+        uint64_t contents = 0;
+        static_assert(sizeof(contents) == sizeof(value.Number));
+        memcpy(&contents, &value.Number, sizeof(contents));
+
+        //  Interned strings are told apart by pointer, all other types fit in the union.
+        const auto key = std::make_pair((uint8_t)value.Type, contents);
+        const auto entry = ConstantsIndex.find(key);
+        if (entry != ConstantsIndex.end())
+            return entry->second;
+
+        if (Script.Constants.size() > UINT16_MAX)
+        {
+            Error("too many constants");
+            return 0;
+        }
+
+        const uint16_t constantIndex = (uint16_t)Script.Constants.size();
+        Script.Constants.push_back(value);
+        ConstantsIndex.emplace(key, constantIndex);
+
+        return constantIndex;
+    }
+
+    Value Compiler::MakeConstant(const std::string_view& operand)
+    {
+        if (operand.length() >= 2 && operand.front() == '"')
+        {
+            const uint32_t stringId = StringTable::Intern(operand.substr(1, operand.length() - 2));
+            return Value::MakeString(StringTable::Get(stringId));
+        }
+
+        if (operand.front() == '-' || (operand.front() >= '0' && operand.front() <= '9'))
+        {
+            double number = 0.0;
+            const auto result = std::from_chars(operand.data(), operand.data() + operand.length(), number);
+            if (result.ec != std::errc() || result.ptr != operand.data() + operand.length())
+                Error(fmt::format("malformed number '{}'", operand));
+
+            return Value::MakeNumber(number);
+        }
+
+        if (operand == "true" || operand == "false")
+            return Value::MakeBoolean(operand == "true");
+
+        if (operand == "nil")
+            return {};
+
+        //  Anything else is a name of something outside of this function, linking figures out what it is.
+        return Value::MakeIndex(Value::NAME, StringTable::Intern(operand));
+    }
+
+    uint8_t Compiler::LoadOperand(const std::string_view& operand, const uint8_t target)
+    {
+        const uint8_t local = FindLocal(operand);
+        if (local != NoRegister)
+        {
+            if (target == NoRegister || target == local)
+                return local;
+
+            Emit(EncodeInstruction(OP_MOVE, target, local, 0));
+            return target;
+        }
+
+        const uint8_t destination = target != NoRegister ? target : AllocateTemporary();
+        if (operand == "this")
+            Emit(EncodeInstruction(OP_LOAD_SELF, destination, 0, 0));
+        else
+            Emit(EncodeInstruction(OP_LOAD_CONSTANT, destination, AddConstant(MakeConstant(operand))));
+
+        return destination;
+    }
+
+    void Compiler::CompileCall(const FunctionCallStatement& call)
+    {
+        if (call.Arguments.size() >= MaxRegisters)
+        {
+            Error(fmt::format("too many arguments in call to '{}'", call.FunctionName));
+            return;
+        }
+
+        //  Arguments go into consecutive registers, first one is passed to the call.
+        uint8_t firstArgument = 0;
+        for (size_t index = 0; index < call.Arguments.size(); index++)
+        {
+            const uint8_t argumentRegister = AllocateTemporary();
+            if (!index)
+                firstArgument = argumentRegister;
+
+            LoadOperand(call.Arguments[index], argumentRegister);
+        }
+
+        if (Script.CallSites.size() > UINT16_MAX)
+        {
+            Error("too many calls");
+            return;
+        }
+
+        const uint8_t resultRegister = call.ResultVariableName.empty() ? NoRegister : FindLocal(call.ResultVariableName);
+        Script.CallSites.push_back({ StringTable::Intern(call.FunctionName), UnresolvedTarget, call.Line, (uint8_t)call.Arguments.size(), resultRegister });
+        Emit(EncodeInstruction(OP_CALL, firstArgument, (uint16_t)(Script.CallSites.size() - 1)));
+    }
+
+    void Compiler::CompileAssignment(const AssignmentStatement& assignment)
+    {
+        LoadOperand(assignment.RHS, FindLocal(assignment.VariableName));
+    }
+
+    void Compiler::CompileCondition(const ConditionStatement& condition)
+    {
+        uint8_t result = LoadOperand(condition.LHS);
+        if (condition.ConditionType != ConditionStatement::CONDITION_TYPE_NONE)
+        {
+            const uint8_t leftHandSide = result;
+            const uint8_t rightHandSide = LoadOperand(condition.RHS);
+            result = AllocateTemporary();
+
+            switch (condition.ConditionType)
+            {
+            case ConditionStatement::CONDITION_TYPE_EQUALS:
+                Emit(EncodeInstruction(OP_EQUAL, result, leftHandSide, rightHandSide));
+                break;
+            case ConditionStatement::CONDITION_TYPE_NOT_EQUALS:
+                Emit(EncodeInstruction(OP_NOT_EQUAL, result, leftHandSide, rightHandSide));
+                break;
+            case ConditionStatement::CONDITION_TYPE_LESS_THAN:
+                Emit(EncodeInstruction(OP_LESS, result, leftHandSide, rightHandSide));
+                break;
+            case ConditionStatement::CONDITION_TYPE_GREATER_THAN:
+                Emit(EncodeInstruction(OP_LESS, result, rightHandSide, leftHandSide));
+                break;
+            case ConditionStatement::CONDITION_TYPE_LESSOREQUAL_THAN:
+                Emit(EncodeInstruction(OP_LESS_OR_EQUAL, result, leftHandSide, rightHandSide));
+                break;
+            case ConditionStatement::CONDITION_TYPE_GREATEROREQUAL_THAN:
+                Emit(EncodeInstruction(OP_LESS_OR_EQUAL, result, rightHandSide, leftHandSide));
+                break;
+            default:
+                break;
+            }
+        }
+
+        //  Comparisons are joined left to right as they come.
+        if (ConditionRegister == NoRegister)
+        {
+            ConditionRegister = result;
+            return;
+        }
+
+        const uint8_t joined = AllocateTemporary();
+        Emit(EncodeInstruction(ConditionRelation, joined, ConditionRegister, result));
+        ConditionRegister = joined;
+    }
+
+    void Compiler::FinishCondition()
+    {
+        IsInCondition = false;
+        if (ConditionRegister == NoRegister)
+        {
+            Error("condition without comparisons");
+            return;
+        }
+
+        PendingJumps.push_back((uint32_t)Script.Code.size());
+        Emit(EncodeInstruction(OP_JUMP_IF_FALSE, ConditionRegister, (uint16_t)0));
+    }
+
+    void Compiler::CloseCondition()
+    {
+        if (PendingJumps.empty())
+        {
+            Error("'endif' without condition");
+            return;
+        }
+
+        //  Jump targets are relative to the function start.
+        const uint32_t target = (uint32_t)Script.Code.size() - Compiled.CodeOffset;
+        if (target > UINT16_MAX)
+        {
+            Error("function is too long");
+            return;
+        }
+
+        Instruction& jump = Script.Code[PendingJumps.back()];
+        jump = EncodeInstruction(OP_JUMP_IF_FALSE, GetA(jump), (uint16_t)target);
+        PendingJumps.pop_back();
+    }
+
+    bool Compiler::CompileFunction(const FunctionDefinition& function)
+    {
+        const uint32_t errorsBefore = ErrorsFound;
+
+        Function = &function;
+        Compiled = { StringTable::Intern(function.Name), (uint32_t)Script.Code.size(), 0, (uint8_t)function.Arguments.size(), 0 };
+        IsInCondition = false;
+        PendingJumps.clear();
+
+        //  Arguments, then variables. A variable named like an argument is that argument.
+        Locals.clear();
+        for (const auto& argument : function.Arguments)
+            Locals.push_back(StringTable::Intern(argument));
+
+        for (const auto& variable : function.Variables)
+        {
+            if (FindLocal(variable.Name) == NoRegister)
+                Locals.push_back(StringTable::Intern(variable.Name));
+        }
+
+        if (Locals.size() >= MaxRegisters)
+        {
+            Error("too many arguments and variables");
+            return false;
+        }
+
+        RegistersUsed = (uint32_t)Locals.size();
+
+        for (const auto& element : function.ControlFlow)
+        {
+            //  Temporaries only live for one statement.
+            NextTemporary = (uint32_t)Locals.size();
+
+            const bool isConditionPart = element->Type == ControlFlowElement::CONDITION_BODY || element->Type == ControlFlowElement::CONDITION_OPERATOR;
+            if (IsInCondition && !isConditionPart)
+                FinishCondition();
+
+            switch (element->Type)
+            {
+            case ControlFlowElement::VARIABLE_ASSIGNMENT:
+                CompileAssignment(static_cast<const AssignmentStatement&>(*element));
+                break;
+
+            case ControlFlowElement::FUNCTION_CALL:
+                CompileCall(static_cast<const FunctionCallStatement&>(*element));
+                break;
+
+            case ControlFlowElement::CONDITION_START:
+                IsInCondition = true;
+                ConditionRegister = NoRegister;
+                ConditionRelation = OP_AND;
+                break;
+
+            case ControlFlowElement::CONDITION_BODY:
+                //  Temporaries holding the condition so far must survive until the jump.
+                NextTemporary = std::max<uint32_t>(NextTemporary, ConditionRegister != NoRegister ? ConditionRegister + 1 : 0);
+                CompileCondition(static_cast<const ConditionStatement&>(*element));
+                break;
+
+            case ControlFlowElement::CONDITION_OPERATOR:
+                NextTemporary = std::max<uint32_t>(NextTemporary, ConditionRegister != NoRegister ? ConditionRegister + 1 : 0);
+                ConditionRelation = static_cast<const ConditionRelationStatement&>(*element).RelationType == ConditionRelationStatement::CONDITION_OPERATOR_LOGICAL_AND ? OP_AND : OP_OR;
+                break;
+
+            case ControlFlowElement::CONDITION_END:
+                CloseCondition();
+                break;
+            }
+        }
+
+        if (IsInCondition)
+            FinishCondition();
+
+        if (!PendingJumps.empty())
+            Error("condition without 'endif'");
+
+        Emit(EncodeInstruction(OP_RETURN, 0, 0, 0));
+
+        Compiled.CodeSize = (uint32_t)Script.Code.size() - Compiled.CodeOffset;
+        Compiled.RegistersCount = (uint8_t)RegistersUsed;
+        if (Compiled.CodeSize > UINT16_MAX)
+            Error("function is too long");
+
+        Script.Functions.push_back(Compiled);
+        Function = nullptr;
+
+        return ErrorsFound == errorsBefore;
+    }
+}
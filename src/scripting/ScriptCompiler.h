@@ -0,0 +1,62 @@
+#pragma once
+/*
+* File: ScriptCompiler.h
+* Purpose: lower parsed script functions into bytecode.
+*/
+#include "ScriptAsset.h"
+#include "Bytecode.h"
+
+namespace Scripting
+{
+    //  Functions are compiled one at a time into the same 'CompiledScript', sharing it's constant pool.
+    //  Calls are only recorded as call sites here, what they call is figured out once all scripts are loaded.
+    class Compiler
+    {
+    private:
+        CompiledScript&     Script;
+        std::string_view    ScriptName;
+        uint32_t            ErrorsFound;
+        //  Constants already in the pool by type and contents, so each one is stored once.
+        std::map<std::pair<uint8_t, uint64_t>, uint16_t>    ConstantsIndex;
+
+        //  State of the function being compiled.
+        const FunctionDefinition*   Function;
+        CompiledFunction    Compiled;
+        //  Interned names of arguments and variables, position is the register.
+        std::vector<uint32_t>   Locals;
+        uint32_t            NextTemporary;
+        uint32_t            RegistersUsed;
+        //  Condition being compiled, it's result so far and how next comparison is joined to it.
+        bool                IsInCondition;
+        uint8_t             ConditionRegister;
+        eOpcode             ConditionRelation;
+        //  Jumps past the condition bodies that are still open, patched once their 'endif' is reached.
+        std::vector<uint32_t>   PendingJumps;
+
+        void            Error(const std::string& message);
+        void            Emit(const Instruction instruction);
+        uint8_t         FindLocal(const std::string_view& name) const;
+        uint8_t         AllocateTemporary();
+        uint16_t        AddConstant(const Value& value);
+        Value           MakeConstant(const std::string_view& operand);
+
+        //  Register holding 'operand'. Locals are used where they are, unless 'target' is given, anything else is loaded into 'target' or a temporary.
+        uint8_t         LoadOperand(const std::string_view& operand, const uint8_t target = NoRegister);
+
+        void            CompileCall(const FunctionCallStatement& call);
+        void            CompileAssignment(const AssignmentStatement& assignment);
+        void            CompileCondition(const ConditionStatement& condition);
+        void            FinishCondition();
+        void            CloseCondition();
+
+    public:
+        Compiler(CompiledScript& script, const std::string_view& scriptName);
+
+        bool            CompileFunction(const FunctionDefinition& function);
+
+        inline const uint32_t GetErrorsFound() const
+        {
+            return ErrorsFound;
+        }
+    };
+}
@@ -0,0 +1,151 @@
+#include "ScriptLexer.h"
+
+namespace Scripting
+{
+    static inline bool IsIdentifierStart(const char character)
+    {
+        return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || character == '_';
+    }
+
+    static inline bool IsDigit(const char character)
+    {
+        return character >= '0' && character <= '9';
+    }
+
+    Lexer::Lexer(const char* data, const size_t size)
+    {
+        Position = data;
+        End = data ? data + size : data;
+        LineStart = data;
+        Line = 1;
+        PeekedToken = {};
+        HasPeekedToken = false;
+        LastTokenType = Token::NEWLINE;
+    }
+
+    Token Lexer::Next()
+    {
+        if (HasPeekedToken)
+            HasPeekedToken = false;
+        else
+            PeekedToken = ReadToken();
+
+        LastTokenType = PeekedToken.Type;
+        return PeekedToken;
+    }
+
+    const Token& Lexer::Peek()
+    {
+        if (!HasPeekedToken)
+        {
+            PeekedToken = ReadToken();
+            HasPeekedToken = true;
+        }
+
+        return PeekedToken;
+    }
+
+    Token Lexer::MakeToken(const Token::eTokenType type, const char* start, const size_t length) const
+    {
+        return { type, std::string_view(start, length), Line, (uint32_t)(start - LineStart + 1) };
+    }
+
+    Token Lexer::ReadToken()
+    {
+        //  Whitespace and comments.
+        while (Position < End)
+        {
+            const char character = *Position;
+            if (character == ' ' || character == '\t' || character == '\r')
+                Position++;
+            else if (character == '/' && Position + 1 < End && Position[1] == '/')
+            {
+                while (Position < End && *Position != '\n')
+                    Position++;
+            }
+            else
+                break;
+        }
+
+        if (Position >= End)
+            return MakeToken(Token::END, End, 0);
+
+        const char* start = Position;
+        const char character = *Position++;
+        const char nextCharacter = Position < End ? *Position : '\0';
+
+        if (character == '\n')
+        {
+            const Token token = MakeToken(Token::NEWLINE, start, 1);
+            Line++;
+            LineStart = Position;
+            return token;
+        }
+
+        if (IsIdentifierStart(character) || (character == '#' && IsIdentifierStart(nextCharacter)))
+        {
+            while (Position < End && (IsIdentifierStart(*Position) || IsDigit(*Position)))
+                Position++;
+
+            return MakeToken(character == '#' ? Token::DIRECTIVE : Token::IDENTIFIER, start, Position - start);
+        }
+
+        if (IsDigit(character) || (character == '-' && IsDigit(nextCharacter)))
+        {
+            while (Position < End && (IsDigit(*Position) || *Position == '.'))
+                Position++;
+
+            return MakeToken(Token::NUMBER, start, Position - start);
+        }
+
+        //  Strings can't span lines.
+        if (character == '"')
+        {
+            while (Position < End && *Position != '"' && *Position != '\n')
+                Position++;
+
+            if (Position >= End || *Position != '"')
+                return MakeToken(Token::INVALID, start, Position - start);
+
+            Position++;
+            return MakeToken(Token::STRING, start, Position - start);
+        }
+
+        const auto TwoCharacters = [&](const char second, const Token::eTokenType pairType, const Token::eTokenType singleType)
+            {
+                if (nextCharacter != second)
+                    return MakeToken(singleType, start, 1);
+
+                Position++;
+                return MakeToken(pairType, start, 2);
+            };
+
+        switch (character)
+        {
+        case '(':
+            return MakeToken(Token::LEFT_PARENTHESIS, start, 1);
+        case ')':
+            return MakeToken(Token::RIGHT_PARENTHESIS, start, 1);
+        case '{':
+            return MakeToken(Token::LEFT_BRACE, start, 1);
+        case '}':
+            return MakeToken(Token::RIGHT_BRACE, start, 1);
+        case ',':
+            return MakeToken(Token::COMMA, start, 1);
+        case '=':
+            return TwoCharacters('=', Token::EQUALS, Token::ASSIGN);
+        case '!':
+            return TwoCharacters('=', Token::NOT_EQUALS, Token::INVALID);
+        case '<':
+            return TwoCharacters('=', Token::LESS_OR_EQUAL, Token::LESS_THAN);
+        case '>':
+            return TwoCharacters('=', Token::GREATER_OR_EQUAL, Token::GREATER_THAN);
+        case '&':
+            return TwoCharacters('&', Token::LOGICAL_AND, Token::INVALID);
+        case '|':
+            return TwoCharacters('|', Token::LOGICAL_OR, Token::INVALID);
+        default:
+            return MakeToken(Token::INVALID, start, 1);
+        }
+    }
+}
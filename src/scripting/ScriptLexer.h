@@ -0,0 +1,75 @@
+#pragma once
+/*
+* File: ScriptLexer.h
+* Purpose: split script source into tokens in one pass, without copying any of it.
+*/
+#include "Generic.h"
+
+namespace Scripting
+{
+    struct Token
+    {
+        enum eTokenType : uint8_t
+        {
+            END = 0,
+            NEWLINE,
+            IDENTIFIER,
+            NUMBER,
+            STRING,
+            //  '#' followed by a name, i.e. '#include'.
+            DIRECTIVE,
+            LEFT_PARENTHESIS,
+            RIGHT_PARENTHESIS,
+            LEFT_BRACE,
+            RIGHT_BRACE,
+            COMMA,
+            ASSIGN,
+            EQUALS,
+            NOT_EQUALS,
+            LESS_THAN,
+            GREATER_THAN,
+            LESS_OR_EQUAL,
+            GREATER_OR_EQUAL,
+            LOGICAL_AND,
+            LOGICAL_OR,
+            //  Character that can't start any token, or a string missing it's closing quote.
+            INVALID
+        }                   Type;
+
+        //  Points right into the script source. Strings keep their quotes, so they can be told apart from names later on.
+        std::string_view    Text;
+        uint32_t            Line;
+        uint32_t            Column;
+    };
+
+    //  Tokens are made on demand, front to back, so the source is only walked once. Comments and whitespace other than line breaks are skipped.
+    //  Statements end at line breaks, so those are tokens too. Once the end is reached, every following token is 'END'.
+    class Lexer
+    {
+    private:
+        const char*     Position;
+        const char*     End;
+        const char*     LineStart;
+        uint32_t        Line;
+
+        Token           PeekedToken;
+        bool            HasPeekedToken;
+        Token::eTokenType   LastTokenType;
+
+        Token           ReadToken();
+        Token           MakeToken(const Token::eTokenType type, const char* start, const size_t length) const;
+
+    public:
+        Lexer(const char* data, const size_t size);
+
+        Token           Next();
+        //  Same token the following 'Next' returns.
+        const Token&    Peek();
+
+        //  Type of the token last returned by 'Next', so error recovery can tell if a line break was consumed already.
+        inline const Token::eTokenType GetLastTokenType() const
+        {
+            return LastTokenType;
+        }
+    };
+}
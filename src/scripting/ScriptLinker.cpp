@@ -0,0 +1,94 @@
+#include "ScriptLinker.h"
+#include "Natives.h"
+#include "StringTable.h"
+#include "Logger.h"
+
+namespace Scripting
+{
+    Linker::Linker(CompiledScript& script, const std::string_view& scriptName) : Script(script)
+    {
+        ScriptName = scriptName;
+        ErrorsFound = 0;
+    }
+
+    void Linker::Error(const std::string& message)
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Script Link Error: {} (script '{}').", message, ScriptName);
+        ErrorsFound++;
+    }
+
+    uint32_t Linker::FindFunction(const uint32_t nameId) const
+    {
+        const CompiledFunction* function = Script.FindFunction(nameId);
+        return function ? (uint32_t)(function - Script.Functions.data()) : UnresolvedTarget;
+    }
+
+    void Linker::LinkCall(Instruction& instruction)
+    {
+        CallSite& callSite = Script.CallSites[GetBx(instruction)];
+        const std::string_view name = StringTable::Get(callSite.NameId);
+
+        const uint32_t functionIndex = FindFunction(callSite.NameId);
+        if (functionIndex != UnresolvedTarget)
+        {
+            const CompiledFunction& function = Script.Functions[functionIndex];
+            if (callSite.ArgumentsCount != function.ArgumentsCount)
+            {
+                Error(fmt::format("'{}' takes {} arguments, but {} are passed at line {}", name, function.ArgumentsCount, callSite.ArgumentsCount, callSite.Line));
+                return;
+            }
+
+            callSite.Target = functionIndex;
+            return;
+        }
+
+        const uint32_t nativeIndex = Natives::Find(callSite.NameId);
+        if (nativeIndex != UnresolvedTarget)
+        {
+            const NativeDefinition& native = Natives::Get(nativeIndex);
+            if (callSite.ArgumentsCount < native.MinimumArgumentsCount || callSite.ArgumentsCount > native.MaximumArgumentsCount)
+            {
+                if (native.MinimumArgumentsCount == native.MaximumArgumentsCount)
+                    Error(fmt::format("'{}' takes {} arguments, but {} are passed at line {}", name, native.MaximumArgumentsCount, callSite.ArgumentsCount, callSite.Line));
+                else
+                    Error(fmt::format("'{}' takes {} to {} arguments, but {} are passed at line {}", name, native.MinimumArgumentsCount, native.MaximumArgumentsCount, callSite.ArgumentsCount, callSite.Line));
+                return;
+            }
+
+            callSite.Target = nativeIndex;
+            instruction = EncodeInstruction(OP_CALL_NATIVE, GetA(instruction), GetBx(instruction));
+            return;
+        }
+
+        Error(fmt::format("call to unknown function '{}' at line {}", name, callSite.Line));
+    }
+
+    void Linker::LinkConstant(Value& constant)
+    {
+        if (constant.Type != Value::NAME)
+            return;
+
+        const uint32_t functionIndex = FindFunction(constant.Index);
+        if (functionIndex == UnresolvedTarget)
+        {
+            Error(fmt::format("unknown name '{}'", StringTable::Get(constant.Index)));
+            return;
+        }
+
+        constant = Value::MakeIndex(Value::FUNCTION, functionIndex);
+    }
+
+    bool Linker::Link()
+    {
+        for (auto& instruction : Script.Code)
+        {
+            if (GetOpcode(instruction) == OP_CALL)
+                LinkCall(instruction);
+        }
+
+        for (auto& constant : Script.Constants)
+            LinkConstant(constant);
+
+        return !ErrorsFound;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+/*
+* File: ScriptLinker.h
+* Purpose: resolve names compiled scripts use into what they refer to.
+*/
+#include "Bytecode.h"
+
+namespace Scripting
+{
+    //  After linking, every call goes straight to a function index, either a function of the same script ('OP_CALL') or a native ('OP_CALL_NATIVE'),
+    //  and every name constant is a function of the same script. Script functions take precedence over natives with the same name.
+    //  Natives must all be registered before the first script is linked.
+    class Linker
+    {
+    private:
+        CompiledScript&     Script;
+        std::string_view    ScriptName;
+        uint32_t            ErrorsFound;
+
+        void            Error(const std::string& message);
+        //  Returns 'UnresolvedTarget' if script has no such function.
+        uint32_t        FindFunction(const uint32_t nameId) const;
+
+        void            LinkCall(Instruction& instruction);
+        void            LinkConstant(Value& constant);
+
+    public:
+        Linker(CompiledScript& script, const std::string_view& scriptName);
+
+        //  Unresolved names and calls with wrong number of arguments are errors, those calls are left unresolved.
+        bool            Link();
+
+        inline const uint32_t GetErrorsFound() const
+        {
+            return ErrorsFound;
+        }
+    };
+}
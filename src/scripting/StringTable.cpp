@@ -0,0 +1,39 @@
+#include "StringTable.h"
+
+namespace Scripting
+{
+    Arena StringTable::Storage;
+    std::vector<std::string_view> StringTable::Strings;
+    std::unordered_map<std::string_view, uint32_t> StringTable::Index;
+    std::mutex StringTable::Mutex;
+
+    uint32_t StringTable::Intern(const std::string_view& text)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+
+        const auto entry = Index.find(text);
+        if (entry != Index.end())
+            return entry->second;
+
+        const std::string_view storedText = Storage.CopyString(text);
+        const uint32_t id = (uint32_t)Strings.size();
+        Strings.push_back(storedText);
+        Index.emplace(storedText, id);
+
+        return id;
+    }
+
+    uint32_t StringTable::Find(const std::string_view& text)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+
+        const auto entry = Index.find(text);
+        return entry != Index.end() ? entry->second : InvalidId;
+    }
+
+    std::string_view StringTable::Get(const uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return id < Strings.size() ? Strings[id] : std::string_view();
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+/*
+* File: StringTable.h
+* Purpose: keep one copy of every name and string scripts use, so they can be compared by identity.
+*/
+#include "Generic.h"
+#include "Arena.h"
+
+#include <mutex>
+
+namespace Scripting
+{
+    //  Interned strings are never freed, their views stay valid for as long as the game runs.
+    //  Scripts are compiled on loader threads, so both methods lock. Neither is meant for anything but loading and linking.
+    class StringTable
+    {
+    private:
+        static Arena                                        Storage;
+        static std::vector<std::string_view>                Strings;
+        static std::unordered_map<std::string_view, uint32_t>   Index;
+        static std::mutex                                   Mutex;
+
+    public:
+        //  What 'Find' returns for text that was never interned.
+        static constexpr uint32_t   InvalidId = UINT32_MAX;
+
+        //  Same text always gets the same id.
+        static uint32_t         Intern(const std::string_view& text);
+        //  Id of already interned text, nothing is added.
+        static uint32_t         Find(const std::string_view& text);
+        static std::string_view Get(const uint32_t id);
+    };
+}
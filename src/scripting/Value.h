@@ -0,0 +1,124 @@
+#pragma once
+/*
+* File: Value.h
+* Purpose: a single script value, as it's kept in registers and constant pools.
+*/
+#include "Generic.h"
+
+namespace Scripting
+{
+    //  16 bytes, copied around freely. Strings point to interned text (see 'StringTable'), so two equal strings have the same pointer.
+    struct Value
+    {
+        enum eValueType : uint8_t
+        {
+            NIL = 0,
+            BOOLEAN,
+            NUMBER,
+            STRING,
+            //  Name that wasn't a local, i.e. a function passed as event handler. Holds interned id until scripts are linked.
+            NAME,
+            FUNCTION,
+            ENTITY,
+            //  Script instance, what 'this' refers to.
+            SCRIPT
+        }                   Type;
+        uint32_t            Length;
+
+        union
+        {
+            bool            Boolean;
+            double          Number;
+            const char*     String;
+            uint32_t        Index;
+            void*           Object;
+        };
+
+        static inline Value MakeBoolean(const bool boolean)
+        {
+            Value value = { BOOLEAN, 0 };
+            value.Boolean = boolean;
+            return value;
+        }
+
+        static inline Value MakeNumber(const double number)
+        {
+            Value value = { NUMBER, 0 };
+            value.Number = number;
+            return value;
+        }
+
+        static inline Value MakeString(const std::string_view& string)
+        {
+            Value value = { STRING, (uint32_t)string.length() };
+            value.String = string.data();
+            return value;
+        }
+
+        static inline Value MakeIndex(const eValueType type, const uint32_t index)
+        {
+            Value value = { type, 0 };
+            value.Index = index;
+            return value;
+        }
+
+        static inline Value MakeObject(const eValueType type, void* object)
+        {
+            Value value = { type, 0 };
+            value.Object = object;
+            return value;
+        }
+
+        inline const char*      GetTypeName() const
+        {
+            constexpr const char* TypeNames[] = { "nil", "boolean", "number", "string", "name", "function", "entity", "script" };
+            return Type <= SCRIPT ? TypeNames[Type] : "unknown";
+        }
+
+        inline std::string_view GetString() const
+        {
+            return Type == STRING ? std::string_view(String, Length) : std::string_view();
+        }
+
+        //  'NIL', 'false' and zero are false, everything else is true.
+        inline bool IsTrue() const
+        {
+            switch (Type)
+            {
+            case NIL:
+                return false;
+            case BOOLEAN:
+                return Boolean;
+            case NUMBER:
+                return Number != 0.0;
+            default:
+                return true;
+            }
+        }
+
+        //  Values of different types are never equal. Interned strings are compared by pointer.
+        inline bool operator==(const Value& other) const
+        {
+            if (Type != other.Type)
+                return false;
+
+            switch (Type)
+            {
+            case NIL:
+                return true;
+            case BOOLEAN:
+                return Boolean == other.Boolean;
+            case NUMBER:
+                return Number == other.Number;
+            case STRING:
+                return String == other.String && Length == other.Length;
+            case SCRIPT:
+                return Object == other.Object;
+            default:
+                return Index == other.Index;
+            }
+        }
+    };
+
+    static_assert(sizeof(Value) == 16);
+}
@@ -0,0 +1,255 @@
+#include "VirtualMachine.h"
+#include "StringTable.h"
+
+namespace Scripting
+{
+    VirtualMachine::VirtualMachine(const size_t stackSize, const size_t framesCount)
+    {
+        Stack.resize(stackSize);
+        Frames.resize(framesCount);
+        FramesUsed = 0;
+        IsErrorSet = false;
+    }
+
+    bool VirtualMachine::PushFrame(const CompiledScript& script, const CompiledFunction& function, const Value& self, const Value* arguments, const size_t argumentsCount, const uint8_t resultRegister)
+    {
+        if (FramesUsed == Frames.size())
+        {
+            LastError = fmt::format("calls are nested deeper than {}", Frames.size());
+            return false;
+        }
+
+        //  New frame's registers start right after the caller's.
+        Value* registers = Stack.data();
+        if (FramesUsed)
+        {
+            const tCallFrame& caller = Frames[FramesUsed - 1];
+            registers = caller.Registers + caller.Function->RegistersCount;
+        }
+
+        if (registers + function.RegistersCount > Stack.data() + Stack.size())
+        {
+            LastError = "script stack overflow";
+            return false;
+        }
+
+        //  Missing arguments and all the variables start as 'nil', extra arguments are dropped.
+        const size_t argumentsPassed = std::min<size_t>(argumentsCount, function.ArgumentsCount);
+        for (size_t index = 0; index < argumentsPassed; index++)
+            registers[index] = arguments[index];
+
+        for (size_t index = argumentsPassed; index < function.RegistersCount; index++)
+            registers[index] = {};
+
+        tCallFrame& frame = Frames[FramesUsed++];
+        frame.Script = &script;
+        frame.Function = &function;
+        frame.Registers = registers;
+        frame.ProgramCounter = script.Code.data() + function.CodeOffset;
+        frame.Self = self;
+        frame.ResultRegister = resultRegister;
+
+        return true;
+    }
+
+    bool VirtualMachine::RuntimeError(const size_t entryFrame, const std::string& message)
+    {
+        LastError = message;
+        IsErrorSet = false;
+        FramesUsed = entryFrame;
+
+        return false;
+    }
+
+    bool VirtualMachine::Call(const CompiledScript& script, const CompiledFunction& function, const Value& self, const std::span<const Value> arguments)
+    {
+        const size_t entryFrame = FramesUsed;
+        if (!PushFrame(script, function, self, arguments.data(), arguments.size(), NoRegister))
+            return false;
+
+        return Execute(entryFrame);
+    }
+
+    bool VirtualMachine::Execute(const size_t entryFrame)
+    {
+        //  State of the running function is kept in locals, frames are only touched on calls and returns.
+        tCallFrame* frame = &Frames[FramesUsed - 1];
+        const Instruction* code = frame->Script->Code.data() + frame->Function->CodeOffset;
+        const Instruction* programCounter = frame->ProgramCounter;
+        const Value* constants = frame->Script->Constants.data();
+        Value* registers = frame->Registers;
+        Instruction instruction;
+
+        //  Compare two registers as numbers, anything else is an error.
+#define VM_COMPARE(operator)                                                                                    \
+        {                                                                                                       \
+            const Value& leftHandSide = registers[GetB(instruction)];                                           \
+            const Value& rightHandSide = registers[GetC(instruction)];                                          \
+            if (leftHandSide.Type != Value::NUMBER || rightHandSide.Type != Value::NUMBER)                      \
+                return RuntimeError(entryFrame, fmt::format("can't compare {} with {}", leftHandSide.GetTypeName(), rightHandSide.GetTypeName())); \
+            registers[GetA(instruction)] = Value::MakeBoolean(leftHandSide.Number operator rightHandSide.Number); \
+        }
+
+#define VM_LOAD_FRAME()                                                         \
+        code = frame->Script->Code.data() + frame->Function->CodeOffset;        \
+        programCounter = frame->ProgramCounter;                                 \
+        constants = frame->Script->Constants.data();                            \
+        registers = frame->Registers;
+
+#if defined(SCRIPT_THREADED_DISPATCH)
+        //  Code only ever comes from 'Compiler', so opcodes are not range checked.
+        static void* const DispatchTable[OP_COUNT] =
+        {
+            &&LABEL_OP_LOAD_CONSTANT,
+            &&LABEL_OP_LOAD_SELF,
+            &&LABEL_OP_MOVE,
+            &&LABEL_OP_EQUAL,
+            &&LABEL_OP_NOT_EQUAL,
+            &&LABEL_OP_LESS,
+            &&LABEL_OP_LESS_OR_EQUAL,
+            &&LABEL_OP_AND,
+            &&LABEL_OP_OR,
+            &&LABEL_OP_JUMP,
+            &&LABEL_OP_JUMP_IF_FALSE,
+            &&LABEL_OP_CALL,
+            &&LABEL_OP_CALL_NATIVE,
+            &&LABEL_OP_RETURN
+        };
+        static_assert(OP_COUNT == 14, "Dispatch table is missing an opcode!");
+
+#define VM_CASE(opcode) LABEL_##opcode:
+#define VM_NEXT() do { instruction = *programCounter++; goto *DispatchTable[GetOpcode(instruction)]; } while (false)
+
+        VM_NEXT();
+        {
+#else
+#define VM_CASE(opcode) case opcode:
+#define VM_NEXT() continue
+
+        for (;;)
+        {
+            instruction = *programCounter++;
+            switch (GetOpcode(instruction))
+            {
+#endif
+            VM_CASE(OP_LOAD_CONSTANT)
+                registers[GetA(instruction)] = constants[GetBx(instruction)];
+                VM_NEXT();
+
+            VM_CASE(OP_LOAD_SELF)
+                registers[GetA(instruction)] = frame->Self;
+                VM_NEXT();
+
+            VM_CASE(OP_MOVE)
+                registers[GetA(instruction)] = registers[GetB(instruction)];
+                VM_NEXT();
+
+            VM_CASE(OP_EQUAL)
+                registers[GetA(instruction)] = Value::MakeBoolean(registers[GetB(instruction)] == registers[GetC(instruction)]);
+                VM_NEXT();
+
+            VM_CASE(OP_NOT_EQUAL)
+                registers[GetA(instruction)] = Value::MakeBoolean(!(registers[GetB(instruction)] == registers[GetC(instruction)]));
+                VM_NEXT();
+
+            VM_CASE(OP_LESS)
+                VM_COMPARE(<);
+                VM_NEXT();
+
+            VM_CASE(OP_LESS_OR_EQUAL)
+                VM_COMPARE(<=);
+                VM_NEXT();
+
+            VM_CASE(OP_AND)
+                registers[GetA(instruction)] = Value::MakeBoolean(registers[GetB(instruction)].IsTrue() && registers[GetC(instruction)].IsTrue());
+                VM_NEXT();
+
+            VM_CASE(OP_OR)
+                registers[GetA(instruction)] = Value::MakeBoolean(registers[GetB(instruction)].IsTrue() || registers[GetC(instruction)].IsTrue());
+                VM_NEXT();
+
+            VM_CASE(OP_JUMP)
+                programCounter = code + GetBx(instruction);
+                VM_NEXT();
+
+            VM_CASE(OP_JUMP_IF_FALSE)
+                if (!registers[GetA(instruction)].IsTrue())
+                    programCounter = code + GetBx(instruction);
+                VM_NEXT();
+
+            VM_CASE(OP_CALL)
+            {
+                const CallSite& callSite = frame->Script->CallSites[GetBx(instruction)];
+
+                if (callSite.Target == UnresolvedTarget)
+                    return RuntimeError(entryFrame, fmt::format("call to unresolved function '{}' at line {}", StringTable::Get(callSite.NameId), callSite.Line));
+
+                frame->ProgramCounter = programCounter;
+                if (!PushFrame(*frame->Script, frame->Script->Functions[callSite.Target], frame->Self, registers + GetA(instruction), callSite.ArgumentsCount, callSite.ResultRegister))
+                    return RuntimeError(entryFrame, fmt::format("{} at line {}", LastError, callSite.Line));
+
+                frame = &Frames[FramesUsed - 1];
+                VM_LOAD_FRAME();
+                VM_NEXT();
+            }
+
+            VM_CASE(OP_CALL_NATIVE)
+            {
+                const CallSite& callSite = frame->Script->CallSites[GetBx(instruction)];
+                const NativeDefinition& native = Natives::Get(callSite.Target);
+
+                //  Natives always get all the arguments they accept, missing ones are passed as 'nil' from the free space past this frame.
+                const Value* arguments = registers + GetA(instruction);
+                if (callSite.ArgumentsCount < native.MaximumArgumentsCount)
+                {
+                    Value* paddedArguments = registers + frame->Function->RegistersCount;
+                    if (paddedArguments + native.MaximumArgumentsCount > Stack.data() + Stack.size())
+                        return RuntimeError(entryFrame, fmt::format("script stack overflow at line {}", callSite.Line));
+
+                    for (size_t index = 0; index < callSite.ArgumentsCount; index++)
+                        paddedArguments[index] = arguments[index];
+
+                    for (size_t index = callSite.ArgumentsCount; index < native.MaximumArgumentsCount; index++)
+                        paddedArguments[index] = {};
+
+                    arguments = paddedArguments;
+                }
+
+                //  Native may call back into the machine, new frames go above this one as usual.
+                frame->ProgramCounter = programCounter;
+                Value result = {};
+                if (!native.Function(*this, arguments, result))
+                    return RuntimeError(entryFrame, fmt::format("{} in '{}' at line {}", LastError, StringTable::Get(callSite.NameId), callSite.Line));
+
+                if (callSite.ResultRegister != NoRegister)
+                    registers[callSite.ResultRegister] = result;
+                VM_NEXT();
+            }
+
+            VM_CASE(OP_RETURN)
+            {
+                //  Script functions don't return values yet, whoever wanted the result gets 'nil'.
+                const uint8_t resultRegister = frame->ResultRegister;
+                if (--FramesUsed == entryFrame)
+                    return true;
+
+                frame = &Frames[FramesUsed - 1];
+                VM_LOAD_FRAME();
+                if (resultRegister != NoRegister)
+                    registers[resultRegister] = {};
+                VM_NEXT();
+            }
+
+#if !defined(SCRIPT_THREADED_DISPATCH)
+            default:
+                return RuntimeError(entryFrame, fmt::format("invalid opcode {}", (uint32_t)GetOpcode(instruction)));
+            }
+#endif
+        }
+
+#undef VM_COMPARE
+#undef VM_LOAD_FRAME
+#undef VM_CASE
+#undef VM_NEXT
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+/*
+* File: VirtualMachine.h
+* Purpose: runs compiled scripts (see Bytecode.h).
+*/
+#include "Bytecode.h"
+#include "Natives.h"
+
+#include <span>
+
+//  GCC and Clang can jump straight from one instruction handler to the next through a table of label addresses,
+//  so each handler gets it's own indirect branch for the CPU to predict. Everything else goes through a plain switch.
+#if defined(__GNUC__) || defined(__clang__)
+#define SCRIPT_THREADED_DISPATCH
+#endif
+
+namespace Scripting
+{
+    //  Registers of every running function live in one stack, allocated once, calls only move a pointer along it.
+    //  Script to script calls don't recurse on the native stack, so how deep scripts can go is decided by 'framesCount' alone.
+    class VirtualMachine
+    {
+    public:
+        static constexpr size_t DefaultStackSize = 64 * 1024;
+        static constexpr size_t DefaultFramesCount = 256;
+
+    private:
+        struct tCallFrame
+        {
+            const CompiledScript*   Script;
+            const CompiledFunction* Function;
+            Value*                  Registers;
+            //  Next instruction to run, only up to date while this frame is calling something.
+            const Instruction*      ProgramCounter;
+            Value                   Self;
+            //  Caller's register that gets the result, 'NoRegister' if nobody needs it.
+            uint8_t                 ResultRegister;
+        };
+
+        std::vector<Value>          Stack;
+        std::vector<tCallFrame>     Frames;
+        size_t                      FramesUsed;
+        std::string                 LastError;
+        //  Set by 'SetError', for natives that report errors through the machine instead of their result.
+        bool                        IsErrorSet;
+
+        bool            PushFrame(const CompiledScript& script, const CompiledFunction& function, const Value& self, const Value* arguments, const size_t argumentsCount, const uint8_t resultRegister);
+        bool            Execute(const size_t entryFrame);
+        //  Drops every frame above 'entryFrame', so the machine is ready for the next call.
+        bool            RuntimeError(const size_t entryFrame, const std::string& message);
+
+    public:
+        VirtualMachine(const size_t stackSize = DefaultStackSize, const size_t framesCount = DefaultFramesCount);
+
+        //  Runs 'function' of 'script' to the end. 'self' is what 'this' is inside of it.
+        //  Returns false on runtime error, 'GetLastError' has the description then.
+        bool            Call(const CompiledScript& script, const CompiledFunction& function, const Value& self, const std::span<const Value> arguments = {});
+
+        inline const std::string& GetLastError() const
+        {
+            return LastError;
+        }
+
+        //  For natives, to describe why they failed. Always returns false.
+        inline bool     SetError(const std::string& message)
+        {
+            LastError = message;
+            IsErrorSet = true;
+            return false;
+        }
+
+        //  Was an error set since it was last taken.
+        inline bool     TakeError()
+        {
+            const bool wasErrorSet = IsErrorSet;
+            IsErrorSet = false;
+            return wasErrorSet;
+        }
+
+        //  What 'this' is in the function that is running now.
+        inline const Value& GetSelf() const
+        {
+            return Frames[FramesUsed - 1].Self;
+        }
+    };
+}
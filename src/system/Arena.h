@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Generic.h"
+
+#include <span>
+
+//  A monotonic allocator. Memory is handed out from big blocks one piece after another and is never given back one piece at a time,
+//  only all at once with 'Reset' or when arena is destroyed. Destructors are never called, so only trivially destructible objects can be put here.
+class Arena
+{
+private:
+    struct tBlock
+    {
+        std::unique_ptr<uint8_t[]>  Data;
+        size_t                      Size;
+    };
+
+    std::vector<tBlock> Blocks;
+    size_t              BlockSize;
+    size_t              CurrentBlock;
+    size_t              CurrentOffset;
+    size_t              BytesAllocated;
+
+    inline void*        AllocateInBlock(const size_t size, const size_t alignment)
+    {
+        tBlock& block = Blocks[CurrentBlock];
+        const uintptr_t blockStart = (uintptr_t)block.Data.get();
+        const size_t alignedOffset = ((blockStart + CurrentOffset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - blockStart;
+
+        if (alignedOffset + size > block.Size)
+            return nullptr;
+
+        CurrentOffset = alignedOffset + size;
+        BytesAllocated += size;
+
+        return block.Data.get() + alignedOffset;
+    }
+
+public:
+    explicit Arena(const size_t blockSize = 16 * 1024)
+    {
+        BlockSize = blockSize;
+        CurrentBlock = 0;
+        CurrentOffset = 0;
+        BytesAllocated = 0;
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    //  'alignment' must be a power of two.
+    void*               Allocate(const size_t size, const size_t alignment = alignof(std::max_align_t))
+    {
+        //  Blocks left over from before 'Reset' are used first.
+        for (; CurrentBlock < Blocks.size(); CurrentBlock++, CurrentOffset = 0)
+        {
+            if (void* memory = AllocateInBlock(size, alignment))
+                return memory;
+        }
+
+        //  Blocks are not zero filled, everything put here is initialized by whoever asked for it.
+        const size_t blockSize = std::max(BlockSize, size + alignment);
+        Blocks.push_back({ std::unique_ptr<uint8_t[]>(new uint8_t[blockSize]), blockSize });
+        CurrentBlock = Blocks.size() - 1;
+        CurrentOffset = 0;
+
+        return AllocateInBlock(size, alignment);
+    }
+
+    template <class T, class... Args>
+    inline T*           New(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "Arena never calls destructors!");
+        return new (Allocate(sizeof(T), alignof(T))) T{ std::forward<Args>(args)... };
+    }
+
+    //  Array of 'count' value initialized elements.
+    template <class T>
+    inline std::span<T> NewArray(const size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "Arena never calls destructors!");
+        if (!count)
+            return {};
+
+        T* elements = (T*)Allocate(sizeof(T) * count, alignof(T));
+        std::uninitialized_value_construct_n(elements, count);
+
+        return std::span<T>(elements, count);
+    }
+
+    //  Copy of 'string', followed by terminating zero, so it's safe to pass the data pointer to C functions.
+    inline std::string_view CopyString(const std::string_view& string)
+    {
+        char* copy = (char*)Allocate(string.size() + 1, 1);
+        memcpy(copy, string.data(), string.size());
+        copy[string.size()] = '\0';
+
+        return std::string_view(copy, string.size());
+    }
+
+    //  Forget everything that was allocated. Blocks are kept and reused by following allocations.
+    inline void         Reset()
+    {
+        CurrentBlock = 0;
+        CurrentOffset = 0;
+        BytesAllocated = 0;
+    }
+
+    inline const size_t GetBytesAllocated() const
+    {
+        return BytesAllocated;
+    }
+};
@@ -0,0 +1,216 @@
+#include "FileMapping.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif _WIN32
+#include <fileapi.h>
+#include <handleapi.h>
+#include <memoryapi.h>
+#include <errhandlingapi.h>
+#endif
+
+FileMapping::FileMapping()
+{
+    View = nullptr;
+    Size = 0;
+}
+
+FileMapping::~FileMapping()
+{
+    if (!View || Parent || Buffer)
+        return;
+
+#ifdef __linux__
+    munmap((void*)View, Size);
+#elif _WIN32
+    UnmapViewOfFile(View);
+#endif
+}
+
+std::shared_ptr<const FileMapping> FileMapping::Open(const std::string& path, FileErrorType& error)
+{
+    std::shared_ptr<FileMapping> mapping(new FileMapping);
+    error = 0;
+
+#ifdef __linux__
+    const int fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0)
+    {
+        error = errno;
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) < 0)
+    {
+        error = errno;
+        close(fileDescriptor);
+        return nullptr;
+    }
+
+    mapping->Size = (size_t)fileStat.st_size;
+    if (mapping->Size)
+    {
+        void* view = mmap(nullptr, mapping->Size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (view == MAP_FAILED)
+        {
+            error = errno;
+            close(fileDescriptor);
+            return nullptr;
+        }
+
+        //  Assets are parsed front to back right away, so let the kernel start reading ahead now.
+        madvise(view, mapping->Size, MADV_WILLNEED);
+        mapping->View = (const uint8_t*)view;
+    }
+
+    //  The mapping stays valid after descriptor is closed.
+    close(fileDescriptor);
+
+#elif _WIN32
+    const HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        error = (FileErrorType)GetLastError();
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize))
+    {
+        error = (FileErrorType)GetLastError();
+        CloseHandle(fileHandle);
+        return nullptr;
+    }
+
+    mapping->Size = (size_t)fileSize.QuadPart;
+    if (mapping->Size)
+    {
+        const HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mappingHandle)
+        {
+            error = (FileErrorType)GetLastError();
+            CloseHandle(fileHandle);
+            return nullptr;
+        }
+
+        mapping->View = (const uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (!mapping->View)
+            error = (FileErrorType)GetLastError();
+
+        //  The view keeps the mapping object alive on it's own.
+        CloseHandle(mappingHandle);
+    }
+
+    CloseHandle(fileHandle);
+
+    if (error)
+        return nullptr;
+#endif
+
+    return mapping;
+}
+
+std::shared_ptr<const FileMapping> FileMapping::Read(const std::string& path, FileErrorType& error)
+{
+    std::shared_ptr<FileMapping> mapping(new FileMapping);
+    error = 0;
+
+#ifdef __linux__
+    const int fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0)
+    {
+        error = errno;
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) < 0)
+    {
+        error = errno;
+        close(fileDescriptor);
+        return nullptr;
+    }
+
+    //  File may get shorter while it's read, whatever was there is used then.
+    const size_t fileSize = (size_t)fileStat.st_size;
+    mapping->Buffer = std::make_unique_for_overwrite<uint8_t[]>(fileSize);
+    while (mapping->Size < fileSize)
+    {
+        const ssize_t bytesRead = read(fileDescriptor, mapping->Buffer.get() + mapping->Size, fileSize - mapping->Size);
+        if (bytesRead < 0 && errno == EINTR)
+            continue;
+
+        if (bytesRead < 0)
+        {
+            error = errno;
+            close(fileDescriptor);
+            return nullptr;
+        }
+
+        if (!bytesRead)
+            break;
+
+        mapping->Size += (size_t)bytesRead;
+    }
+
+    close(fileDescriptor);
+
+#elif _WIN32
+    const HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        error = (FileErrorType)GetLastError();
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize))
+    {
+        error = (FileErrorType)GetLastError();
+        CloseHandle(fileHandle);
+        return nullptr;
+    }
+
+    mapping->Buffer = std::make_unique_for_overwrite<uint8_t[]>((size_t)fileSize.QuadPart);
+    while (mapping->Size < (size_t)fileSize.QuadPart)
+    {
+        const DWORD bytesToRead = (DWORD)std::min<size_t>((size_t)fileSize.QuadPart - mapping->Size, MAXDWORD);
+        DWORD bytesRead = 0;
+        if (!ReadFile(fileHandle, mapping->Buffer.get() + mapping->Size, bytesToRead, &bytesRead, nullptr))
+        {
+            error = (FileErrorType)GetLastError();
+            CloseHandle(fileHandle);
+            return nullptr;
+        }
+
+        if (!bytesRead)
+            break;
+
+        mapping->Size += bytesRead;
+    }
+
+    CloseHandle(fileHandle);
+#endif
+
+    //  Empty file has no data, same as when it's mapped.
+    mapping->View = mapping->Size ? mapping->Buffer.get() : nullptr;
+
+    return mapping;
+}
+
+std::shared_ptr<const FileMapping> FileMapping::Slice(const std::shared_ptr<const FileMapping>& parent, const size_t offset, const size_t size)
+{
+    if (!parent || offset > parent->Size || size > parent->Size - offset)
+        return nullptr;
+
+    std::shared_ptr<FileMapping> mapping(new FileMapping);
+    mapping->View = size ? parent->View + offset : nullptr;
+    mapping->Size = size;
+    mapping->Parent = parent;
+
+    return mapping;
+}
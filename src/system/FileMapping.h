@@ -0,0 +1,49 @@
+#pragma once
+/*
+* File: FileMapping.h
+* Purpose: a read-only view of a file's contents, mapped into the address space instead of being copied into a heap buffer.
+*/
+#include "Generic.h"
+
+//  The pages of the file are shared with the OS page cache, so nothing is allocated or zero-filled when file is opened.
+//  Instances are shared, so any asset that wants to keep the raw bytes after parsing can simply hold on to it.
+class FileMapping
+{
+private:
+    const uint8_t*  View;
+    size_t          Size;
+
+    //  Set when this is only a part of another mapping, which then owns the pages.
+    std::shared_ptr<const FileMapping>  Parent;
+    //  Set when file was read instead of mapped, see 'Read'.
+    std::unique_ptr<uint8_t[]>          Buffer;
+
+    FileMapping();
+
+public:
+    FileMapping(const FileMapping&) = delete;
+    FileMapping& operator=(const FileMapping&) = delete;
+
+    ~FileMapping();
+
+    //  Map the whole file found at 'path'. On failure returns nullptr and 'error' is set to the system error code.
+    //  An empty file is mapped successfully, but it's data pointer is null.
+    static std::shared_ptr<const FileMapping> Open(const std::string& path, FileErrorType& error);
+
+    //  Same as 'Open', but file is read into a buffer of it's own. Use it for files that may be changed while they are in use,
+    //  mapped pages that were not read yet would show the new contents, and a file that got shorter would crash whoever reads past it's end.
+    static std::shared_ptr<const FileMapping> Read(const std::string& path, FileErrorType& error);
+
+    //  Make a view of 'size' bytes at 'offset' into an existing mapping. The new view keeps 'parent' alive.
+    static std::shared_ptr<const FileMapping> Slice(const std::shared_ptr<const FileMapping>& parent, const size_t offset, const size_t size);
+
+    inline const uint8_t* GetData() const
+    {
+        return View;
+    }
+
+    inline const size_t GetSize() const
+    {
+        return Size;
+    }
+};
@@ -0,0 +1,224 @@
+#include "FileWatcher.h"
+
+#include <filesystem>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <limits.h>
+#elif _WIN32
+#include <fileapi.h>
+#include <handleapi.h>
+#include <ioapiset.h>
+#include <stringapiset.h>
+#include <winbase.h>
+#endif
+
+#ifdef __linux__
+//  Editors often save by writing a temporary file and renaming it over the original, so moves count as writes too.
+constexpr uint32_t WatchEventsMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF;
+#elif _WIN32
+constexpr DWORD WatchEventsMask = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME;
+#endif
+
+FileWatcher::FileWatcher()
+{
+#ifdef __linux__
+    Descriptor = -1;
+#elif _WIN32
+    DirectoryHandle = INVALID_HANDLE_VALUE;
+    Overlapped = {};
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+    Close();
+}
+
+bool FileWatcher::Open(const std::string& directoryPath)
+{
+    Close();
+
+    DirectoryPath = directoryPath;
+    if (!DirectoryPath.ends_with('/'))
+        DirectoryPath += '/';
+
+#ifdef __linux__
+    Descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (Descriptor < 0)
+        return false;
+
+    if (!AddWatch({}))
+    {
+        Close();
+        return false;
+    }
+
+#elif _WIN32
+    DirectoryHandle = CreateFileA(DirectoryPath.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (DirectoryHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    Overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    EventsBuffer.resize(64 * 1024);
+
+    if (!Overlapped.hEvent || !QueueRead())
+    {
+        Close();
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+void FileWatcher::Close()
+{
+#ifdef __linux__
+    if (Descriptor >= 0)
+        close(Descriptor);
+
+    Descriptor = -1;
+    WatchedDirectories.clear();
+#elif _WIN32
+    if (DirectoryHandle != INVALID_HANDLE_VALUE)
+    {
+        CancelIo(DirectoryHandle);
+        CloseHandle(DirectoryHandle);
+    }
+
+    if (Overlapped.hEvent)
+        CloseHandle(Overlapped.hEvent);
+
+    DirectoryHandle = INVALID_HANDLE_VALUE;
+    Overlapped = {};
+#endif
+}
+
+bool FileWatcher::IsOpen() const
+{
+#ifdef __linux__
+    return Descriptor >= 0;
+#elif _WIN32
+    return DirectoryHandle != INVALID_HANDLE_VALUE;
+#else
+    return false;
+#endif
+}
+
+#ifdef __linux__
+bool FileWatcher::AddWatch(const std::string& relativePath)
+{
+    const std::string fullPath = DirectoryPath + relativePath;
+    const int watchDescriptor = inotify_add_watch(Descriptor, fullPath.c_str(), WatchEventsMask);
+    if (watchDescriptor < 0)
+        return false;
+
+    WatchedDirectories[watchDescriptor] = relativePath;
+
+    //  inotify is not recursive, so every subdirectory is added one by one.
+    std::error_code errorCode;
+    for (const auto& entry : std::filesystem::directory_iterator(fullPath, errorCode))
+    {
+        if (entry.is_directory(errorCode))
+            AddWatch(relativePath + entry.path().filename().string() + '/');
+    }
+
+    return true;
+}
+
+void FileWatcher::Poll(std::unordered_set<std::string>& changedFiles)
+{
+    if (Descriptor < 0)
+        return;
+
+    alignas(inotify_event) uint8_t eventsBuffer[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+    while (true)
+    {
+        const ssize_t bytesRead = read(Descriptor, eventsBuffer, sizeof(eventsBuffer));
+        if (bytesRead <= 0)
+            break;
+
+        for (ssize_t offset = 0; offset < bytesRead;)
+        {
+            const inotify_event* event = (const inotify_event*)(eventsBuffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            const auto watchedDirectory = WatchedDirectories.find(event->wd);
+            if (watchedDirectory == WatchedDirectories.end())
+                continue;
+
+            if (event->mask & (IN_DELETE_SELF | IN_IGNORED))
+            {
+                WatchedDirectories.erase(watchedDirectory);
+                continue;
+            }
+
+            if (!event->len)
+                continue;
+
+            const std::string relativePath = watchedDirectory->second + event->name;
+            if (event->mask & IN_ISDIR)
+            {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    AddWatch(relativePath + '/');
+
+                continue;
+            }
+
+            //  A created file is reported again once it's written and closed, so creation alone is not a change.
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                changedFiles.insert(relativePath);
+        }
+    }
+}
+#elif _WIN32
+bool FileWatcher::QueueRead()
+{
+    ResetEvent(Overlapped.hEvent);
+    return ReadDirectoryChangesW(DirectoryHandle, EventsBuffer.data(), (DWORD)EventsBuffer.size(), TRUE, WatchEventsMask, nullptr, &Overlapped, nullptr);
+}
+
+void FileWatcher::Poll(std::unordered_set<std::string>& changedFiles)
+{
+    if (DirectoryHandle == INVALID_HANDLE_VALUE)
+        return;
+
+    DWORD bytesRead = 0;
+    if (!GetOverlappedResult(DirectoryHandle, &Overlapped, &bytesRead, FALSE))
+        return;
+
+    //  Zero bytes means buffer overflowed and the changes are lost, there's nothing better to do than to carry on.
+    for (DWORD offset = 0; bytesRead && offset < bytesRead;)
+    {
+        const FILE_NOTIFY_INFORMATION* event = (const FILE_NOTIFY_INFORMATION*)(EventsBuffer.data() + offset);
+
+        if (event->Action == FILE_ACTION_MODIFIED || event->Action == FILE_ACTION_ADDED || event->Action == FILE_ACTION_RENAMED_NEW_NAME)
+        {
+            const int nameLength = (int)(event->FileNameLength / sizeof(WCHAR));
+            const int pathLength = WideCharToMultiByte(CP_UTF8, 0, event->FileName, nameLength, nullptr, 0, nullptr, nullptr);
+
+            std::string relativePath(pathLength, '\0');
+            WideCharToMultiByte(CP_UTF8, 0, event->FileName, nameLength, relativePath.data(), pathLength, nullptr, nullptr);
+            std::replace(relativePath.begin(), relativePath.end(), '\\', '/');
+
+            std::error_code errorCode;
+            if (!std::filesystem::is_directory(DirectoryPath + relativePath, errorCode))
+                changedFiles.insert(relativePath);
+        }
+
+        if (!event->NextEntryOffset)
+            break;
+
+        offset += event->NextEntryOffset;
+    }
+
+    QueueRead();
+}
+#else
+void FileWatcher::Poll(std::unordered_set<std::string>& changedFiles)
+{
+}
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+/*
+* File: FileWatcher.h
+* Purpose: get notified about files that were modified inside a directory tree, without scanning it.
+*/
+#include "Generic.h"
+
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <minwinbase.h>
+#endif
+
+//  Watches a directory and all of it's subdirectories for files that were written to, created or moved in.
+//  Notifications are queued by the OS and collected with 'Poll', which never blocks, so it's fine to call it every frame.
+class FileWatcher
+{
+private:
+    std::string     DirectoryPath;
+
+#ifdef __linux__
+    int             Descriptor;
+    //  Every subdirectory needs it's own watch, this maps watch descriptor to directory path relative to 'DirectoryPath'.
+    std::unordered_map<int, std::string>    WatchedDirectories;
+
+    bool            AddWatch(const std::string& relativePath);
+#elif _WIN32
+    HANDLE          DirectoryHandle;
+    OVERLAPPED      Overlapped;
+    std::vector<uint8_t>    EventsBuffer;
+
+    bool            QueueRead();
+#endif
+
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    //  Start watching 'directoryPath' recursively. Directories created later are watched too.
+    bool            Open(const std::string& directoryPath);
+    void            Close();
+
+    bool            IsOpen() const;
+
+    //  Add paths of files changed since last call to 'changedFiles', relative to the watched directory and using '/'.
+    //  Each file is listed once, even if it was written to several times.
+    void            Poll(std::unordered_set<std::string>& changedFiles);
+};
@@ -0,0 +1,262 @@
+#include "JsonStreamReader.h"
+
+#include <charconv>
+#include <algorithm>
+#include <cctype>
+
+JsonStreamReader::JsonStreamReader(const char* data, const size_t size)
+{
+    Begin = data;
+    Position = data;
+    End = data + (data ? size : 0);
+    Failed = false;
+}
+
+char JsonStreamReader::Peek()
+{
+    while (Position < End && (*Position == ' ' || *Position == '\t' || *Position == '\r' || *Position == '\n'))
+        Position++;
+
+    return !Failed && Position < End ? *Position : '\0';
+}
+
+bool JsonStreamReader::Expect(const char character)
+{
+    if (Peek() != character)
+        return Fail();
+
+    Position++;
+    return true;
+}
+
+bool JsonStreamReader::Fail()
+{
+    Failed = true;
+    return false;
+}
+
+bool JsonStreamReader::ReadKey(std::string_view& key)
+{
+    return ReadString(key) && Expect(':');
+}
+
+bool JsonStreamReader::BeginObject(std::string_view& key)
+{
+    if (!Expect('{'))
+        return false;
+
+    if (Peek() == '}')
+    {
+        Position++;
+        return false;
+    }
+
+    return ReadKey(key);
+}
+
+bool JsonStreamReader::NextKey(std::string_view& key)
+{
+    const char separator = Peek();
+    if (separator == '}')
+    {
+        Position++;
+        return false;
+    }
+
+    return Expect(',') && ReadKey(key);
+}
+
+bool JsonStreamReader::BeginArray()
+{
+    if (!Expect('['))
+        return false;
+
+    if (Peek() == ']')
+    {
+        Position++;
+        return false;
+    }
+
+    return !Failed;
+}
+
+bool JsonStreamReader::NextElement()
+{
+    const char separator = Peek();
+    if (separator == ']')
+    {
+        Position++;
+        return false;
+    }
+
+    return Expect(',');
+}
+
+bool JsonStreamReader::ReadString(std::string_view& value)
+{
+    if (!Expect('"'))
+        return false;
+
+    //  Most strings have nothing to decode, these are returned right from the buffer.
+    const char* stringStart = Position;
+    while (Position < End && *Position != '"' && *Position != '\\')
+        Position++;
+
+    if (Position < End && *Position == '"')
+    {
+        value = std::string_view(stringStart, Position - stringStart);
+        Position++;
+        return true;
+    }
+
+    DecodedString.assign(stringStart, Position);
+    while (Position < End && *Position != '"')
+    {
+        if (*Position != '\\')
+        {
+            DecodedString.push_back(*Position++);
+            continue;
+        }
+
+        if (++Position >= End)
+            break;
+
+        const char escaped = *Position++;
+        switch (escaped)
+        {
+        case 'b': DecodedString.push_back('\b'); break;
+        case 'f': DecodedString.push_back('\f'); break;
+        case 'n': DecodedString.push_back('\n'); break;
+        case 'r': DecodedString.push_back('\r'); break;
+        case 't': DecodedString.push_back('\t'); break;
+        case 'u':
+        {
+            uint32_t codePoint = 0;
+            if (End - Position < 4 || std::from_chars(Position, Position + 4, codePoint, 16).ptr != Position + 4)
+                return Fail();
+
+            Position += 4;
+
+            //  Surrogate pairs are not combined, each half is encoded as is. Scenes are not expected to have anything outside of BMP anyway.
+            if (codePoint < 0x80)
+                DecodedString.push_back((char)codePoint);
+            else if (codePoint < 0x800)
+            {
+                DecodedString.push_back((char)(0xC0 | (codePoint >> 6)));
+                DecodedString.push_back((char)(0x80 | (codePoint & 0x3F)));
+            }
+            else
+            {
+                DecodedString.push_back((char)(0xE0 | (codePoint >> 12)));
+                DecodedString.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+                DecodedString.push_back((char)(0x80 | (codePoint & 0x3F)));
+            }
+            break;
+        }
+        default:
+            DecodedString.push_back(escaped);
+            break;
+        }
+    }
+
+    if (Position >= End)
+        return Fail();
+
+    Position++;
+    value = DecodedString;
+    return true;
+}
+
+bool JsonStreamReader::ReadNumberToken(std::string_view& token)
+{
+    if (!Peek())
+        return Fail();
+
+    const char* tokenStart = Position;
+    while (Position < End && (isdigit((unsigned char)*Position) || *Position == '-' || *Position == '+' || *Position == '.' || *Position == 'e' || *Position == 'E'))
+        Position++;
+
+    if (Position == tokenStart)
+        return Fail();
+
+    token = std::string_view(tokenStart, Position - tokenStart);
+    return true;
+}
+
+bool JsonStreamReader::ReadUInt64(uint64_t& value)
+{
+    std::string_view token;
+    if (!ReadNumberToken(token))
+        return false;
+
+    //  Type hashes don't fit into a double, so integers are read as they are and anything else is converted.
+    const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (result.ec == std::errc() && result.ptr == token.data() + token.size())
+        return true;
+
+    double_t doubleValue = 0;
+    if (std::from_chars(token.data(), token.data() + token.size(), doubleValue).ec != std::errc())
+        return Fail();
+
+    value = doubleValue > 0 ? (uint64_t)doubleValue : 0;
+    return true;
+}
+
+bool JsonStreamReader::ReadFloat(float_t& value)
+{
+    std::string_view token;
+    if (!ReadNumberToken(token))
+        return false;
+
+    return std::from_chars(token.data(), token.data() + token.size(), value).ec == std::errc() || Fail();
+}
+
+bool JsonStreamReader::SkipLiteral(const std::string_view& literal)
+{
+    if ((size_t)(End - Position) < literal.size() || std::string_view(Position, literal.size()) != literal)
+        return Fail();
+
+    Position += literal.size();
+    return true;
+}
+
+bool JsonStreamReader::SkipValue()
+{
+    switch (Peek())
+    {
+    case '{':
+    {
+        std::string_view key;
+        for (bool hasKey = BeginObject(key); hasKey; hasKey = NextKey(key))
+            SkipValue();
+
+        return !Failed;
+    }
+    case '[':
+        for (bool hasElement = BeginArray(); hasElement; hasElement = NextElement())
+            SkipValue();
+
+        return !Failed;
+    case '"':
+    {
+        std::string_view value;
+        return ReadString(value);
+    }
+    case 't':
+        return SkipLiteral("true");
+    case 'f':
+        return SkipLiteral("false");
+    case 'n':
+        return SkipLiteral("null");
+    default:
+    {
+        std::string_view token;
+        return ReadNumberToken(token);
+    }
+    }
+}
+
+size_t JsonStreamReader::GetLine() const
+{
+    return std::count(Begin, Position, '\n') + 1;
+}
@@ -0,0 +1,57 @@
+#pragma once
+/*
+* File: JsonStreamReader.h
+* Purpose: read JSON text front to back, one value at a time, without building a tree out of it.
+*/
+#include "Generic.h"
+
+//  Values are read in the order they appear in the buffer, caller decides what to do with each one as it goes, so nothing but the current value is kept.
+//  Containers are walked like this:
+//      std::string_view key;
+//      for (bool hasKey = reader.BeginObject(key); hasKey; hasKey = reader.NextKey(key))
+//          ...read or skip the value of 'key'...
+//  Any malformed input makes every following call fail, so loops like the one above always end. Check 'HasFailed' when done.
+class JsonStreamReader
+{
+private:
+    const char*     Position;
+    const char*     End;
+    const char*     Begin;
+    bool            Failed;
+    //  Strings with escape sequences are decoded here, so returned view is only valid until next string is read.
+    std::string     DecodedString;
+
+    //  Skip whitespace and peek at the next character, zero at the end of buffer.
+    char            Peek();
+    bool            Expect(const char character);
+    bool            Fail();
+    bool            ReadNumberToken(std::string_view& token);
+    bool            ReadKey(std::string_view& key);
+    bool            SkipLiteral(const std::string_view& literal);
+
+public:
+    JsonStreamReader(const char* data, const size_t size);
+
+    //  Opening bracket and the first key or element. Returns false if container is empty or it's not there.
+    bool            BeginObject(std::string_view& key);
+    bool            BeginArray();
+
+    //  Separator and the next key or element. Returns false once closing bracket is read.
+    bool            NextKey(std::string_view& key);
+    bool            NextElement();
+
+    bool            ReadString(std::string_view& value);
+    bool            ReadUInt64(uint64_t& value);
+    bool            ReadFloat(float_t& value);
+
+    //  Skip whatever value is next, including nested containers.
+    bool            SkipValue();
+
+    inline const bool HasFailed() const
+    {
+        return Failed;
+    }
+
+    //  Line the reader stopped at, for error messages.
+    size_t          GetLine() const;
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Generic.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <queue>
+#include <atomic>
+
+//  A fixed set of worker threads that execute queued jobs.
+//  Jobs with higher priority are started first, jobs with the same priority are started in order they were submitted.
+//  Pool is created with a number of threads and it's not possible to change that number afterwards.
+class ThreadPool
+{
+private:
+    struct tQueuedJob
+    {
+        int32_t                 Priority;
+        uint64_t                Sequence;
+        std::function<void()>   Job;
+
+        inline bool operator<(const tQueuedJob& other) const
+        {
+            return Priority != other.Priority ? Priority < other.Priority : Sequence > other.Sequence;
+        }
+    };
+
+    std::vector<std::thread>            Workers;
+    std::priority_queue<tQueuedJob>     Jobs;
+    uint64_t                            JobsSubmitted;
+    std::mutex                          JobsMutex;
+    std::condition_variable             JobsAvailable;
+    bool                                Terminate;
+
+    void WorkerThread()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+
+            {
+                std::unique_lock<std::mutex> lock(JobsMutex);
+                JobsAvailable.wait(lock, [this]() { return Terminate || !Jobs.empty(); });
+
+                if (Terminate && Jobs.empty())
+                    return;
+
+                //  Queue only hands out const references, the job is moved out right before it's popped.
+                job = std::move(const_cast<tQueuedJob&>(Jobs.top()).Job);
+                Jobs.pop();
+            }
+
+            job();
+        }
+    }
+
+public:
+    explicit ThreadPool(const uint32_t threadsCount)
+    {
+        Terminate = false;
+        JobsSubmitted = 0;
+
+        for (uint32_t i = 0; i < threadsCount; i++)
+            Workers.emplace_back(&ThreadPool::WorkerThread, this);
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //  Any jobs still queued are finished before the threads exit.
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(JobsMutex);
+            Terminate = true;
+        }
+
+        JobsAvailable.notify_all();
+
+        for (auto& worker : Workers)
+            worker.join();
+    }
+
+    inline const size_t GetThreadsCount() const
+    {
+        return Workers.size();
+    }
+
+    void Submit(std::function<void()> job, const int32_t priority = 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(JobsMutex);
+            Jobs.push({ priority, JobsSubmitted++, std::move(job) });
+        }
+
+        JobsAvailable.notify_one();
+    }
+
+    //  Call 'job' once for every index in [0, count) and return after all calls are done.
+    //  The calling thread takes indices too, so this is safe to call from inside a job running on this same pool:
+    //  the caller never waits for an index that nobody has started working on.
+    void ParallelFor(const size_t count, const std::function<void(const size_t)>& job)
+    {
+        if (!count)
+            return;
+
+        struct tParallelForState
+        {
+            std::atomic_size_t      NextIndex = 0;
+            std::atomic_size_t      DoneCount = 0;
+            std::mutex              DoneMutex;
+            std::condition_variable AllDone;
+        };
+
+        //  Helper jobs may get to run after the caller has already returned, so the state is shared with them.
+        const auto state = std::make_shared<tParallelForState>();
+        const auto RunIndices = [state, count, &job]()
+            {
+                size_t index;
+                while ((index = state->NextIndex++) < count)
+                {
+                    job(index);
+
+                    if (++state->DoneCount == count)
+                    {
+                        std::lock_guard<std::mutex> lock(state->DoneMutex);
+                        state->AllDone.notify_all();
+                    }
+                }
+            };
+
+        //  A helper that starts late only finds no indices left, so it never touches 'job' after it went out of scope.
+        const size_t helpersCount = std::min(Workers.size(), count - 1);
+        for (size_t i = 0; i < helpersCount; i++)
+            Submit(RunIndices);
+
+        RunIndices();
+
+        std::unique_lock<std::mutex> lock(state->DoneMutex);
+        state->AllDone.wait(lock, [&state, count]() { return state->DoneCount == count; });
+    }
+};
@@ -0,0 +1,243 @@
+/*
+* File: Packer.cpp
+* Purpose: builds a single packed archive (see AssetArchive.h) out of the assets directory. Text files and scenes are cooked on the way (see TextAsset.h and SceneFormat.h).
+* Usage: MyTextGamePacker [assets directory] [output file]
+*        MyTextGamePacker --cook-text <text file> [output file]
+*        MyTextGamePacker --cook-scene <scene file> [output file]
+*/
+#include "Generic.h"
+#include "Logger.h"
+#include "AssetArchive.h"
+#include "TextAsset.h"
+#include "SceneFormat.h"
+
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+
+struct PackerFileEntry
+{
+    std::string             RelativePath;
+    std::filesystem::path   SourcePath;
+    ArchiveTocEntry         TocEntry;
+};
+
+static bool CollectFiles(const std::filesystem::path& assetsDirectory, std::vector<PackerFileEntry>& files)
+{
+    std::error_code errorCode;
+    for (const auto& directoryEntry : std::filesystem::recursive_directory_iterator(assetsDirectory, errorCode))
+    {
+        if (!directoryEntry.is_regular_file())
+            continue;
+
+        //  Paths are always stored relative to assets directory and with forward slashes, regardless of platform.
+        const std::string relativePath = std::filesystem::relative(directoryEntry.path(), assetsDirectory).generic_string();
+        files.push_back({ relativePath, directoryEntry.path(), { AssetArchive::HashPath(relativePath), 0, (uint64_t)directoryEntry.file_size() } });
+    }
+
+    if (errorCode)
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Can't read \"{}\": {}", assetsDirectory.string(), errorCode.message());
+        return false;
+    }
+
+    std::sort(files.begin(), files.end(), [](const PackerFileEntry& a, const PackerFileEntry& b) { return a.TocEntry.PathHash < b.TocEntry.PathHash; });
+
+    //  Table of contents is keyed by hash only, so two paths with the same hash can't be told apart.
+    for (size_t i = 1; i < files.size(); i++)
+    {
+        if (files[i].TocEntry.PathHash == files[i - 1].TocEntry.PathHash)
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Path hash collision between \"{}\" and \"{}\"!", files[i - 1].RelativePath, files[i].RelativePath);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//  Replace plain text in 'fileData' with it's cooked form. Already cooked text is left as is.
+static bool CookText(const std::string& name, std::vector<char>& fileData)
+{
+    if (TextAsset::IsCooked((const uint8_t*)fileData.data(), fileData.size()))
+        return true;
+
+    TextAsset textAsset;
+    textAsset.SetData(name, eAssetType::TEXT);
+    textAsset.SetDataSize(fileData.size());
+    textAsset.ParseData((const uint8_t*)fileData.data());
+
+    std::vector<char> cookedData;
+    textAsset.Cook(cookedData);
+    fileData = std::move(cookedData);
+
+    return true;
+}
+
+//  Replace scene text in 'fileData' with it's cooked form. Already cooked scene is left as is.
+static bool CookScene(const std::string& name, std::vector<char>& fileData)
+{
+    if (SceneFormat::IsCooked((const uint8_t*)fileData.data(), fileData.size()))
+        return true;
+
+    Arena arena;
+    std::vector<EntityReferenceData> entities;
+    std::vector<ScriptReferenceData> scripts;
+    size_t errorLine = 0;
+
+    if (!SceneFormat::ReadText(fileData.data(), fileData.size(), arena, entities, scripts, errorLine))
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Failed to parse \"{}\", error at line {}!", name, errorLine);
+        return false;
+    }
+
+    std::vector<char> cookedData;
+    SceneFormat::Cook(entities, scripts, cookedData);
+    fileData = std::move(cookedData);
+
+    return true;
+}
+
+static bool IsTextFile(const std::string& relativePath)
+{
+    return relativePath.starts_with("text/") && relativePath.ends_with(".txt");
+}
+
+static bool IsSceneFile(const std::string& relativePath)
+{
+    return relativePath.starts_with("scenes/") && relativePath.ends_with(".scene");
+}
+
+static bool WriteArchive(const std::string& outputPath, std::vector<PackerFileEntry>& files)
+{
+    std::ofstream outFile(outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outFile.is_open())
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Can't create \"{}\"!", outputPath);
+        return false;
+    }
+
+    ArchiveHeader header = { ArchiveMagic, ArchiveVersion, files.size(), 0 };
+    outFile.write((const char*)&header, sizeof(header));
+
+    const auto PadToAlignment = [&outFile]()
+        {
+            static const char padding[ArchiveDataAlignment] = {};
+            const uint64_t position = (uint64_t)outFile.tellp();
+            const uint64_t remainder = position % ArchiveDataAlignment;
+            if (remainder)
+                outFile.write(padding, ArchiveDataAlignment - remainder);
+        };
+
+    std::vector<char> fileData;
+    for (auto& file : files)
+    {
+        std::ifstream inFile(file.SourcePath, std::ios::in | std::ios::binary);
+        if (!inFile.is_open())
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Can't open \"{}\"!", file.SourcePath.string());
+            return false;
+        }
+
+        fileData.resize(file.TocEntry.Size);
+        inFile.read(fileData.data(), fileData.size());
+
+        //  File changed since it was listed, size in the table would be wrong.
+        if ((size_t)inFile.gcount() != fileData.size())
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Can't read \"{}\", got {} of {} bytes!", file.SourcePath.string(), inFile.gcount(), fileData.size());
+            return false;
+        }
+
+        //  Path stays the same, so nothing referencing this file has to change.
+        if (IsTextFile(file.RelativePath))
+        {
+            CookText(file.RelativePath, fileData);
+            file.TocEntry.Size = fileData.size();
+        }
+
+        if (IsSceneFile(file.RelativePath))
+        {
+            if (!CookScene(file.RelativePath, fileData))
+                return false;
+
+            file.TocEntry.Size = fileData.size();
+        }
+
+        PadToAlignment();
+        file.TocEntry.Offset = (uint64_t)outFile.tellp();
+        outFile.write(fileData.data(), fileData.size());
+
+        Logger::TRACE(TAG_FUNCTION_NAME, "{} ({} bytes) -- OK", file.RelativePath, file.TocEntry.Size);
+    }
+
+    PadToAlignment();
+    header.TocOffset = (uint64_t)outFile.tellp();
+    for (const auto& file : files)
+        outFile.write((const char*)&file.TocEntry, sizeof(ArchiveTocEntry));
+
+    //  Now that the table offset is known, rewrite the header.
+    outFile.seekp(0);
+    outFile.write((const char*)&header, sizeof(header));
+
+    return outFile.good();
+}
+
+static bool CookFile(const std::string& inputPath, const std::string& outputPath, const std::function<bool(const std::string&, std::vector<char>&)>& cookFunction)
+{
+    std::ifstream inFile(inputPath, std::ios::in | std::ios::binary);
+    if (!inFile.is_open())
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Can't open \"{}\"!", inputPath);
+        return false;
+    }
+
+    std::vector<char> fileData((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+    if (!cookFunction(inputPath, fileData))
+        return false;
+
+    std::ofstream outFile(outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outFile.is_open())
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Can't create \"{}\"!", outputPath);
+        return false;
+    }
+
+    outFile.write(fileData.data(), fileData.size());
+
+    return outFile.good();
+}
+
+int main(const int argc, const char** argv)
+{
+    if (argc > 2 && (std::string_view(argv[1]) == "--cook-text" || std::string_view(argv[1]) == "--cook-scene"))
+    {
+        const bool isText = std::string_view(argv[1]) == "--cook-text";
+        const std::string inputPath = argv[2];
+        const std::string outputPath = argc > 3 ? argv[3] : std::filesystem::path(inputPath).replace_extension(isText ? ".textbin" : ".scenebin").string();
+
+        if (!CookFile(inputPath, outputPath, isText ? CookText : CookScene))
+            return 1;
+
+        Logger::TRACE(TAG_FUNCTION_NAME, "Cooked \"{}\" into \"{}\".", inputPath, outputPath);
+        return 0;
+    }
+
+    const std::filesystem::path assetsDirectory = argc > 1 ? argv[1] : "./assets/";
+    const std::string outputPath = argc > 2 ? argv[2] : "assets.pak";
+
+    std::vector<PackerFileEntry> files;
+    if (!CollectFiles(assetsDirectory, files))
+        return 1;
+
+    if (!WriteArchive(outputPath, files))
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Failed to write \"{}\"!", outputPath);
+        return 1;
+    }
+
+    Logger::TRACE(TAG_FUNCTION_NAME, "Packed {} files into \"{}\".", files.size(), outputPath);
+
+    return 0;
+}
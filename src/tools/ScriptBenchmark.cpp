@@ -0,0 +1,165 @@
+/*
+* File: ScriptBenchmark.cpp
+* Purpose: measures how many bytecode instructions per second the script virtual machine (see VirtualMachine.h) gets through.
+*          Workloads are assembled by hand, so numbers only change when the machine itself does, not the parser or compiler.
+* Usage: MyTextGameScriptBenchmark [iterations]
+*/
+#include "Generic.h"
+#include "Logger.h"
+#include "VirtualMachine.h"
+#include "NativeBinding.h"
+#include "StringTable.h"
+
+#include <charconv>
+
+using namespace Scripting;
+
+//  Every function body is this many copies of a workload block, so call overhead is spread thin.
+static constexpr uint32_t BlocksPerFunction = 256;
+
+//  Every opcode but calls: constants, moves, comparisons and both kinds of jumps, none of the conditional ones taken.
+static void AssembleDispatchWorkload(CompiledScript& script)
+{
+    script.Constants.push_back(Value::MakeNumber(1.0));
+
+    CompiledFunction function = { StringTable::Intern("dispatch"), (uint32_t)script.Code.size(), 0, 0, 5 };
+    for (uint32_t block = 0; block < BlocksPerFunction; block++)
+    {
+        script.Code.push_back(EncodeInstruction(OP_LOAD_CONSTANT, 0, (uint16_t)0));
+        script.Code.push_back(EncodeInstruction(OP_MOVE, 1, 0, 0));
+        script.Code.push_back(EncodeInstruction(OP_EQUAL, 2, 0, 1));
+        script.Code.push_back(EncodeInstruction(OP_LESS_OR_EQUAL, 3, 0, 1));
+        script.Code.push_back(EncodeInstruction(OP_AND, 4, 2, 3));
+        script.Code.push_back(EncodeInstruction(OP_JUMP_IF_FALSE, 4, (uint16_t)0));
+
+        const uint32_t nextInstruction = (uint32_t)script.Code.size() + 1 - function.CodeOffset;
+        script.Code.push_back(EncodeInstruction(OP_JUMP, 0, (uint16_t)nextInstruction));
+    }
+
+    script.Code.push_back(EncodeInstruction(OP_RETURN, 0, 0, 0));
+    function.CodeSize = (uint32_t)script.Code.size() - function.CodeOffset;
+    script.Functions.push_back(function);
+}
+
+//  Script to script calls, already linked, with one argument each.
+static void AssembleCallWorkload(CompiledScript& script)
+{
+    const uint32_t calleeIndex = (uint32_t)script.Functions.size();
+    CompiledFunction callee = { StringTable::Intern("callee"), (uint32_t)script.Code.size(), 0, 1, 2 };
+    script.Code.push_back(EncodeInstruction(OP_MOVE, 1, 0, 0));
+    script.Code.push_back(EncodeInstruction(OP_RETURN, 0, 0, 0));
+    callee.CodeSize = (uint32_t)script.Code.size() - callee.CodeOffset;
+    script.Functions.push_back(callee);
+
+    script.CallSites.push_back({ callee.NameId, calleeIndex, 0, 1, 0 });
+
+    CompiledFunction caller = { StringTable::Intern("calls"), (uint32_t)script.Code.size(), 0, 0, 2 };
+    for (uint32_t block = 0; block < BlocksPerFunction; block++)
+        script.Code.push_back(EncodeInstruction(OP_CALL, 1, (uint16_t)(script.CallSites.size() - 1)));
+
+    script.Code.push_back(EncodeInstruction(OP_RETURN, 0, 0, 0));
+    caller.CodeSize = (uint32_t)script.Code.size() - caller.CodeOffset;
+    script.Functions.push_back(caller);
+}
+
+//  Bound the same way engine natives are, so this measures marshalling as well as the call.
+static double AddNumbers(const double left, const double right)
+{
+    return left + right;
+}
+
+//  Native calls with two arguments and a result.
+static void AssembleNativeWorkload(CompiledScript& script)
+{
+    const uint16_t constantIndex = (uint16_t)script.Constants.size();
+    script.Constants.push_back(Value::MakeNumber(2.0));
+
+    const uint32_t nameId = StringTable::Intern("AddNumbers");
+    script.CallSites.push_back({ nameId, Natives::Find(nameId), 0, 2, 2 });
+
+    CompiledFunction function = { StringTable::Intern("natives"), (uint32_t)script.Code.size(), 0, 0, 3 };
+    script.Code.push_back(EncodeInstruction(OP_LOAD_CONSTANT, 0, constantIndex));
+    script.Code.push_back(EncodeInstruction(OP_MOVE, 1, 0, 0));
+    for (uint32_t block = 0; block < BlocksPerFunction; block++)
+        script.Code.push_back(EncodeInstruction(OP_CALL_NATIVE, 0, (uint16_t)(script.CallSites.size() - 1)));
+
+    script.Code.push_back(EncodeInstruction(OP_RETURN, 0, 0, 0));
+    function.CodeSize = (uint32_t)script.Code.size() - function.CodeOffset;
+    script.Functions.push_back(function);
+}
+
+//  Every instruction of the workload runs exactly once per call, so the count is known without the machine counting anything.
+static bool RunWorkload(VirtualMachine& machine, const CompiledScript& script, const std::string_view& functionName, const uint64_t instructionsPerCall, const uint64_t iterations)
+{
+    const CompiledFunction* function = script.FindFunction(StringTable::Intern(functionName));
+    if (!function)
+    {
+        Logger::ERROR(TAG_FUNCTION_NAME, "Workload '{}' is missing!", functionName);
+        return false;
+    }
+
+    //  Warm up caches and branch predictors first.
+    for (uint64_t iteration = 0; iteration < iterations / 10 + 1; iteration++)
+        machine.Call(script, *function, {});
+
+    const auto timeStart = std::chrono::steady_clock::now();
+    for (uint64_t iteration = 0; iteration < iterations; iteration++)
+    {
+        if (!machine.Call(script, *function, {}))
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Workload '{}' failed: {}", functionName, machine.GetLastError());
+            return false;
+        }
+    }
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - timeStart;
+
+    const uint64_t instructions = instructionsPerCall * iterations;
+    Logger::TRACE(TAG_FUNCTION_NAME, "{}: {} instructions in {:.3f} s, {:.1f} million instructions per second.", functionName, instructions, duration.count(), instructions / duration.count() / 1e6);
+
+    return true;
+}
+
+int main(const int argc, const char** argv)
+{
+    uint64_t iterations = 20000;
+    if (argc > 1)
+    {
+        const std::string_view argument = argv[1];
+        const auto result = std::from_chars(argument.data(), argument.data() + argument.length(), iterations);
+        if (result.ec != std::errc() || !iterations)
+        {
+            Logger::ERROR(TAG_FUNCTION_NAME, "Iterations count \"{}\" is not a positive number!", argument);
+            return 1;
+        }
+    }
+
+#if defined(SCRIPT_THREADED_DISPATCH)
+    Logger::TRACE(TAG_FUNCTION_NAME, "Dispatch: computed goto, {} iterations.", iterations);
+#else
+    Logger::TRACE(TAG_FUNCTION_NAME, "Dispatch: switch, {} iterations.", iterations);
+#endif
+
+    if (!RegisterNative<&AddNumbers>("AddNumbers"))
+        return 1;
+
+    CompiledScript script;
+    AssembleDispatchWorkload(script);
+    AssembleCallWorkload(script);
+    AssembleNativeWorkload(script);
+
+    VirtualMachine machine;
+
+    //  Seven instructions per block, plus return.
+    if (!RunWorkload(machine, script, "dispatch", BlocksPerFunction * 7 + 1, iterations))
+        return 1;
+
+    //  Call, callee's two instructions per block, plus return.
+    if (!RunWorkload(machine, script, "calls", BlocksPerFunction * 3 + 1, iterations))
+        return 1;
+
+    //  Two to set up the arguments, a call per block, plus return.
+    if (!RunWorkload(machine, script, "natives", BlocksPerFunction + 3, iterations))
+        return 1;
+
+    return 0;
+}
@@ -1,6 +1,41 @@
 #include <gtest/gtest.h>
 #include <math.h>
 
+#include "Arena.h"
+#include "AssetArchive.h"
+#include "AssetCache.h"
+#include "AssetHandleTable.h"
+#include "AssetRequest.h"
+#include "DataManifest.h"
+#include "FileMapping.h"
+#include "JsonStreamReader.h"
+#include "Localization.h"
+#include "NativeBinding.h"
+#include "SceneFormat.h"
+#include "SceneGraph.h"
+#include "ScriptAsset.h"
+#include "ScriptLexer.h"
+#include "StringTable.h"
+#include "VirtualMachine.h"
+#include "TextAsset.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+//  Files tests read are put into the temporary directory, every test uses names of it's own.
+static std::string WriteTestFile(const std::string& fileName, const std::vector<uint8_t>& data)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / fileName;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write((const char*)data.data(), data.size());
+
+    return path.string();
+}
+
 //  Test math lib here.
 TEST(BasicMathTest, BasicAssertions)
 {
@@ -13,9 +48,1628 @@ TEST(BasicFailTest, BasicAssertions)
     EXPECT_NE(2 + 2, 5);
 }
 
+TEST(FileMappingTest, ReadFileDoesntChangeWithIt)
+{
+    const std::string path = WriteTestFile("FileMappingRead.txt", { 'a', 'b', 'c', 'd' });
+    FileErrorType error = -1;
+    const auto file = FileMapping::Read(path, error);
+    ASSERT_TRUE(file);
+    EXPECT_EQ(error, 0);
+
+    //  File is rewritten shorter, as an editor saving it would.
+    WriteTestFile("FileMappingRead.txt", { 'x', 'y' });
+    ASSERT_EQ(file->GetSize(), 4u);
+    EXPECT_EQ(std::string_view((const char*)file->GetData(), file->GetSize()), "abcd");
+
+    const auto emptyFile = FileMapping::Read(WriteTestFile("FileMappingReadEmpty.txt", {}), error);
+    ASSERT_TRUE(emptyFile);
+    EXPECT_EQ(emptyFile->GetSize(), 0u);
+    EXPECT_EQ(emptyFile->GetData(), nullptr);
+
+    EXPECT_FALSE(FileMapping::Read(path + ".missing", error));
+    EXPECT_NE(error, 0);
+}
+
+//  Archive laid out the same way packer does it, 'files' are pairs of path and contents.
+static std::vector<uint8_t> MakeArchive(const std::vector<std::pair<std::string, std::string>>& files)
+{
+    std::vector<uint8_t> archive(sizeof(ArchiveHeader));
+    std::vector<ArchiveTocEntry> toc;
+    for (const auto& [path, contents] : files)
+    {
+        archive.resize((archive.size() + ArchiveDataAlignment - 1) & ~(ArchiveDataAlignment - 1));
+        toc.push_back({ AssetArchive::HashPath(path), archive.size(), contents.size() });
+        archive.insert(archive.end(), contents.begin(), contents.end());
+    }
+
+    std::sort(toc.begin(), toc.end(), [](const ArchiveTocEntry& a, const ArchiveTocEntry& b) { return a.PathHash < b.PathHash; });
+
+    const ArchiveHeader header = { ArchiveMagic, ArchiveVersion, toc.size(), archive.size() };
+    memcpy(archive.data(), &header, sizeof(header));
+    archive.insert(archive.end(), (const uint8_t*)toc.data(), (const uint8_t*)(toc.data() + toc.size()));
+
+    return archive;
+}
+
+TEST(AssetArchiveTest, FindsEveryPackedFile)
+{
+    const std::vector<std::pair<std::string, std::string>> files = {
+        { "startup.dat", "scene:menu.scene" },
+        { "scenes/menu.scene", "{}" },
+        { "text/intro.txt", "TitleHeader=My Text Game" }
+    };
+
+    AssetArchive archive;
+    ASSERT_TRUE(archive.Open(WriteTestFile("ArchiveFindsEveryPackedFile.pak", MakeArchive(files))));
+
+    for (const auto& [path, contents] : files)
+    {
+        const auto file = archive.Find(path);
+        ASSERT_NE(file, nullptr) << path;
+        EXPECT_EQ(std::string_view((const char*)file->GetData(), file->GetSize()), contents);
+        EXPECT_EQ((uintptr_t)file->GetData() % ArchiveDataAlignment, 0u);
+    }
+
+    EXPECT_EQ(archive.Find("text/missing.txt"), nullptr);
+}
+
+TEST(AssetArchiveTest, RejectsDamagedTableOfContents)
+{
+    std::vector<uint8_t> data = MakeArchive({ { "startup.dat", "scene:menu.scene" } });
+    ((ArchiveHeader*)data.data())->EntriesCount = 1000;
+
+    AssetArchive archive;
+    EXPECT_FALSE(archive.Open(WriteTestFile("ArchiveRejectsDamagedToc.pak", data)));
+    EXPECT_FALSE(archive.IsOpen());
+
+    ((ArchiveHeader*)data.data())->EntriesCount = 1;
+    ((ArchiveHeader*)data.data())->TocOffset = data.size() + 1;
+    EXPECT_FALSE(archive.Open(WriteTestFile("ArchiveRejectsDamagedToc.pak", data)));
+}
+
+TEST(AssetArchiveTest, RejectsUnknownVersion)
+{
+    std::vector<uint8_t> data = MakeArchive({ { "startup.dat", "scene:menu.scene" } });
+    ((ArchiveHeader*)data.data())->Version = ArchiveVersion + 1;
+
+    AssetArchive archive;
+    EXPECT_FALSE(archive.Open(WriteTestFile("ArchiveRejectsUnknownVersion.pak", data)));
+}
+
+static HashType HashName(const std::string_view& name)
+{
+    return xxh64::hash(name.data(), name.length(), 0);
+}
+
+//  Asset that doesn't parse anything, it only keeps count of how many of it are alive.
+class TestAsset : public AssetInterface
+{
+public:
+    static constexpr eAssetType ClassAssetType = eAssetType::GFX;
+    static inline std::atomic_int32_t LiveCount = 0;
+
+    TestAsset(const std::string& name, const size_t dataSize, const eAssetType assetType = ClassAssetType)
+    {
+        SetData(name, assetType);
+        SetDataSize(dataSize);
+        LiveCount++;
+    }
+
+    virtual         ~TestAsset()
+    {
+        LiveCount--;
+    }
+
+    virtual void    ParseData(const uint8_t* data) override
+    {
+    }
+};
+
+//  Cache is shared by every test, so each one uses asset names of it's own and only looks at how counters change.
+TEST(AssetCacheTest, SharedAssetIsLoadedOnce)
+{
+    const HashType nameHash = HashName("gfx/cache/shared.png");
+    const uint64_t hits = AssetCache::GetHits();
+    const uint64_t misses = AssetCache::GetMisses();
+    const size_t residentCount = AssetCache::GetResidentCount();
+    const size_t residentBytes = AssetCache::GetResidentBytes(eAssetType::GFX);
+    const int32_t liveCount = TestAsset::LiveCount;
+
+    int32_t loadCount = 0;
+    const auto Load = [&loadCount]() { loadCount++; return new TestAsset("gfx/cache/shared.png", 100); };
+    AssetRef first = AssetCache::Acquire(nameHash, Load);
+    AssetRef second = AssetCache::Acquire(nameHash, Load);
+
+    ASSERT_TRUE(first);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(loadCount, 1);
+    EXPECT_EQ(AssetCache::GetHits(), hits + 1);
+    EXPECT_EQ(AssetCache::GetMisses(), misses + 1);
+    EXPECT_EQ(AssetCache::Find(nameHash), first);
+    EXPECT_EQ(AssetCache::GetResidentCount(), residentCount + 1);
+    EXPECT_EQ(AssetCache::GetResidentBytes(eAssetType::GFX), residentBytes + 100);
+
+    //  Asset is freed with the last reference to it, not before.
+    first.reset();
+    EXPECT_EQ(TestAsset::LiveCount, liveCount + 1);
+    second.reset();
+    EXPECT_EQ(TestAsset::LiveCount, liveCount);
+    EXPECT_FALSE(AssetCache::Find(nameHash));
+    EXPECT_EQ(AssetCache::GetResidentCount(), residentCount);
+    EXPECT_EQ(AssetCache::GetResidentBytes(eAssetType::GFX), residentBytes);
+
+    //  Once freed, it's loaded again.
+    EXPECT_TRUE(AssetCache::Acquire(nameHash, Load));
+    EXPECT_EQ(loadCount, 2);
+}
+
+TEST(AssetCacheTest, ConcurrentAcquireWaitsForLoad)
+{
+    const HashType nameHash = HashName("gfx/cache/concurrent.png");
+
+    //  First load is held up until the second thread asked for the same asset.
+    std::mutex gate;
+    std::unique_lock<std::mutex> gateLock(gate);
+    std::atomic_bool loadStarted = false;
+    std::atomic_int32_t loadCount = 0;
+    const auto Load = [&]()
+        {
+            loadCount++;
+            loadStarted = true;
+            std::lock_guard<std::mutex> lock(gate);
+            return new TestAsset("gfx/cache/concurrent.png", 10);
+        };
+
+    AssetRef firstAsset;
+    std::thread firstThread([&]() { firstAsset = AssetCache::Acquire(nameHash, Load); });
+    while (!loadStarted)
+        std::this_thread::yield();
+
+    AssetRef secondAsset;
+    std::atomic_bool secondDone = false;
+    std::thread secondThread([&]() { secondAsset = AssetCache::Acquire(nameHash, Load); secondDone = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(secondDone);
+
+    gateLock.unlock();
+    firstThread.join();
+    secondThread.join();
+
+    ASSERT_TRUE(firstAsset);
+    EXPECT_EQ(firstAsset, secondAsset);
+    EXPECT_EQ(loadCount, 1);
+}
+
+TEST(AssetCacheTest, FailedLoadIsTriedAgain)
+{
+    const HashType nameHash = HashName("gfx/cache/failed.png");
+
+    EXPECT_FALSE(AssetCache::Acquire(nameHash, []() { return (AssetInterface*)nullptr; }));
+    EXPECT_THROW(AssetCache::Acquire(nameHash, []() -> AssetInterface* { throw std::runtime_error("broken file"); }), std::runtime_error);
+
+    const AssetRef asset = AssetCache::Acquire(nameHash, []() { return new TestAsset("gfx/cache/failed.png", 1); });
+    ASSERT_TRUE(asset);
+    EXPECT_EQ(asset->GetNameHash(), nameHash);
+}
+
+TEST(AssetCacheTest, ReplacedAssetOutlivesEntry)
+{
+    const HashType nameHash = HashName("gfx/cache/replaced.png");
+    const int32_t liveCount = TestAsset::LiveCount;
+
+    AssetRef previousAsset = AssetCache::Acquire(nameHash, []() { return new TestAsset("gfx/cache/replaced.png", 1); });
+    const AssetRef asset = AssetCache::Replace(nameHash, new TestAsset("gfx/cache/replaced.png", 2));
+    EXPECT_NE(previousAsset, asset);
+    EXPECT_EQ(AssetCache::Find(nameHash), asset);
+
+    //  Freeing the previous instance leaves the entry to the new one.
+    previousAsset.reset();
+    EXPECT_EQ(TestAsset::LiveCount, liveCount + 1);
+    EXPECT_EQ(AssetCache::Find(nameHash), asset);
+    EXPECT_EQ(AssetCache::Acquire(nameHash, []() { return (AssetInterface*)nullptr; }), asset);
+}
+
+static AssetRef MakeTableAsset(const std::string& name, const size_t dataSize = 1, const eAssetType assetType = TestAsset::ClassAssetType)
+{
+    return std::make_shared<TestAsset>(name, dataSize, assetType);
+}
+
+TEST(AssetHandleTableTest, HandlesFindTheirAsset)
+{
+    AssetHandleTable table(nullptr);
+    const AssetRef asset = MakeTableAsset("gfx/table/first.png");
+    const auto text = std::make_shared<TextAsset>();
+    text->SetData("text/table/first.txt", eAssetType::TEXT);
+
+    const auto handle = table.Add(asset);
+    const auto textHandle = table.Add(text);
+    EXPECT_FALSE(handle.IsNull());
+    EXPECT_EQ(table.Add(MakeTableAsset("gfx/table/first.png")), handle);
+    EXPECT_EQ(table.GetCount(), 2u);
+
+    EXPECT_EQ(table.Get(handle), asset.get());
+    EXPECT_EQ(table.Get(handle.As<TestAsset>()), asset.get());
+    EXPECT_EQ(table.Get(handle.As<TextAsset>()), nullptr);
+    EXPECT_EQ(table.Get(textHandle.As<TextAsset>()), text.get());
+    EXPECT_EQ(table.Find<TestAsset>(asset->GetNameHash()), handle.As<TestAsset>());
+    EXPECT_TRUE(table.Find<TextAsset>(asset->GetNameHash()).IsNull());
+    EXPECT_TRUE(table.Find(HashName("gfx/table/missing.png")).IsNull());
+    EXPECT_EQ(table.Get(AssetHandle<AssetInterface>()), nullptr);
+
+    //  Replaced asset is found through the same handle.
+    const AssetRef reloaded = MakeTableAsset("gfx/table/first.png");
+    EXPECT_TRUE(table.Replace(reloaded));
+    EXPECT_EQ(table.Get(handle), reloaded.get());
+    EXPECT_FALSE(table.Replace(MakeTableAsset("gfx/table/other.png")));
+}
+
+TEST(AssetHandleTableTest, RemovedAssetHandlesAreStale)
+{
+    AssetHandleTable table(nullptr);
+    const auto handle = table.Add(MakeTableAsset("gfx/table/removed.png"));
+    EXPECT_TRUE(table.Remove(handle));
+    EXPECT_FALSE(table.Remove(handle));
+    EXPECT_EQ(table.Get(handle), nullptr);
+    EXPECT_EQ(table.GetResident(handle), nullptr);
+    EXPECT_TRUE(table.Find(HashName("gfx/table/removed.png")).IsNull());
+
+    //  Slot is used again, but with another generation.
+    const AssetRef asset = MakeTableAsset("gfx/table/reused.png");
+    const auto reusedHandle = table.Add(asset);
+    EXPECT_EQ(reusedHandle.Index, handle.Index);
+    EXPECT_NE(reusedHandle.Generation, handle.Generation);
+    EXPECT_EQ(table.Get(handle), nullptr);
+    EXPECT_EQ(table.Get(reusedHandle), asset.get());
+
+    table.Clear();
+    EXPECT_EQ(table.GetCount(), 0u);
+    EXPECT_EQ(table.Get(reusedHandle), nullptr);
+    EXPECT_NE(table.Add(asset), reusedHandle);
+}
+
+TEST(AssetHandleTableTest, EvictsLeastRecentlyUsedFirst)
+{
+    std::vector<std::string> reloadedPaths;
+    AssetHandleTable table([&reloadedPaths](const std::string& path) { reloadedPaths.push_back(path); return MakeTableAsset(path, 100); });
+
+    const auto first = table.Add(MakeTableAsset("gfx/evict/first.png", 100));
+    const auto second = table.Add(MakeTableAsset("gfx/evict/second.png", 100));
+    const auto referenced = table.Add(MakeTableAsset("gfx/evict/referenced.png", 100));
+    const auto pinned = table.Add(MakeTableAsset("gfx/evict/pinned.png", 100));
+    const auto sound = table.Add(MakeTableAsset("sound/evict/sound.wav", 100, eAssetType::SOUND));
+    const AssetRef reference = table.GetRef(referenced);
+    const auto IsPinned = [](AssetInterface& asset) { return asset.GetPath() == "gfx/evict/pinned.png"; };
+
+    //  First one is used last, so the second one goes first.
+    EXPECT_TRUE(table.Get(first));
+    const int32_t liveCount = TestAsset::LiveCount;
+    EXPECT_EQ(table.Evict(eAssetType::GFX, 50, IsPinned), 100u);
+    EXPECT_EQ(TestAsset::LiveCount, liveCount - 1);
+    EXPECT_EQ(table.GetResident(second), nullptr);
+    EXPECT_TRUE(table.GetResident(first));
+
+    //  Referenced and pinned assets, or ones of another type, are never evicted, no matter how much is asked for.
+    EXPECT_EQ(table.Evict(eAssetType::GFX, 1000, IsPinned), 100u);
+    EXPECT_EQ(table.GetResident(first), nullptr);
+    EXPECT_TRUE(table.GetResident(referenced));
+    EXPECT_TRUE(table.GetResident(pinned));
+    EXPECT_TRUE(table.GetResident(sound));
+    EXPECT_TRUE(reloadedPaths.empty());
+
+    //  Evicted asset is loaded again once it's needed, handle stays the same.
+    AssetInterface* reloaded = table.Get(second);
+    ASSERT_TRUE(reloaded);
+    EXPECT_EQ(reloaded->GetPath(), "gfx/evict/second.png");
+    EXPECT_EQ(reloadedPaths, std::vector<std::string>{ "gfx/evict/second.png" });
+    EXPECT_EQ(table.Find(HashName("gfx/evict/second.png")), second);
+
+    //  Removing an evicted asset doesn't load it.
+    EXPECT_TRUE(table.Remove(first));
+    EXPECT_EQ(reloadedPaths.size(), 1u);
+}
+
+TEST(AssetHandleTableTest, FailedReloadKeepsAssetEvicted)
+{
+    bool canReload = false;
+    AssetHandleTable table([&canReload](const std::string& path) { return canReload ? MakeTableAsset(path) : nullptr; });
+    const auto handle = table.Add(MakeTableAsset("gfx/evict/failed.png"));
+    EXPECT_EQ(table.Evict(eAssetType::GFX, 1), 1u);
+
+    EXPECT_EQ(table.Get(handle), nullptr);
+    EXPECT_FALSE(table.Find(HashName("gfx/evict/failed.png")).IsNull());
+
+    canReload = true;
+    EXPECT_TRUE(table.Get(handle));
+}
+
+TEST(AssetRequestTest, HigherPriorityRequestsAreFinalizedFirst)
+{
+    CompletedRequestQueue queue;
+    const std::vector<std::pair<std::string, int32_t>> completed = { { "a", 0 }, { "b", 5 }, { "c", -5 }, { "d", 5 }, { "e", 10 } };
+    for (const auto& [path, priority] : completed)
+        queue.Push(std::make_shared<AssetRequest>(path, priority, nullptr));
+
+    const auto Take = [&queue](const size_t maxCount)
+        {
+            std::string paths;
+            for (const auto& request : queue.Take(maxCount))
+                paths += request->GetPath();
+
+            return paths;
+        };
+
+    //  Whatever isn't taken this frame waits for the next one, requests completed since then are sorted in.
+    EXPECT_EQ(Take(2), "eb");
+    queue.Push(std::make_shared<AssetRequest>("f", 5, nullptr));
+    EXPECT_EQ(Take(10), "dfac");
+    EXPECT_EQ(Take(10), "");
+
+    queue.Push(std::make_shared<AssetRequest>("g", 0, nullptr));
+    queue.Clear();
+    EXPECT_EQ(Take(10), "");
+}
+
+TEST(ArenaTest, AllocationsAreAlignedAndDontOverlap)
+{
+    Arena arena(256);
+
+    //  Odd sizes, so every allocation has to be aligned again.
+    std::vector<std::span<uint64_t>> arrays;
+    for (size_t count = 1; count < 40; count += 3)
+    {
+        const auto bytes = arena.NewArray<uint8_t>(count);
+        std::fill(bytes.begin(), bytes.end(), (uint8_t)0xff);
+
+        auto& values = arrays.emplace_back(arena.NewArray<uint64_t>(count));
+        EXPECT_EQ((uintptr_t)values.data() % alignof(uint64_t), 0u);
+        for (size_t index = 0; index < count; index++)
+            EXPECT_EQ(values[index], 0u);
+
+        std::fill(values.begin(), values.end(), count);
+    }
+
+    //  Nothing written later reached into earlier arrays, even once blocks ran out.
+    for (const auto& values : arrays)
+    {
+        for (const uint64_t value : values)
+            ASSERT_EQ(value, values.size());
+    }
+
+    EXPECT_TRUE(arena.NewArray<uint64_t>(0).empty());
+}
+
+TEST(ArenaTest, LargeAllocationGetsItsOwnBlock)
+{
+    Arena arena(64);
+
+    const auto large = arena.NewArray<uint8_t>(1000);
+    ASSERT_EQ(large.size(), 1000u);
+    std::fill(large.begin(), large.end(), (uint8_t)1);
+
+    EXPECT_EQ(arena.GetBytesAllocated(), 1000u);
+}
+
+TEST(ArenaTest, CopiedStringsAreTerminated)
+{
+    Arena arena;
+
+    const std::string source = "StartButton/Text";
+    const std::string_view copy = arena.CopyString(std::string_view(source).substr(0, 11));
+
+    EXPECT_EQ(copy, "StartButton");
+    EXPECT_NE(copy.data(), source.data());
+    EXPECT_EQ(copy.data()[copy.size()], '\0');
+}
+
+TEST(ArenaTest, ResetReusesBlocks)
+{
+    Arena arena(128);
+
+    const void* first = arena.Allocate(100);
+    arena.Allocate(100);
+    arena.Reset();
+
+    EXPECT_EQ(arena.GetBytesAllocated(), 0u);
+    EXPECT_EQ(arena.Allocate(100), first);
+}
+
+TEST(DataManifestTest, SavedManifestLoadsTheSame)
+{
+    const std::string dataFilePath = WriteTestFile("ManifestSavedLoadsTheSame.dat", { 'a', 'b', 'c' });
+
+    DataManifest manifest;
+    ASSERT_TRUE(manifest.AddDataFile(dataFilePath));
+    manifest.AssetReferences = { "scene:menu.scene", "text:intro.txt" };
+    manifest.PrefetchScenes = { "level01.scene" };
+    manifest.ActiveScene = "menu.scene";
+    manifest.HasActiveScene = true;
+    manifest.LinesRead = 4;
+
+    const std::string manifestPath = (std::filesystem::temp_directory_path() / "ManifestSavedLoadsTheSame.manifest").string();
+    ASSERT_TRUE(manifest.Save(manifestPath));
+
+    DataManifest loadedManifest;
+    ASSERT_TRUE(loadedManifest.Load(manifestPath));
+    ASSERT_EQ(loadedManifest.DataFiles.size(), 1u);
+    EXPECT_EQ(loadedManifest.DataFiles[0].Path, dataFilePath);
+    EXPECT_EQ(loadedManifest.DataFiles[0].Size, 3u);
+    EXPECT_EQ(loadedManifest.AssetReferences, manifest.AssetReferences);
+    EXPECT_EQ(loadedManifest.PrefetchScenes, manifest.PrefetchScenes);
+    EXPECT_TRUE(loadedManifest.HasActiveScene);
+    EXPECT_EQ(loadedManifest.ActiveScene, "menu.scene");
+    EXPECT_EQ(loadedManifest.LinesRead, 4u);
+    EXPECT_TRUE(loadedManifest.IsUpToDate());
+
+    //  Data file that changed makes manifest stale.
+    WriteTestFile("ManifestSavedLoadsTheSame.dat", { 'a', 'b', 'c', 'd' });
+    EXPECT_FALSE(loadedManifest.IsUpToDate());
+}
+
+TEST(DataManifestTest, RejectsDamagedManifest)
+{
+    DataManifest manifest;
+    manifest.AssetReferences = { "scene:menu.scene" };
+
+    const std::string manifestPath = (std::filesystem::temp_directory_path() / "ManifestRejectsDamaged.manifest").string();
+    ASSERT_TRUE(manifest.Save(manifestPath));
+
+    std::ifstream manifestFile(manifestPath, std::ios::binary);
+    const std::vector<uint8_t> data{ std::istreambuf_iterator<char>(manifestFile), {} };
+
+    //  Cut off in the middle of a string.
+    EXPECT_FALSE(DataManifest().Load(WriteTestFile("ManifestRejectsDamaged.manifest", std::vector<uint8_t>(data.begin(), data.end() - 1))));
+
+    //  Counts that can't possibly fit in the file are rejected before anything is allocated for them.
+    std::vector<uint8_t> hugeCount = data;
+    ((DataManifestHeader*)hugeCount.data())->AssetReferencesCount = UINT32_MAX;
+    EXPECT_FALSE(DataManifest().Load(WriteTestFile("ManifestRejectsDamaged.manifest", hugeCount)));
+
+    hugeCount = data;
+    ((DataManifestHeader*)hugeCount.data())->DataFilesCount = UINT32_MAX;
+    EXPECT_FALSE(DataManifest().Load(WriteTestFile("ManifestRejectsDamaged.manifest", hugeCount)));
+
+    EXPECT_TRUE(DataManifest().Load(WriteTestFile("ManifestRejectsDamaged.manifest", data)));
+}
+
+TEST(DataManifestTest, IncompleteManifestIsNotSaved)
+{
+    DataManifest manifest;
+    EXPECT_FALSE(manifest.AddDataFile((std::filesystem::temp_directory_path() / "ManifestMissingInclude.dat").string()));
+    EXPECT_FALSE(manifest.Save((std::filesystem::temp_directory_path() / "ManifestIncomplete.manifest").string()));
+}
+
+//  Text asset parsed from 'data' the way loader does it, 'data' must outlive it.
+static void ParseTextAsset(TextAsset& text, const std::string_view& data)
+{
+    text.SetData("text/test.txt", eAssetType::TEXT);
+    text.SetDataSize(data.size());
+    text.ParseData((const uint8_t*)data.data());
+}
+
+static const std::string_view TestText =
+    "# Comments and empty lines are skipped.\r\n"
+    "\r\n"
+    "TitleHeader=My Test Game\r\n"
+    "TitleFooter=created by Michael\n"
+    "Empty=\r\n"
+    "Line without a value\r\n"
+    "TitleHeader=Second value is ignored\r\n"
+    "LegalFooter=(c) 2022";
+
+TEST(JsonStreamReaderTest, WalksNestedContainers)
+{
+    const std::string_view json = R"({
+        "name": "Start \"Button\"\n",
+        "id": 18446744073709551615,
+        "position": [ 320.5, -140, 1e2 ],
+        "skipped": { "nested": [ 1, { "deeper": null } ], "flag": true },
+        "empty": []
+    })";
+    JsonStreamReader reader(json.data(), json.size());
+
+    std::string_view name;
+    uint64_t id = 0;
+    std::vector<float_t> position;
+    bool hasEmptyElements = false;
+
+    std::string_view key;
+    for (bool hasKey = reader.BeginObject(key); hasKey; hasKey = reader.NextKey(key))
+    {
+        if (key == "name")
+        {
+            //  Decoded string is only valid until the next one is read.
+            std::string_view value;
+            ASSERT_TRUE(reader.ReadString(value));
+            EXPECT_EQ(value, "Start \"Button\"\n");
+            name = "read";
+        }
+        else if (key == "id")
+            EXPECT_TRUE(reader.ReadUInt64(id));
+        else if (key == "position")
+        {
+            for (bool hasElement = reader.BeginArray(); hasElement; hasElement = reader.NextElement())
+                EXPECT_TRUE(reader.ReadFloat(position.emplace_back()));
+        }
+        else if (key == "empty")
+            hasEmptyElements = reader.BeginArray();
+        else
+            EXPECT_TRUE(reader.SkipValue());
+    }
+
+    EXPECT_FALSE(reader.HasFailed());
+    EXPECT_EQ(name, "read");
+    EXPECT_EQ(id, UINT64_MAX);
+    EXPECT_EQ(position, std::vector<float_t>({ 320.5f, -140.f, 100.f }));
+    EXPECT_FALSE(hasEmptyElements);
+}
+
+TEST(JsonStreamReaderTest, MalformedInputEndsEveryLoop)
+{
+    const std::string_view json = "{\n\"entries\": [\n{ \"id\": 1 },\n{ \"id\" 2 }\n]\n}";
+    JsonStreamReader reader(json.data(), json.size());
+
+    size_t entriesCount = 0;
+    std::string_view key;
+    for (bool hasKey = reader.BeginObject(key); hasKey; hasKey = reader.NextKey(key))
+    {
+        for (bool hasElement = reader.BeginArray(); hasElement; hasElement = reader.NextElement())
+        {
+            reader.SkipValue();
+            entriesCount++;
+        }
+    }
+
+    EXPECT_TRUE(reader.HasFailed());
+    //  Second entry is where it failed, nothing after it was visited.
+    EXPECT_EQ(entriesCount, 2u);
+    EXPECT_EQ(reader.GetLine(), 4u);
+
+    //  Once failed, reader doesn't read anything anymore.
+    uint64_t value = 0;
+    EXPECT_FALSE(reader.ReadUInt64(value));
+    EXPECT_FALSE(reader.BeginObject(key));
+}
+
+TEST(JsonStreamReaderTest, RejectsValuesOfWrongType)
+{
+    const std::string_view json = R"([ "text", -1, 1.5 ])";
+    JsonStreamReader reader(json.data(), json.size());
+
+    uint64_t number = 0;
+    ASSERT_TRUE(reader.BeginArray());
+    EXPECT_FALSE(reader.ReadUInt64(number));
+    EXPECT_TRUE(reader.HasFailed());
+}
+
+//  Scene text with a plain entity, a prefab instance listed before it (but drawn after) and a script.
+static std::string MakeSceneText()
+{
+    return R"({
+        "version": 1,
+        "entries": [
+            {
+                "id": 3,
+                "name": "StartButton",
+                "type": )" + std::to_string((uint64_t)eAssetType::SCENE) + R"(,
+                "position": [ 320, 140, 0 ],
+                "order": 1,
+                "source": "scene:prefabs/button.scene",
+                "overrides": [
+                    { "target": "Text", "source": "text:menu.txt/StartButton", "position": [ 5, 6 ] },
+                    { "target": "Background", "width": 200, "height": 40 }
+                ]
+            },
+            {
+                "id": 1,
+                "name": "BackgroundImage",
+                "type": )" + std::to_string((uint64_t)eAssetType::GFX) + R"(,
+                "position": [ 1.5, 2, 3 ],
+                "width": 640,
+                "height": 480,
+                "order": 0,
+                "source": "gfx:menu/background.jpg",
+                "size": 10
+            },
+            {
+                "id": 7,
+                "type": )" + std::to_string((uint64_t)eAssetType::SCRIPT) + R"(,
+                "source": "script:menu/mainmenu.script"
+            }
+        ]
+    })";
+}
+
+//  Cooked string, looked up the way scene does it when loading.
+static std::string_view GetCookedString(const std::vector<char>& cookedData, const SceneBinString& string)
+{
+    const SceneBinHeader& header = *(const SceneBinHeader*)cookedData.data();
+    return std::string_view(cookedData.data() + header.StringsOffset + string.Offset, string.Length);
+}
+
+static std::string_view GetCookedReference(const std::vector<char>& cookedData, const uint32_t reference)
+{
+    const SceneBinHeader& header = *(const SceneBinHeader*)cookedData.data();
+    return GetCookedString(cookedData, ((const SceneBinString*)(cookedData.data() + header.ReferencesOffset))[reference]);
+}
+
+TEST(SceneFormatTest, ReadsEveryKindOfEntry)
+{
+    const std::string text = MakeSceneText();
+    Arena arena;
+    std::vector<EntityReferenceData> entities;
+    std::vector<ScriptReferenceData> scripts;
+    size_t errorLine = 0;
+    ASSERT_TRUE(SceneFormat::ReadText(text.data(), text.size(), arena, entities, scripts, errorLine));
+
+    ASSERT_EQ(entities.size(), 2u);
+    const EntityReferenceData& instance = entities[0];
+    EXPECT_EQ(instance.Id, 3u);
+    EXPECT_EQ(instance.Name, "StartButton");
+    EXPECT_EQ(instance.Type, eAssetType::SCENE);
+    EXPECT_EQ(instance.SourceAsset, "scene:prefabs/button.scene");
+    ASSERT_EQ(instance.Overrides.size(), 2u);
+    EXPECT_EQ(instance.Overrides[0].Target, "Text");
+    EXPECT_EQ(instance.Overrides[0].Fields, EntityOverrideData::SOURCE | EntityOverrideData::POSITION);
+    EXPECT_EQ(instance.Overrides[0].SourceAsset, "text:menu.txt/StartButton");
+    EXPECT_EQ(instance.Overrides[0].Position.Y, 6.f);
+    EXPECT_EQ(instance.Overrides[1].Fields, EntityOverrideData::WIDTH | EntityOverrideData::HEIGHT);
+    EXPECT_EQ(instance.Overrides[1].Width, 200u);
+
+    const EntityReferenceData& image = entities[1];
+    EXPECT_EQ(image.Position.X, 1.5f);
+    EXPECT_EQ(image.Width, 640u);
+    EXPECT_TRUE(image.Overrides.empty());
+
+    ASSERT_EQ(scripts.size(), 1u);
+    EXPECT_EQ(scripts[0].Id, 7u);
+    EXPECT_EQ(scripts[0].Name, "mainmenu.script");
+    EXPECT_EQ(scripts[0].SourceAsset, "script:menu/mainmenu.script");
+}
+
+TEST(SceneFormatTest, CookedSceneHasTheSameRecords)
+{
+    const std::string text = MakeSceneText();
+    Arena arena;
+    std::vector<EntityReferenceData> entities;
+    std::vector<ScriptReferenceData> scripts;
+    size_t errorLine = 0;
+    ASSERT_TRUE(SceneFormat::ReadText(text.data(), text.size(), arena, entities, scripts, errorLine));
+
+    std::vector<char> cookedData;
+    SceneFormat::Cook(entities, scripts, cookedData);
+    ASSERT_TRUE(SceneFormat::IsCooked((const uint8_t*)cookedData.data(), cookedData.size()));
+    EXPECT_FALSE(SceneFormat::IsCooked((const uint8_t*)text.data(), text.size()));
+
+    const SceneBinHeader& header = *(const SceneBinHeader*)cookedData.data();
+    ASSERT_TRUE(SceneFormat::IsValid(header, cookedData.size()));
+    ASSERT_EQ(header.EntitiesCount, 2u);
+    ASSERT_EQ(header.ScriptsCount, 1u);
+    ASSERT_EQ(header.OverridesCount, 2u);
+
+    //  Entities are cooked in draw order.
+    const SceneBinEntity* cookedEntities = (const SceneBinEntity*)(cookedData.data() + header.EntitiesOffset);
+    EXPECT_EQ(cookedEntities[0].Id, 1u);
+    EXPECT_EQ(cookedEntities[0].Type, (uint64_t)eAssetType::GFX);
+    EXPECT_EQ(GetCookedString(cookedData, cookedEntities[0].Name), "BackgroundImage");
+    EXPECT_EQ(GetCookedReference(cookedData, cookedEntities[0].Reference), "gfx:menu/background.jpg");
+    EXPECT_EQ(cookedEntities[0].Position[2], 3.f);
+    EXPECT_EQ(cookedEntities[0].Height, 480u);
+    EXPECT_EQ(cookedEntities[0].OverridesCount, 0u);
+
+    EXPECT_EQ(cookedEntities[1].Id, 3u);
+    EXPECT_EQ(GetCookedReference(cookedData, cookedEntities[1].Reference), "scene:prefabs/button.scene");
+    EXPECT_EQ(cookedEntities[1].OverridesCount, 2u);
+
+    const SceneBinOverride* cookedOverrides = (const SceneBinOverride*)(cookedData.data() + header.OverridesOffset);
+    EXPECT_EQ(GetCookedString(cookedData, cookedOverrides[0].Target), "Text");
+    EXPECT_EQ(GetCookedReference(cookedData, cookedOverrides[0].Reference), "text:menu.txt/StartButton");
+    EXPECT_EQ(cookedOverrides[0].Position[0], 5.f);
+    EXPECT_EQ(cookedOverrides[1].Fields, (uint32_t)(EntityOverrideData::WIDTH | EntityOverrideData::HEIGHT));
+    EXPECT_EQ(cookedOverrides[1].Reference, UINT32_MAX);
+    EXPECT_EQ(cookedOverrides[1].Height, 40u);
+
+    const SceneBinScript* cookedScripts = (const SceneBinScript*)(cookedData.data() + header.ScriptsOffset);
+    EXPECT_EQ(cookedScripts[0].Id, 7u);
+    EXPECT_EQ(GetCookedString(cookedData, cookedScripts[0].Name), "mainmenu.script");
+    EXPECT_EQ(GetCookedReference(cookedData, cookedScripts[0].Reference), "script:menu/mainmenu.script");
+
+    //  Sections cut off by a short file are caught before anything is read.
+    EXPECT_FALSE(SceneFormat::IsValid(header, cookedData.size() - 1));
+    EXPECT_FALSE(SceneFormat::IsValid(header, header.OverridesOffset));
+}
+
+TEST(SceneFormatTest, MalformedTextReportsLine)
+{
+    const std::string_view text = "{\n\"entries\": [\n{ \"id\": 1 },\n{ \"id\": }\n]\n}";
+    Arena arena;
+    std::vector<EntityReferenceData> entities;
+    std::vector<ScriptReferenceData> scripts;
+    size_t errorLine = 0;
+    EXPECT_FALSE(SceneFormat::ReadText(text.data(), text.size(), arena, entities, scripts, errorLine));
+    EXPECT_EQ(errorLine, 4u);
+}
+
+static EntityReferenceData MakeTestEntity(const uint64_t id, const std::string_view& name, const uint64_t parentId, const vec3f& position = {})
+{
+    return { id, name, eAssetType::GFX, position, 0, 0, 0, {}, parentId, {}, nullptr };
+}
+
+static EntityReferenceData MakeTestInstance(const uint64_t id, const std::string_view& name, const uint64_t parentId, const vec3f& position)
+{
+    return { id, name, eAssetType::SCENE, position, 0, 0, 0, "prefab.scene", parentId, {}, nullptr };
+}
+
+//  Entity at 'index' is an instance of 'prefabs[index]', if there's one.
+static void BuildTestGraph(SceneGraph& graph, Arena& arena, const std::vector<EntityReferenceData>& entities, const std::vector<const SceneGraph*>& prefabs = {}, const std::vector<std::span<PrefabMemberOverride>>& overrides = {})
+{
+    graph.Allocate(arena, entities.size(), "test.scene");
+    for (size_t index = 0; index < entities.size(); index++)
+        graph.AddEntity(entities[index], index < prefabs.size() ? prefabs[index] : nullptr, index < overrides.size() ? overrides[index] : std::span<PrefabMemberOverride>());
+
+    graph.Build(arena);
+}
+
+static std::span<PrefabMemberOverride> MakeTestOverrides(Arena& arena, const std::vector<EntityOverrideData>& entityOverrides)
+{
+    const auto overrides = arena.NewArray<PrefabMemberOverride>(entityOverrides.size());
+    for (size_t index = 0; index < entityOverrides.size(); index++)
+        overrides[index] = { entityOverrides[index], InvalidEntityIndex, nullptr };
+
+    return overrides;
+}
+
+//  Assets are only compared, never used.
+static AssetInterface* MakeTestAsset(const uintptr_t id)
+{
+    return (AssetInterface*)(id * alignof(std::max_align_t));
+}
+
+TEST(SceneGraphTest, ChildrenAreGroupedInOrder)
+{
+    Arena arena;
+    SceneGraph graph;
+    BuildTestGraph(graph, arena, {
+        MakeTestEntity(1, "Root", 0),
+        MakeTestEntity(2, "First", 1),
+        MakeTestEntity(3, "Other", 0),
+        MakeTestEntity(4, "Second", 1),
+        MakeTestEntity(5, "Grandchild", 2),
+        MakeTestEntity(6, "Third", 1)
+    });
+
+    const auto children = graph.FindChildren(1);
+    EXPECT_EQ(std::vector<uint32_t>(children.begin(), children.end()), (std::vector<uint32_t>{ 1, 3, 5 }));
+
+    const auto topLevel = graph.FindChildren(0);
+    EXPECT_EQ(std::vector<uint32_t>(topLevel.begin(), topLevel.end()), (std::vector<uint32_t>{ 0, 2 }));
+
+    ASSERT_EQ(graph.FindChildren(2).size(), 1u);
+    EXPECT_EQ(graph.FindChildren(2)[0], 4u);
+    EXPECT_TRUE(graph.FindChildren(5).empty());
+    EXPECT_TRUE(graph.FindChildren(42).empty());
+}
+
+TEST(SceneGraphTest, FindsEntitiesByNameAndId)
+{
+    Arena arena;
+    SceneGraph graph;
+    BuildTestGraph(graph, arena, {
+        MakeTestEntity(10, "Button", 0),
+        MakeTestEntity(20, "Label", 10),
+        MakeTestEntity(30, "Button", 0),
+        MakeTestEntity(40, "Label", 0),
+        MakeTestEntity(50, "", 0)
+    });
+
+    ASSERT_EQ(graph.GetEntities().Count, 5u);
+    EXPECT_EQ(graph.FindEntityByName(HashName("Button")), 0u);
+    EXPECT_EQ(graph.FindEntityByName(HashName("Label")), 1u);
+    EXPECT_EQ(graph.FindEntityByName(HashName("Missing")), InvalidEntityIndex);
+    EXPECT_EQ(graph.FindEntityByName(HashName("")), InvalidEntityIndex);
+
+    EXPECT_EQ(graph.FindEntityById(30), 2u);
+    EXPECT_EQ(graph.FindEntityById(40), 3u);
+    EXPECT_EQ(graph.FindEntityById(60), InvalidEntityIndex);
+
+    const EntityReferenceData entity = graph.GetEntity(3);
+    EXPECT_EQ(entity.Id, 40u);
+    EXPECT_EQ(entity.Name, "Label");
+    EXPECT_EQ(entity.ParentId, 0u);
+}
+
+TEST(SceneGraphTest, PatchesOnlyMatchingAssets)
+{
+    Arena arena;
+    SceneGraph graph;
+    AssetInterface* const previousAsset = MakeTestAsset(1);
+    AssetInterface* const otherAsset = MakeTestAsset(2);
+    std::vector<EntityReferenceData> entities = { MakeTestEntity(1, "A", 0), MakeTestEntity(2, "B", 0), MakeTestEntity(3, "C", 0) };
+    entities[0].Asset = previousAsset;
+    entities[1].Asset = otherAsset;
+    entities[2].Asset = previousAsset;
+    BuildTestGraph(graph, arena, entities);
+
+    AssetInterface* const asset = MakeTestAsset(3);
+    EXPECT_EQ(graph.PatchAsset(previousAsset, asset), 2u);
+    EXPECT_EQ(graph.GetEntities().Assets[0], asset);
+    EXPECT_EQ(graph.GetEntities().Assets[1], otherAsset);
+    EXPECT_EQ(graph.GetEntities().Assets[2], asset);
+    EXPECT_EQ(graph.PatchAsset(previousAsset, asset), 0u);
+}
+
+static void ExpectWorldPosition(const SceneGraph& graph, const uint32_t index, const vec3f& position)
+{
+    const vec3f& worldPosition = graph.GetEntities().WorldPositions[index];
+    EXPECT_EQ(worldPosition.X, position.X) << "entity " << index;
+    EXPECT_EQ(worldPosition.Y, position.Y) << "entity " << index;
+    EXPECT_EQ(worldPosition.Z, position.Z) << "entity " << index;
+}
+
+TEST(SceneGraphTest, BrokenHierarchyBecomesTopLevel)
+{
+    Arena arena;
+    SceneGraph graph;
+    BuildTestGraph(graph, arena, {
+        MakeTestEntity(1, "LoopA", 2, { 1, 0, 0 }),
+        MakeTestEntity(2, "LoopB", 1, { 10, 0, 0 }),
+        MakeTestEntity(3, "Orphan", 99, { 0, 2, 0 }),
+        MakeTestEntity(4, "Self", 4, { 0, 0, 3 }),
+        MakeTestEntity(0, "NoId", 0, { 100, 0, 0 }),
+        MakeTestEntity(5, "Child", 4, { 1, 1, 1 })
+    });
+
+    //  First entity of the loop that's reached becomes it's root, the rest hang off it as usual.
+    ExpectWorldPosition(graph, 0, { 1, 0, 0 });
+    ExpectWorldPosition(graph, 1, { 11, 0, 0 });
+    ExpectWorldPosition(graph, 2, { 0, 2, 0 });
+    ExpectWorldPosition(graph, 3, { 0, 0, 3 });
+    ExpectWorldPosition(graph, 5, { 1, 1, 4 });
+    //  Entity without id isn't a parent of top level entities.
+    ExpectWorldPosition(graph, 4, { 100, 0, 0 });
+}
+
+TEST(SceneGraphTest, MovedSubtreesAreUpdated)
+{
+    Arena arena;
+    SceneGraph graph;
+    BuildTestGraph(graph, arena, {
+        MakeTestEntity(1, "Root", 0, { 1, 0, 0 }),
+        MakeTestEntity(2, "Child", 1, { 0, 1, 0 }),
+        MakeTestEntity(3, "Grandchild", 2, { 0, 0, 1 }),
+        MakeTestEntity(4, "Other", 0, { 5, 0, 0 }),
+        MakeTestEntity(5, "OtherChild", 4, { 0, 5, 0 })
+    });
+
+    ExpectWorldPosition(graph, 2, { 1, 1, 1 });
+    ExpectWorldPosition(graph, 4, { 5, 5, 0 });
+
+    //  World positions stay put until transforms are updated, then the whole subtree follows.
+    graph.SetEntityPosition(1, { 0, 2, 0 });
+    ExpectWorldPosition(graph, 2, { 1, 1, 1 });
+    graph.UpdateTransforms();
+    ExpectWorldPosition(graph, 0, { 1, 0, 0 });
+    ExpectWorldPosition(graph, 1, { 1, 2, 0 });
+    ExpectWorldPosition(graph, 2, { 1, 2, 1 });
+    ExpectWorldPosition(graph, 4, { 5, 5, 0 });
+
+    //  Later subtree moved before an earlier one, and one entity moved twice, all of it lands in one update.
+    graph.SetEntityPosition(4, { 0, 6, 0 });
+    graph.SetEntityPosition(2, { 0, 0, 2 });
+    graph.SetEntityPosition(0, { 2, 0, 0 });
+    graph.SetEntityPosition(4, { 0, 7, 0 });
+    graph.UpdateTransforms();
+    ExpectWorldPosition(graph, 0, { 2, 0, 0 });
+    ExpectWorldPosition(graph, 1, { 2, 2, 0 });
+    ExpectWorldPosition(graph, 2, { 2, 2, 2 });
+    ExpectWorldPosition(graph, 3, { 5, 0, 0 });
+    ExpectWorldPosition(graph, 4, { 5, 7, 0 });
+
+    //  Nothing moved, nothing changes.
+    graph.UpdateTransforms();
+    ExpectWorldPosition(graph, 2, { 2, 2, 2 });
+
+    //  Still counted right after all of the above, a single move is picked up again.
+    graph.SetEntityPosition(3, { 9, 0, 0 });
+    graph.UpdateTransforms();
+    ExpectWorldPosition(graph, 4, { 9, 7, 0 });
+}
+
+static void BuildTestPrefab(SceneGraph& prefab, Arena& arena)
+{
+    BuildTestGraph(prefab, arena, {
+        MakeTestEntity(1, "Panel", 0, { 1, 0, 0 }),
+        MakeTestEntity(2, "Text", 1, { 0, 1, 0 }),
+        MakeTestEntity(3, "Icon", 0, { 0, 0, 1 })
+    });
+}
+
+TEST(SceneGraphTest, PrefabMembersAreSharedWithTemplate)
+{
+    Arena arena;
+    SceneGraph prefab;
+    BuildTestPrefab(prefab, arena);
+
+    const auto overrides = MakeTestOverrides(arena, {
+        { "Panel", EntityOverrideData::POSITION, { 2, 0, 0 }, 0, 0, {} },
+        { "Icon", EntityOverrideData::WIDTH | EntityOverrideData::SOURCE, {}, 7, 0, "gfx/icon.png" },
+        { "Missing", EntityOverrideData::POSITION, { 9, 9, 9 }, 0, 0, {} }
+    });
+    overrides[1].Asset = MakeTestAsset(1);
+
+    SceneGraph graph;
+    BuildTestGraph(graph, arena, {
+        MakeTestEntity(10, "Menu", 0, { 0, 0, 5 }),
+        MakeTestInstance(20, "Button", 10, { 10, 0, 0 }),
+        MakeTestEntity(30, "Other", 0, { 3, 3, 3 })
+    }, { nullptr, &prefab }, { {}, overrides });
+
+    //  Instance is a single entity, it's members take handles after the scene's own ones.
+    ASSERT_EQ(graph.GetEntities().Count, 3u);
+    ASSERT_EQ(graph.GetHandlesCount(), 6u);
+    EXPECT_EQ(overrides[2].MemberIndex, InvalidEntityIndex);
+
+    EXPECT_EQ(graph.FindEntityByName("Button/Panel"), 3u);
+    EXPECT_EQ(graph.FindEntityByName("Button/Text"), 4u);
+    EXPECT_EQ(graph.FindEntityByName("Button/Icon"), 5u);
+    EXPECT_EQ(graph.FindEntityByName("Button/Missing"), InvalidEntityIndex);
+    EXPECT_EQ(graph.FindEntityByName("Other/Text"), InvalidEntityIndex);
+    EXPECT_EQ(graph.FindEntityByName("Missing/Text"), InvalidEntityIndex);
+    EXPECT_EQ(graph.FindEntityByName("Text"), InvalidEntityIndex);
+    EXPECT_EQ(graph.FindPrefabMember(1, "Text"), 4u);
+
+    //  Overridden parent moves it's children along, the rest stay where template has them.
+    ExpectWorldPosition(graph, 1, { 10, 0, 5 });
+    EXPECT_EQ(graph.GetWorldPosition(3).X, 12);
+    EXPECT_EQ(graph.GetWorldPosition(4).X, 12);
+    EXPECT_EQ(graph.GetWorldPosition(4).Y, 1);
+    EXPECT_EQ(graph.GetWorldPosition(4).Z, 5);
+    EXPECT_EQ(graph.GetWorldPosition(5).X, 10);
+    EXPECT_EQ(graph.GetWorldPosition(5).Z, 6);
+
+    //  Member records are the template's ones, strings aren't copied.
+    const EntityReferenceData icon = graph.GetEntity(5);
+    EXPECT_EQ(icon.Name.data(), prefab.GetEntities().Names[2].data());
+    EXPECT_EQ(icon.Width, 7u);
+    EXPECT_EQ(icon.SourceAsset, "gfx/icon.png");
+    EXPECT_EQ(icon.Asset, MakeTestAsset(1));
+    EXPECT_EQ(graph.GetEntity(3).Position.X, 2);
+    EXPECT_EQ(prefab.GetEntity(0).Position.X, 1);
+
+    //  Members are rendered right after their instance, with the same positions as above.
+    std::vector<uint32_t> handles;
+    graph.RenderEntities([&](const uint32_t handle, const eAssetType type, const vec3f& position, const uint32_t width, const uint32_t height, const AssetInterface* asset)
+        {
+            handles.push_back(handle);
+            if (handle == 4)
+                EXPECT_EQ(position.X, 12);
+            if (handle == 5)
+            {
+                EXPECT_EQ(width, 7u);
+                EXPECT_EQ(asset, MakeTestAsset(1));
+            }
+        });
+    EXPECT_EQ(handles, (std::vector<uint32_t>{ 0, 1, 3, 4, 5, 2 }));
+
+    EXPECT_EQ(graph.PatchAsset(MakeTestAsset(1), MakeTestAsset(2)), 1u);
+    EXPECT_EQ(graph.GetEntity(5).Asset, MakeTestAsset(2));
+}
+
+TEST(SceneGraphTest, NestedPrefabMembersAreFoundByPath)
+{
+    Arena arena;
+    SceneGraph prefab;
+    BuildTestPrefab(prefab, arena);
+
+    SceneGraph nestedPrefab;
+    BuildTestGraph(nestedPrefab, arena, {
+        MakeTestEntity(100, "Frame", 0),
+        MakeTestInstance(101, "Inner", 0, { 0, 0, 100 })
+    }, { nullptr, &prefab }, { {}, MakeTestOverrides(arena, { { "Text", EntityOverrideData::POSITION, { 0, 2, 0 }, 0, 0, {} } }) });
+
+    SceneGraph graph;
+    BuildTestGraph(graph, arena, { MakeTestInstance(200, "Outer", 0, { 1000, 0, 0 }) }, { &nestedPrefab });
+
+    ASSERT_EQ(nestedPrefab.GetHandlesCount(), 5u);
+    ASSERT_EQ(graph.GetHandlesCount(), 6u);
+    EXPECT_EQ(graph.FindEntityByName("Outer/Frame"), 1u);
+    EXPECT_EQ(graph.FindEntityByName("Outer/Inner"), 2u);
+    EXPECT_EQ(graph.FindEntityByName("Outer/Inner/Text"), 4u);
+    EXPECT_EQ(graph.FindEntityByName("Outer/Inner/Missing"), InvalidEntityIndex);
+    EXPECT_EQ(graph.FindEntityByName("Outer/Text"), InvalidEntityIndex);
+
+    const vec3f text = graph.GetWorldPosition(4);
+    EXPECT_EQ(text.X, 1001);
+    EXPECT_EQ(text.Y, 2);
+    EXPECT_EQ(text.Z, 100);
+    EXPECT_EQ(graph.GetEntity(4).Name, "Text");
+    //  Overrides the nested prefab itself makes still apply.
+    EXPECT_EQ(graph.GetEntity(4).Position.Y, 2);
+
+    std::vector<uint32_t> handles;
+    graph.RenderEntities([&](const uint32_t handle, const eAssetType type, const vec3f& position, const uint32_t width, const uint32_t height, const AssetInterface* asset)
+        {
+            handles.push_back(handle);
+            if (handle == 4)
+                EXPECT_EQ(position.Y, 2);
+        });
+    EXPECT_EQ(handles, (std::vector<uint32_t>{ 0, 1, 2, 3, 4, 5 }));
+}
+
+TEST(SceneGraphTest, PatchedTemplateMatchesOverridesByName)
+{
+    Arena arena;
+    SceneGraph prefab;
+    BuildTestPrefab(prefab, arena);
+
+    const auto overrides = MakeTestOverrides(arena, { { "Icon", EntityOverrideData::WIDTH, {}, 7, 0, {} } });
+    SceneGraph graph;
+    BuildTestGraph(graph, arena, { MakeTestInstance(20, "Button", 0, {}), MakeTestEntity(30, "Other", 0) }, { &prefab }, { overrides });
+    ASSERT_EQ(graph.FindEntityByName("Button/Icon"), 4u);
+
+    SceneGraph reloadedPrefab;
+    BuildTestGraph(reloadedPrefab, arena, {
+        MakeTestEntity(3, "Icon", 0, { 0, 0, 1 }),
+        MakeTestEntity(1, "Panel", 0, { 1, 0, 0 }),
+        MakeTestEntity(2, "Text", 1, { 0, 1, 0 }),
+        MakeTestEntity(4, "Badge", 0)
+    });
+
+    EXPECT_EQ(graph.PatchTemplate(&prefab, &reloadedPrefab), 1u);
+    graph.UpdateMemberHandles();
+    EXPECT_EQ(graph.GetHandlesCount(), 6u);
+    EXPECT_EQ(graph.FindEntityByName("Button/Icon"), 2u);
+    EXPECT_EQ(graph.FindEntityByName("Button/Badge"), 5u);
+    EXPECT_EQ(graph.GetEntity(2).Width, 7u);
+    EXPECT_EQ(graph.FindEntityByName("Other"), 1u);
+    EXPECT_EQ(graph.PatchTemplate(&prefab, &reloadedPrefab), 0u);
+}
+
+TEST(TextAssetTest, FindsParsedValues)
+{
+    TextAsset text;
+    ParseTextAsset(text, TestText);
+
+    EXPECT_EQ(text.GetValuesCount(), 4u);
+
+    std::string_view value;
+    ASSERT_TRUE(text.GetKeyValue(TextKey("TitleHeader"), value));
+    EXPECT_EQ(value, "My Test Game");
+    ASSERT_TRUE(text.GetKeyValue("TitleFooter", value));
+    EXPECT_EQ(value, "created by Michael");
+    ASSERT_TRUE(text.GetKeyValue(TextKey("LegalFooter"), value));
+    EXPECT_EQ(value, "(c) 2022");
+    ASSERT_TRUE(text.GetKeyValue(TextKey("Empty"), value));
+    EXPECT_TRUE(value.empty());
+
+    //  Missing key leaves value as it was.
+    value = "unchanged";
+    EXPECT_FALSE(text.GetKeyValue(TextKey("Missing"), value));
+    EXPECT_FALSE(text.GetKeyValue("Line without a value", value));
+    EXPECT_EQ(value, "unchanged");
+}
+
+//  Plain literals are hashed when looked up, compile time hashing is asked for with 'TextKey'.
+static_assert(requires(const TextAsset& text, std::string_view& value) { text.GetKeyValue("TitleHeader", value); });
+static_assert(requires(std::string_view& value) { Localization::GetText("TitleHeader", value); });
+
+TEST(TextAssetTest, EmptyTextHasNoValues)
+{
+    TextAsset text;
+    ParseTextAsset(text, "");
+
+    std::string_view value;
+    EXPECT_EQ(text.GetValuesCount(), 0u);
+    EXPECT_FALSE(text.GetKeyValue(TextKey("TitleHeader"), value));
+}
+
+TEST(TextAssetTest, CookedTextFindsTheSameValues)
+{
+    TextAsset text;
+    ParseTextAsset(text, TestText);
+
+    std::vector<char> cookedData;
+    text.Cook(cookedData);
+    ASSERT_TRUE(TextAsset::IsCooked((const uint8_t*)cookedData.data(), cookedData.size()));
+
+    TextAsset cookedText;
+    ParseTextAsset(cookedText, std::string_view(cookedData.data(), cookedData.size()));
+
+    EXPECT_EQ(cookedText.GetValuesCount(), text.GetValuesCount());
+    for (const std::string_view key : { "TitleHeader", "TitleFooter", "Empty", "LegalFooter" })
+    {
+        std::string_view value;
+        std::string_view cookedValue;
+        ASSERT_TRUE(text.GetKeyValue(key, value));
+        ASSERT_TRUE(cookedText.GetKeyValue(key, cookedValue)) << key;
+        EXPECT_EQ(cookedValue, value);
+    }
+
+    std::string_view value;
+    EXPECT_FALSE(cookedText.GetKeyValue(TextKey("Missing"), value));
+}
+
+TEST(TextAssetTest, RejectsCookedTableWithoutEmptySlots)
+{
+    TextAsset text;
+    ParseTextAsset(text, TestText);
+
+    std::vector<char> cookedData;
+    text.Cook(cookedData);
+
+    TextBinHeader& header = *(TextBinHeader*)cookedData.data();
+    header.ValuesCount = header.SlotsCount;
+
+    TextAsset cookedText;
+    ParseTextAsset(cookedText, std::string_view(cookedData.data(), cookedData.size()));
+
+    std::string_view value;
+    EXPECT_EQ(cookedText.GetValuesCount(), 0u);
+    EXPECT_FALSE(cookedText.GetKeyValue(TextKey("TitleHeader"), value));
+}
+
+TEST(TextAssetTest, LookupInFullCookedTableStops)
+{
+    TextAsset text;
+    ParseTextAsset(text, TestText);
+
+    std::vector<char> cookedData;
+    text.Cook(cookedData);
+
+    //  Header claims there's room left, but every slot is taken by some other key. Slots are 16 bytes: key hash, value offset and length.
+    const TextBinHeader& header = *(const TextBinHeader*)cookedData.data();
+    for (uint64_t slotIndex = 0; slotIndex < header.SlotsCount; slotIndex++)
+    {
+        char* slot = cookedData.data() + header.SlotsOffset + slotIndex * 16;
+        const uint64_t keyHash = slotIndex + 1;
+        const uint32_t valueOffset = 0;
+        memcpy(slot, &keyHash, sizeof(keyHash));
+        memcpy(slot + sizeof(keyHash), &valueOffset, sizeof(valueOffset));
+    }
+
+    TextAsset cookedText;
+    ParseTextAsset(cookedText, std::string_view(cookedData.data(), cookedData.size()));
+
+    std::string_view value;
+    EXPECT_FALSE(cookedText.GetKeyValue(TextKey("Missing"), value));
+}
+
+TEST(ThreadPoolTest, ParallelForRunsEveryIndexOnce)
+{
+    ThreadPool pool(4);
+
+    std::vector<std::atomic_uint32_t> calls(1000);
+    pool.ParallelFor(calls.size(), [&calls](const size_t index) { calls[index]++; });
+
+    for (size_t index = 0; index < calls.size(); index++)
+        ASSERT_EQ(calls[index], 1u) << index;
+
+    pool.ParallelFor(0, [](const size_t) { FAIL(); });
+}
+
+TEST(ThreadPoolTest, NestedParallelForDoesntDeadlock)
+{
+    //  Every worker is busy with an outer index, inner loops only finish because callers take indices too.
+    ThreadPool pool(2);
+
+    std::atomic_uint32_t innerCalls = 0;
+    pool.ParallelFor(8, [&pool, &innerCalls](const size_t) { pool.ParallelFor(8, [&innerCalls](const size_t) { innerCalls++; }); });
+
+    EXPECT_EQ(innerCalls, 64u);
+}
+
+TEST(ThreadPoolTest, HigherPriorityJobsStartFirst)
+{
+    ThreadPool pool(1);
+
+    //  Worker is held up, so everything below is queued before any of it starts.
+    std::mutex gate;
+    std::unique_lock<std::mutex> gateLock(gate);
+    std::atomic_bool started = false;
+    pool.Submit([&gate, &started]() { started = true; std::lock_guard<std::mutex> lock(gate); });
+    while (!started)
+        std::this_thread::yield();
+
+    std::mutex orderMutex;
+    std::vector<int32_t> order;
+    for (const int32_t priority : { 0, 5, -5, 5, 10 })
+        pool.Submit([&, priority]() { std::lock_guard<std::mutex> lock(orderMutex); order.push_back(priority); }, priority);
+
+    gateLock.unlock();
+
+    std::atomic_bool done = false;
+    pool.Submit([&done]() { done = true; }, -100);
+    while (!done)
+        std::this_thread::yield();
+
+    EXPECT_EQ(order, std::vector<int32_t>({ 10, 5, 5, 0, -5 }));
+}
+
+TEST(ScriptLexerTest, TokensPointIntoSource)
+{
+    const std::string_view source =
+        "#include \"generic/placeholder.script\"\r\n"
+        "function update(delta) // comment (with tokens)\n"
+        "\tif ((delta >= -0.5) && flag != 1 || x)\n";
+    using enum Scripting::Token::eTokenType;
+    const std::vector<Scripting::Token::eTokenType> expectedTypes = {
+        DIRECTIVE, STRING, NEWLINE,
+        IDENTIFIER, IDENTIFIER, LEFT_PARENTHESIS, IDENTIFIER, RIGHT_PARENTHESIS, NEWLINE,
+        IDENTIFIER, LEFT_PARENTHESIS, LEFT_PARENTHESIS, IDENTIFIER, GREATER_OR_EQUAL, NUMBER, RIGHT_PARENTHESIS,
+        LOGICAL_AND, IDENTIFIER, NOT_EQUALS, NUMBER, LOGICAL_OR, IDENTIFIER, RIGHT_PARENTHESIS, NEWLINE,
+        END
+    };
+
+    Scripting::Lexer lexer(source.data(), source.size());
+    std::vector<Scripting::Token> tokens;
+    do
+        tokens.push_back(lexer.Next());
+    while (tokens.back().Type != END);
+
+    ASSERT_EQ(tokens.size(), expectedTypes.size());
+    for (size_t index = 0; index < tokens.size(); index++)
+    {
+        EXPECT_EQ(tokens[index].Type, expectedTypes[index]) << "token #" << index;
+        //  Nothing is copied, every token is a part of the source.
+        EXPECT_GE(tokens[index].Text.data(), source.data());
+        EXPECT_LE(tokens[index].Text.data() + tokens[index].Text.size(), source.data() + source.size());
+    }
+
+    EXPECT_EQ(tokens[1].Text, "\"generic/placeholder.script\"");
+    EXPECT_EQ(tokens[4].Text, "update");
+    EXPECT_EQ(tokens[4].Line, 2u);
+    EXPECT_EQ(tokens[4].Column, 10u);
+    EXPECT_EQ(tokens[14].Text, "-0.5");
+    EXPECT_EQ(tokens[14].Line, 3u);
+    EXPECT_EQ(tokens[14].Column, 16u);
+
+    //  End is sticky.
+    EXPECT_EQ(lexer.Next().Type, END);
+}
+
+TEST(ScriptLexerTest, PeekDoesntConsume)
+{
+    const std::string_view source = "a = \"unterminated\nb";
+    Scripting::Lexer lexer(source.data(), source.size());
+
+    EXPECT_EQ(lexer.Peek().Text, "a");
+    EXPECT_EQ(lexer.Peek().Text, "a");
+    EXPECT_EQ(lexer.Next().Text, "a");
+    EXPECT_EQ(lexer.Next().Type, Scripting::Token::ASSIGN);
+
+    //  Strings can't span lines, so this one ends up invalid, but the next line is still read.
+    const Scripting::Token invalid = lexer.Next();
+    EXPECT_EQ(invalid.Type, Scripting::Token::INVALID);
+    EXPECT_EQ(invalid.Text, "\"unterminated");
+    EXPECT_EQ(lexer.Next().Type, Scripting::Token::NEWLINE);
+    EXPECT_EQ(lexer.GetLastTokenType(), Scripting::Token::NEWLINE);
+    EXPECT_EQ(lexer.Next().Text, "b");
+    EXPECT_EQ(lexer.Next().Type, Scripting::Token::END);
+}
+
+//  Script parsed, compiled and linked from 'source' the way loader does it.
+static void ParseScript(ScriptAsset& script, const std::string_view& source)
+{
+    script.SetData("script:test/test.script", eAssetType::SCRIPT);
+    script.SetDataSize(source.size());
+    script.ParseData((const uint8_t*)source.data());
+}
+
+TEST(ScriptCompilerTest, FunctionsShareCodeAndConstants)
+{
+    ScriptAsset script;
+    ParseScript(script,
+        "function main()\r\n"
+        "{\r\n"
+        "\tfirst = 5\r\n"
+        "\tsecond = 5\r\n"
+        "\thelper(first, \"text\")\r\n"
+        "}\r\n"
+        "\r\n"
+        "function helper(a, b)\r\n"
+        "{\r\n"
+        "\tif (a > 1)\r\n"
+        "\t\thelper(b, \"text\")\r\n"
+        "\tendif\r\n"
+        "}\r\n");
+    ASSERT_EQ(script.GetErrorsFound(), 0u);
+
+    const Scripting::CompiledScript& program = script.GetProgram();
+    ASSERT_EQ(program.Functions.size(), 2u);
+    const Scripting::CompiledFunction* mainFunction = program.FindFunction(Scripting::StringTable::Intern("main"));
+    const Scripting::CompiledFunction* helperFunction = program.FindFunction(Scripting::StringTable::Intern("helper"));
+    ASSERT_TRUE(mainFunction && helperFunction);
+    EXPECT_EQ(mainFunction->ArgumentsCount, 0);
+    EXPECT_GE(mainFunction->RegistersCount, 2);
+    EXPECT_EQ(helperFunction->ArgumentsCount, 2);
+
+    //  Functions follow each other in one code array, each one ends with a return.
+    EXPECT_EQ(mainFunction->CodeOffset, 0u);
+    EXPECT_EQ(helperFunction->CodeOffset, mainFunction->CodeSize);
+    EXPECT_EQ(program.Code.size(), mainFunction->CodeSize + helperFunction->CodeSize);
+    EXPECT_EQ(Scripting::GetOpcode(program.Code[mainFunction->CodeOffset + mainFunction->CodeSize - 1]), Scripting::OP_RETURN);
+    EXPECT_EQ(Scripting::GetOpcode(program.Code[helperFunction->CodeOffset + helperFunction->CodeSize - 1]), Scripting::OP_RETURN);
+
+    //  Condition jumps over it's body, to the return.
+    const auto jump = std::find_if(program.Code.begin() + helperFunction->CodeOffset, program.Code.end(),
+        [](const Scripting::Instruction instruction) { return Scripting::GetOpcode(instruction) == Scripting::OP_JUMP_IF_FALSE; });
+    ASSERT_NE(jump, program.Code.end());
+    EXPECT_EQ(Scripting::GetBx(*jump), helperFunction->CodeSize - 1);
+
+    //  Same constants are stored once for the whole script: '5', '"text"' and '1'.
+    EXPECT_EQ(program.Constants.size(), 3u);
+
+    ASSERT_EQ(program.CallSites.size(), 2u);
+    for (const auto& callSite : program.CallSites)
+    {
+        EXPECT_EQ(callSite.NameId, Scripting::StringTable::Intern("helper"));
+        EXPECT_EQ(callSite.ArgumentsCount, 2);
+        EXPECT_EQ(callSite.ResultRegister, Scripting::NoRegister);
+    }
+    EXPECT_EQ(program.CallSites[0].Line, 5u);
+    EXPECT_EQ(program.CallSites[1].Line, 11u);
+}
+
+TEST(ScriptCompilerTest, ScriptWithSyntaxErrorsIsNotCompiled)
+{
+    ScriptAsset script;
+    ParseScript(script,
+        "junk here\n"
+        "function main()\n"
+        "{\n"
+        "\tx = @\n"
+        "\tendif\n"
+        "}\n");
+
+    EXPECT_GT(script.GetErrorsFound(), 0u);
+    EXPECT_TRUE(script.GetProgram().Functions.empty());
+    EXPECT_TRUE(script.GetProgram().Code.empty());
+}
+
+//  Arguments of every call scripts made to 'Record', in order.
+static std::vector<std::vector<Scripting::Value>> RecordedCalls;
+
+static bool Record(Scripting::VirtualMachine& machine, const Scripting::Value* arguments, Scripting::Value& result)
+{
+    RecordedCalls.push_back({ arguments[0], arguments[1] });
+    return true;
+}
+
+static bool FailAlways(Scripting::VirtualMachine& machine, const Scripting::Value* arguments, Scripting::Value& result)
+{
+    return machine.SetError("native failed");
+}
+
+//  Natives must be registered before the first script that calls them is linked, and only once.
+static void RegisterTestNatives()
+{
+    static const bool isRegistered = Scripting::Natives::Register("Record", &Record, 1, 2) && Scripting::Natives::Register("FailAlways", &FailAlways, 0, 0);
+    ASSERT_TRUE(isRegistered);
+}
+
+static bool CallScript(Scripting::VirtualMachine& machine, const ScriptAsset& script, const std::string_view& functionName, const Scripting::Value& self, const std::vector<Scripting::Value>& arguments = {})
+{
+    const Scripting::CompiledFunction* function = script.GetProgram().FindFunction(Scripting::StringTable::Intern(functionName));
+    return function && machine.Call(script.GetProgram(), *function, self, arguments);
+}
+
+TEST(ScriptLinkerTest, CallsGoStraightToTheirTargets)
+{
+    RegisterTestNatives();
+    ScriptAsset script;
+    ParseScript(script,
+        "function main()\n"
+        "{\n"
+        "\tRecord(\"event\", handler)\n"
+        "\tFailAlways(1)\n"
+        "}\n"
+        "function handler()\n"
+        "{\n"
+        "}\n"
+        "//  Script functions take precedence over natives of the same name.\n"
+        "function FailAlways(value)\n"
+        "{\n"
+        "}\n");
+    ASSERT_EQ(script.GetErrorsFound(), 0u);
+
+    const Scripting::CompiledScript& program = script.GetProgram();
+    std::vector<Scripting::eOpcode> callOpcodes;
+    for (const auto instruction : program.Code)
+    {
+        if (Scripting::GetOpcode(instruction) == Scripting::OP_CALL || Scripting::GetOpcode(instruction) == Scripting::OP_CALL_NATIVE)
+            callOpcodes.push_back(Scripting::GetOpcode(instruction));
+    }
+    EXPECT_EQ(callOpcodes, std::vector<Scripting::eOpcode>({ Scripting::OP_CALL_NATIVE, Scripting::OP_CALL }));
+
+    ASSERT_EQ(program.CallSites.size(), 2u);
+    EXPECT_EQ(program.CallSites[0].Target, Scripting::Natives::Find(Scripting::StringTable::Intern("Record")));
+    EXPECT_EQ(program.CallSites[1].Target, 2u);
+
+    //  Function names passed around are turned into their indices.
+    const auto handler = std::find_if(program.Constants.begin(), program.Constants.end(),
+        [](const Scripting::Value& constant) { return constant.Type == Scripting::Value::FUNCTION; });
+    ASSERT_NE(handler, program.Constants.end());
+    EXPECT_EQ(handler->Index, 1u);
+    EXPECT_TRUE(std::none_of(program.Constants.begin(), program.Constants.end(),
+        [](const Scripting::Value& constant) { return constant.Type == Scripting::Value::NAME; }));
+}
+
+TEST(ScriptLinkerTest, ReportsUnknownNamesAndWrongArgumentsCounts)
+{
+    RegisterTestNatives();
+    ScriptAsset script;
+    ParseScript(script,
+        "function main()\n"
+        "{\n"
+        "\tNope()\n"
+        "\thelper(1, 2)\n"
+        "\tRecord()\n"
+        "\tRecord(1, 2, 3)\n"
+        "\tRecord(\"event\", missingHandler)\n"
+        "\thelper(1)\n"
+        "}\n"
+        "function helper(value)\n"
+        "{\n"
+        "}\n");
+    EXPECT_EQ(script.GetErrorsFound(), 5u);
+
+    //  Calls in error are left unresolved, the rest are linked.
+    const Scripting::CompiledScript& program = script.GetProgram();
+    ASSERT_EQ(program.CallSites.size(), 6u);
+    for (size_t index = 0; index < 4; index++)
+        EXPECT_EQ(program.CallSites[index].Target, Scripting::UnresolvedTarget) << "call #" << index;
+
+    EXPECT_NE(program.CallSites[4].Target, Scripting::UnresolvedTarget);
+    EXPECT_EQ(program.CallSites[5].Target, 1u);
+}
+
+TEST(VirtualMachineTest, ConditionsPickTheRightBranch)
+{
+    RegisterTestNatives();
+    ScriptAsset script;
+    ParseScript(script,
+        "function update(delta, limit)\n"
+        "{\n"
+        "\tif ((delta > 0.5) && (limit != 2) || delta == 0)\n"
+        "\t\tRecord(\"fast\", delta)\n"
+        "\tendif\n"
+        "\tif (delta <= 0.5)\n"
+        "\t\tRecord(this)\n"
+        "\tendif\n"
+        "}\n");
+    ASSERT_EQ(script.GetErrorsFound(), 0u);
+
+    Scripting::VirtualMachine machine;
+    const Scripting::Value self = Scripting::Value::MakeNumber(7.0);
+    RecordedCalls.clear();
+    EXPECT_TRUE(CallScript(machine, script, "update", self, { Scripting::Value::MakeNumber(1.0), Scripting::Value::MakeNumber(3.0) }));
+    EXPECT_TRUE(CallScript(machine, script, "update", self, { Scripting::Value::MakeNumber(1.0), Scripting::Value::MakeNumber(2.0) }));
+    EXPECT_TRUE(CallScript(machine, script, "update", self, { Scripting::Value::MakeNumber(0.25) }));
+    EXPECT_TRUE(CallScript(machine, script, "update", self, { Scripting::Value::MakeNumber(0.0) }));
+
+    //  Left out arguments are 'nil', and so are the ones natives aren't passed.
+    ASSERT_EQ(RecordedCalls.size(), 4u);
+    EXPECT_EQ(RecordedCalls[0][0].GetString(), "fast");
+    EXPECT_EQ(RecordedCalls[0][1].Number, 1.0);
+    EXPECT_EQ(RecordedCalls[1][0].Number, 7.0);
+    EXPECT_EQ(RecordedCalls[1][1].Type, Scripting::Value::NIL);
+    EXPECT_EQ(RecordedCalls[2][0].GetString(), "fast");
+    EXPECT_EQ(RecordedCalls[2][1].Number, 0.0);
+    EXPECT_EQ(RecordedCalls[3][0].Number, 7.0);
+}
+
+TEST(VirtualMachineTest, RuntimeErrorsLeaveMachineUsable)
+{
+    RegisterTestNatives();
+    ScriptAsset script;
+    ParseScript(script,
+        "function compare(value)\n"
+        "{\n"
+        "\tif (value < 1)\n"
+        "\t\tRecord(value)\n"
+        "\tendif\n"
+        "}\n"
+        "function fail()\n"
+        "{\n"
+        "\tcompare(0)\n"
+        "\tFailAlways()\n"
+        "}\n"
+        "function recurse()\n"
+        "{\n"
+        "\trecurse()\n"
+        "}\n");
+    ASSERT_EQ(script.GetErrorsFound(), 0u);
+
+    Scripting::VirtualMachine machine(1024, 16);
+    RecordedCalls.clear();
+    EXPECT_FALSE(CallScript(machine, script, "compare", {}, { Scripting::Value::MakeString("text") }));
+    EXPECT_EQ(machine.GetLastError(), "can't compare string with number");
+
+    EXPECT_FALSE(CallScript(machine, script, "fail", {}));
+    EXPECT_EQ(machine.GetLastError(), "native failed in 'FailAlways' at line 10");
+
+    EXPECT_FALSE(CallScript(machine, script, "recurse", {}));
+    EXPECT_EQ(machine.GetLastError(), "calls are nested deeper than 16 at line 14");
+
+    //  Every failed call dropped it's frames, so there's room for the whole depth again.
+    EXPECT_TRUE(CallScript(machine, script, "compare", {}, { Scripting::Value::MakeNumber(-1.0) }));
+    ASSERT_EQ(RecordedCalls.size(), 2u);
+    EXPECT_EQ(RecordedCalls[0][0].Number, 0.0);
+    EXPECT_EQ(RecordedCalls[1][0].Number, -1.0);
+}
+
+static double Scale(const double value, const std::optional<double> factor)
+{
+    return value * factor.value_or(2.0);
+}
+
+static Scripting::Entity FindTestEntity(Scripting::VirtualMachine& machine, const std::string_view name)
+{
+    if (name.empty())
+        machine.SetError("entity name is empty");
+
+    return { name == "Button" ? 3u : Scripting::Entity::InvalidIndex };
+}
+
+TEST(NativeBindingTest, ArgumentsCountsAreDeduced)
+{
+    EXPECT_EQ(Scripting::NativeBinding<&Scale>::ArgumentsCount, 2);
+    EXPECT_EQ(Scripting::NativeBinding<&Scale>::RequiredArgumentsCount, 1);
+
+    //  Machine passed in front is not a script argument.
+    EXPECT_EQ(Scripting::NativeBinding<&FindTestEntity>::ArgumentsCount, 1);
+    EXPECT_EQ(Scripting::NativeBinding<&FindTestEntity>::RequiredArgumentsCount, 1);
+}
+
+TEST(NativeBindingTest, ValuesAreConvertedBothWays)
+{
+    RegisterTestNatives();
+    static const bool isRegistered = Scripting::RegisterNative<&Scale>("Scale") && Scripting::RegisterNative<&FindTestEntity>("FindTestEntity");
+    ASSERT_TRUE(isRegistered);
+
+    ScriptAsset script;
+    ParseScript(script,
+        "function main()\n"
+        "{\n"
+        "\tscaled = Scale(3)\n"
+        "\tRecord(scaled)\n"
+        "\tscaled = Scale(3, 0.5)\n"
+        "\tRecord(scaled)\n"
+        "\tentity = FindTestEntity(\"Button\")\n"
+        "\tRecord(entity)\n"
+        "\tentity = FindTestEntity(\"Missing\")\n"
+        "\tRecord(entity)\n"
+        "}\n"
+        "function wrongType()\n"
+        "{\n"
+        "\tScale(\"three\")\n"
+        "}\n"
+        "function failing()\n"
+        "{\n"
+        "\tFindTestEntity(\"\")\n"
+        "}\n");
+    ASSERT_EQ(script.GetErrorsFound(), 0u);
+
+    Scripting::VirtualMachine machine;
+    RecordedCalls.clear();
+    ASSERT_TRUE(CallScript(machine, script, "main", {}));
+    ASSERT_EQ(RecordedCalls.size(), 4u);
+    EXPECT_EQ(RecordedCalls[0][0].Number, 6.0);
+    EXPECT_EQ(RecordedCalls[1][0].Number, 1.5);
+    EXPECT_EQ(RecordedCalls[2][0].Type, Scripting::Value::ENTITY);
+    EXPECT_EQ(RecordedCalls[2][0].Index, 3u);
+    EXPECT_EQ(RecordedCalls[3][0].Type, Scripting::Value::NIL);
+
+    EXPECT_FALSE(CallScript(machine, script, "wrongType", {}));
+    EXPECT_EQ(machine.GetLastError(), "expected number as argument #1, got string in 'Scale' at line 14");
+
+    //  Error set by the native fails the call, even though it returned normally.
+    EXPECT_FALSE(CallScript(machine, script, "failing", {}));
+    EXPECT_EQ(machine.GetLastError(), "entity name is empty in 'FindTestEntity' at line 18");
+    EXPECT_TRUE(CallScript(machine, script, "main", {}));
+}
+
 //  TODO: test GFX.
 //  TODO: test Input.
-//  TODO: test scripting.
 //  TODO: test file system.
 //  TODO: test audio.
 //  TODO: test assets.